@@ -0,0 +1,694 @@
+#include "engine/core/engine.h"
+
+// Engine benchmarks
+// Canned stress scenarios run on a headless engine. Every scenario is timed a few times, the median and the fastest
+// run are written as JSON and the fastest is compared against a stored baseline, so a change that slows one of
+// them down fails the run. The fastest run is the one the scheduler and the other processes disturbed the least.
+// A run of a short scenario repeats it until it has been timed for BENCH_SAMPLE_MS and keeps the mean, so one
+// preemption is spread over many iterations instead of doubling a sub-millisecond measure. How far the lower
+// quartile of a scenario's runs sits above the fastest one, here or in the baseline, widens its threshold: on a
+// machine where the same code varies by 30% from run to run, a 20% slowdown can't be told from the noise
+
+Entity PLAYER_ID = 0;  // will be set when the player is created
+
+#define BENCH_REPEATS 9  // Timed runs of every scenario, the median and the fastest are kept
+#define BENCH_THRESHOLD 0.2  // Slowdown of the fastest run over the baseline's counted as a regression, past the spread
+#define BENCH_MIN_DELTA_MS 0.05  // Below this many milliseconds a slowdown is timer noise, whatever its ratio
+#define BENCH_SAMPLE_MS 25.0  // Timed milliseconds a run adds up, over as many iterations as it takes
+#define BENCH_TANKS 2000
+#define BENCH_BULLETS 10000
+#define BENCH_TICKS 60  // Simulated ticks of the crowded arena
+#define BENCH_CROWD_TANKS 200  // Tanks of the crowded arena, on tiles of their own
+#define BENCH_CROWD_BULLETS 1000  // Bullets of the crowded arena, flying down lanes that outlast the ticks
+#define BENCH_LANE_PERIOD 3  // Every third row of tiles is a bullet lane, the tanks stand on the two rows between
+#define BENCH_LANE_SLOTS 2  // Bullets side by side across a lane
+#define BENCH_MOVERS 10000  // Small entities drifting over the arena, for the broadphases
+#define BENCH_MOVER_SIZE 8  // Side of a mover's hitbox, in logical pixels
+#define BENCH_MOVER_SPEED 120.0  // Logical pixels per second
+#define BENCH_CHURN_ENTITIES 10000  // Entities created then deleted in a churn round
+#define BENCH_CHURN_ROUNDS 10
+#define BENCH_SWEEP_ENTITIES 50000
+#define BENCH_RAYS 10000  // Rays in a batch, about what the AI would cast a tick with every tank looking around
+#define BENCH_RESULTS "bench_results.json"
+#ifndef BENCH_BASELINE
+    #define BENCH_BASELINE "bench/baseline.json"
+#endif
+
+typedef struct {
+    const char *name;  // Key of the scenario in the results
+    double_t (*run)(ZENg);  // Runs the scenario once, returns the timed part's duration in milliseconds
+} BenchScenario;
+
+typedef struct {
+    GameStateType type;
+    void (*onEnter)(ZENg);
+    void (*onExit)(ZENg);
+} BenchMenu;
+
+// Every menu state, entering one parses its data/states file
+static const BenchMenu benchMenus[] = {
+    {STATE_MAIN_MENU, &onEnterMainMenu, &onExitMainMenu},
+    {STATE_GARAGE, &onEnterGarage, &onExitGarage},
+    {STATE_SETTINGS, &onEnterSettingsMenu, &onExitSettingsMenu},
+    {STATE_GAME_SETTINGS, &onEnterGameSettings, &onExitGameSettings},
+    {STATE_AUDIO_SETTINGS, &onEnterAudioSettings, &onExitAudioSettings},
+    {STATE_VIDEO_SETTINGS, &onEnterVideoSettings, &onExitVideoSettings},
+    {STATE_CONTROLS_SETTINGS, &onEnterControlsSettings, &onExitControlsSettings},
+    {STATE_PAUSED, &onEnterPauseState, &onExitPauseState}
+};
+
+/**
+ * @param start performance counter value at the start of the measure
+ * @return milliseconds elapsed since start
+ */
+static double_t msSince(Uint64 start) {
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+/**
+ * Spreads tanks over the arena, overlapping the walls and each other
+ * @param zEngine pointer to the engine
+ * @param count number of tanks
+ */
+static void spawnTanks(ZENg zEngine, Uint32 count) {
+    TankPrefab *prefab = getTankPrefab(zEngine->prefabs, "tankBasic");
+    for (Uint32 i = 0; i < count; i++) {
+        Vec2 position = {
+            .x = (i * 7 % (ARENA_WIDTH - 2)) * TILE_SIZE,
+            .y = (i * 3 % (ARENA_HEIGHT - 2)) * TILE_SIZE
+        };
+        Entity tank = instantiateTank(zEngine, prefab, position);
+
+        CollisionComponent *colComp = NULL;
+        GET_COMPONENT(zEngine->ecs, tank, COLLISION_COMPONENT, colComp, CollisionComponent);
+        registerEntityToSG(zEngine->collisionMng, tank, colComp);
+    }
+}
+
+/**
+ * Fires bullets from the tanks in the arena, in turns
+ * @param zEngine pointer to the engine
+ * @param count number of bullets
+ */
+static void spawnBullets(ZENg zEngine, Uint32 count) {
+    WeaponComponent gun = instantiateWeapon(zEngine, getWeaponPrefab(zEngine->prefabs, "PKT"), 0);
+
+    ComponentTypeSet *healthComps = &zEngine->ecs->components[HEALTH_COMPONENT];  // Only the tanks have health
+    for (Uint32 i = 0; i < count; i++) {
+        Entity shooter = healthComps->denseToEntity[i % healthComps->denseSize];
+        gun.spawnProj(
+            zEngine, shooter, gun.projW, gun.projH, gun.projSpeed, &gun.projComp, gun.projLifeTime,
+            gun.projTexture, gun.projSound
+        );
+    }
+    free(gun.name);
+}
+
+/**
+ * Scatters small moving entities over the arena. They have no health and no handler between them,
+ * so they stay alive and only load the broadphase
+ * @param zEngine pointer to the engine
+ * @param count number of entities
+ */
+static void spawnMovers(ZENg zEngine, Uint32 count) {
+    const Vec2 directions[] = {DIR_UP, DIR_RIGHT, DIR_DOWN, DIR_LEFT};
+    ECS ecs = zEngine->ecs;
+    for (Uint32 i = 0; i < count; i++) {
+        Entity mover = createEntity(ecs, STATE_PLAYING);
+        PositionComponent pos = createPositionComponent((Vec2){
+            .x = TILE_SIZE + (i * 97) % (LOGICAL_WIDTH - 2 * TILE_SIZE),
+            .y = TILE_SIZE + (i * 53) % (LOGICAL_HEIGHT - 2 * TILE_SIZE)
+        });
+        addComponent(ecs, mover, POSITION_COMPONENT, &pos);
+        DirectionComponent dir = createDirectionComponent(directions[i % 4]);
+        addComponent(ecs, mover, DIRECTION_COMPONENT, &dir);
+        VelocityComponent vel = createVelocityComponent(
+            (Vec2){dir.x * BENCH_MOVER_SPEED, dir.y * BENCH_MOVER_SPEED}, BENCH_MOVER_SPEED, pos, AXIS_NONE, 1
+        );
+        addComponent(ecs, mover, VELOCITY_COMPONENT, &vel);
+        CollisionComponent col = createCollisionComponent(
+            ecs, (int)pos.x, (int)pos.y, BENCH_MOVER_SIZE, BENCH_MOVER_SIZE, 0, COL_ACTOR
+        );
+        CollisionComponent *stored = addComponent(ecs, mover, COLLISION_COMPONENT, &col);
+        registerEntityToSG(zEngine->collisionMng, mover, stored);
+        RenderComponent render = createRenderComponent(
+            ecs, NULL, (int)pos.x, (int)pos.y, BENCH_MOVER_SIZE, BENCH_MOVER_SIZE, 1
+        );
+        addComponent(ecs, mover, RENDER_COMPONENT, &render);
+    }
+}
+
+/**
+ * Marks the tiles an entity covers
+ * @param blocked one row of bits per row of the arena
+ * @param rect the entity's hitbox
+ */
+static void blockTiles(Uint64 blocked[ARENA_HEIGHT], const SDL_Rect *rect) {
+    Int32 firstCol = rect->x / (Int32)TILE_SIZE, lastCol = (rect->x + rect->w - 1) / (Int32)TILE_SIZE;
+    Int32 firstRow = rect->y / (Int32)TILE_SIZE, lastRow = (rect->y + rect->h - 1) / (Int32)TILE_SIZE;
+    for (Int32 row = firstRow < 0 ? 0 : firstRow; row <= lastRow && row < ARENA_HEIGHT; row++) {
+        for (Int32 col = firstCol < 0 ? 0 : firstCol; col <= lastCol && col < ARENA_WIDTH; col++) {
+            blocked[row] |= 1ULL << col;
+        }
+    }
+}
+
+/**
+ * Places tanks on the rows between the lanes, where they cover only free tiles and no other hitbox
+ * @param zEngine pointer to the engine
+ * @param blocked one row of bits per row of the arena, a set bit is a tile taken, the tanks' tiles are added
+ * @param count number of tanks
+ * @return Uint32 = how many fit
+ */
+static Uint32 placeCrowdTanks(ZENg zEngine, Uint64 blocked[ARENA_HEIGHT], Uint32 count) {
+    TankPrefab *prefab = getTankPrefab(zEngine->prefabs, "tankBasic");
+    Uint64 rowMask = (1ULL << prefab->w) - 1;
+    Uint32 placed = 0;
+    for (Uint32 row = 2; row + prefab->h <= ARENA_HEIGHT && placed < count; row += BENCH_LANE_PERIOD) {
+        for (Uint32 col = 0; col + prefab->w <= ARENA_WIDTH && placed < count; col++) {
+            Uint8 isFree = 1;
+            for (Uint32 r = row; r < row + prefab->h && isFree; r++) isFree = !((blocked[r] >> col) & rowMask);
+            if (!isFree) continue;
+
+            Entity tank = instantiateTank(zEngine, prefab, (Vec2){col * TILE_SIZE, row * TILE_SIZE});
+            CollisionComponent *colComp = NULL;
+            GET_COMPONENT(zEngine->ecs, tank, COLLISION_COMPONENT, colComp, CollisionComponent);
+            registerEntityToSG(zEngine->collisionMng, tank, colComp);
+            blockTiles(blocked, colComp->hitbox);
+            col += prefab->w - 1;
+            placed++;
+        }
+    }
+    return placed;
+}
+
+/**
+ * Walks the spots of the lanes a bullet can start from and still be in its lane after the ticks,
+ * every stride-th one gets a bullet
+ * @param zEngine pointer to the engine
+ * @param blocked one row of bits per row of the arena, a set bit is a tile taken
+ * @param gun the gun to fire
+ * @param turret entity with a position, a direction and an empty render rect that the gun fires from
+ * @param stride how many spots apart the bullets are, 0 to only count the spots
+ * @param count most bullets to fire
+ * @return Uint32 = spots counted, or bullets fired
+ */
+static Uint32 fireDownLanes(
+    ZENg zEngine, const Uint64 blocked[ARENA_HEIGHT], WeaponComponent *gun, Entity turret, Uint32 stride, Uint32 count
+) {
+    Int32 tile = (Int32)TILE_SIZE, w = gun->projW, h = gun->projH;
+    // How far a bullet flies in the timed ticks, with a tick to spare
+    Int32 reach = (Int32)ceil(gun->projSpeed * zEngine->timestep.tickLength * (BENCH_TICKS + 1));
+
+    Uint32 spots = 0, fired = 0;
+    // The lanes are rows 1, 1 + BENCH_LANE_PERIOD..., the tanks stand on the rows between
+    for (Uint32 row = 1, lane = 0; row < ARENA_HEIGHT && fired < count; row += BENCH_LANE_PERIOD, lane++) {
+        // Neighboring lanes fly opposite ways
+        Vec2 dir = lane % 2 ? DIR_LEFT : DIR_RIGHT;
+        for (Int32 col = 0; col < ARENA_WIDTH && fired < count; col++) {
+            if ((blocked[row] >> col) & 1) continue;
+            Int32 runStart = col;
+            while (col < ARENA_WIDTH && !((blocked[row] >> col) & 1)) col++;
+            Int32 left = runStart * tile, right = col * tile;
+
+            Int32 first = dir.x > 0 ? left : left + reach, last = dir.x > 0 ? right - w - reach : right - w;
+            for (Int32 x = first; x <= last && fired < count; x += w) {
+                for (Int32 slot = 0; slot < BENCH_LANE_SLOTS && fired < count; slot++, spots++) {
+                    if (!stride || spots % stride) continue;
+
+                    // The bullet comes out half its size in front of the turret
+                    Int32 y = row * tile + slot * (tile / BENCH_LANE_SLOTS) + (tile / BENCH_LANE_SLOTS - h) / 2;
+                    PositionComponent *pos = NULL;
+                    GET_COMPONENT(zEngine->ecs, turret, POSITION_COMPONENT, pos, PositionComponent);
+                    *pos = (PositionComponent){x + w / 2.0 - dir.x * w / 2.0, y + h / 2.0};
+                    DirectionComponent *turretDir = NULL;
+                    GET_COMPONENT(zEngine->ecs, turret, DIRECTION_COMPONENT, turretDir, DirectionComponent);
+                    *turretDir = dir;
+                    gun->spawnProj(
+                        zEngine, turret, w, h, gun->projSpeed, &gun->projComp, gun->projLifeTime,
+                        gun->projTexture, gun->projSound
+                    );
+                    fired++;
+                }
+            }
+        }
+    }
+    return stride ? fired : spots;
+}
+
+/**
+ * Fills the arena for a sustained fight: tanks on the rows between the lanes, bullets flying down the lanes
+ * @param zEngine pointer to the engine
+ * @note nothing touches, so every entity is still alive after BENCH_TICKS ticks
+ */
+static void spawnCrowd(ZENg zEngine) {
+    Uint64 blocked[ARENA_HEIGHT];
+    for (Uint32 row = 0; row < ARENA_HEIGHT; row++) {
+        blocked[row] = zEngine->map->layers[TILE_LAYER_SOLID][row] | zEngine->map->layers[TILE_LAYER_UNWALKABLE][row];
+    }
+    ComponentTypeSet *colComps = &zEngine->ecs->components[COLLISION_COMPONENT];
+    for (Uint64 i = 0; i < colComps->denseSize; i++) {
+        blockTiles(blocked, ((CollisionComponent *)DENSE_AT(colComps, i))->hitbox);
+    }
+
+    if (placeCrowdTanks(zEngine, blocked, BENCH_CROWD_TANKS) < BENCH_CROWD_TANKS) {
+        THROW_ERROR_AND_EXIT("The arena has no room for the crowd's tanks");
+    }
+    WeaponComponent gun = instantiateWeapon(zEngine, getWeaponPrefab(zEngine->prefabs, "PKT"), 0);
+    Uint32 spots = fireDownLanes(zEngine, blocked, &gun, 0, 0, UINT32_MAX);
+    if (spots < BENCH_CROWD_BULLETS) THROW_ERROR_AND_EXIT("The arena's lanes have no room for the crowd's bullets");
+
+    // The gun has nobody behind it, it is moved from spot to spot
+    ECS ecs = zEngine->ecs;
+    Entity turret = createEntity(ecs, STATE_PLAYING);
+    PositionComponent pos = createPositionComponent((Vec2){0.0, 0.0});
+    addComponent(ecs, turret, POSITION_COMPONENT, &pos);
+    DirectionComponent dir = createDirectionComponent(DIR_RIGHT);
+    addComponent(ecs, turret, DIRECTION_COMPONENT, &dir);
+    RenderComponent render = createRenderComponent(ecs, NULL, 0, 0, 0, 0, 0);
+    addComponent(ecs, turret, RENDER_COMPONENT, &render);
+
+    fireDownLanes(zEngine, blocked, &gun, turret, spots / BENCH_CROWD_BULLETS, BENCH_CROWD_BULLETS);
+    free(gun.name);
+    deleteEntity(ecs, turret);
+}
+
+/**
+ * Simulates the movers with a broadphase
+ * @param zEngine pointer to the engine
+ * @param mode the broadphase
+ * @return double_t = milliseconds per tick
+ */
+static double_t tickMovers(ZENg zEngine, BroadphaseMode mode) {
+    setBroadphaseMode(zEngine->collisionMng, zEngine->ecs, zEngine->jobs, mode);
+    spawnMovers(zEngine, BENCH_MOVERS);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (Uint32 i = 0; i < BENCH_TICKS; i++) {
+        resetFrameArena(&zEngine->frameArena);
+        // Nothing fires, so keep them moving the way held movement keys do
+        zEngine->ecs->depGraph->nodes[SYS_VELOCITY]->isDirty = 1;
+        simulateTick(zEngine);
+    }
+    return msSince(start) / BENCH_TICKS;
+}
+
+/**
+ * Lets the tanks and bullets fight it out with a broadphase
+ * @param zEngine pointer to the engine
+ * @param mode the broadphase
+ * @return double_t = milliseconds per tick
+ */
+static double_t tickCrowd(ZENg zEngine, BroadphaseMode mode) {
+    setBroadphaseMode(zEngine->collisionMng, zEngine->ecs, zEngine->jobs, mode);
+    spawnCrowd(zEngine);
+    Uint64 entities = zEngine->ecs->entityCount;
+    Uint64 projectiles = zEngine->ecs->components[PROJECTILE_COMPONENT].denseSize;
+
+    double_t ticksPerSecond = runHeadless(zEngine, BENCH_TICKS);
+    // The same load on every tick, an emptied arena would time nothing while still naming the crowd
+    if (zEngine->ecs->entityCount != entities
+        || zEngine->ecs->components[PROJECTILE_COMPONENT].denseSize != projectiles) {
+        THROW_ERROR_AND_EXIT("Entities died in the crowded arena, the ticks didn't carry the full load");
+    }
+    return ticksPerSecond > 0.0 ? 1000.0 / ticksPerSecond : 0.0;  // Per tick
+}
+
+/**
+ * Gives the headless engine a renderer and fonts, the menus can't be built without them
+ * @param zEngine pointer to the engine
+ * @param surface where the software renderer draws
+ * @return HashMap = the resource manager holding the headless engine's stubs, to put back afterwards
+ */
+static HashMap attachSoftwareRenderer(ZENg zEngine, SDL_Surface **surface) {
+    if (TTF_Init() == -1) THROW_ERROR_AND_DO(
+        "SDL_TTF could not initialize: ", fprintf(stderr, "%s\n", TTF_GetError()); exit(EXIT_FAILURE);
+    );
+    *surface = SDL_CreateRGBSurfaceWithFormat(0, LOGICAL_WIDTH, LOGICAL_HEIGHT, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (!*surface) THROW_ERROR_AND_DO(
+        "Failed to create the benchmark surface: ", fprintf(stderr, "%s\n", SDL_GetError()); exit(EXIT_FAILURE);
+    );
+    zEngine->display->renderer = SDL_CreateSoftwareRenderer(*surface);
+    if (!zEngine->display->renderer) THROW_ERROR_AND_DO(
+        "Failed to create the software renderer: ", fprintf(stderr, "%s\n", SDL_GetError()); exit(EXIT_FAILURE);
+    );
+
+    // The stubs say which fonts and textures the game preloads, sounds aren't needed
+    HashMap stubs = zEngine->resources;
+    zEngine->resources = MapInit(257, MAP_RESOURCES);
+    for (size_t i = 0; i < stubs->size; i++) {
+        for (MapEntry *entry = stubs->entries[i]; entry; entry = entry->next) {
+            ResourceStub *stub = entry->data.ptr;
+            if (entry->type != ENTRY_RESOURCE_STUB || stub->type == ENTRY_SOUND) continue;
+            getOrLoadResource(zEngine->resources, zEngine->display->renderer, entry->key, stub->type);
+        }
+    }
+    return stubs;
+}
+
+/**
+ * Takes the renderer and fonts back from the headless engine
+ * @param zEngine pointer to the engine
+ * @param stubs the resource manager returned by attachSoftwareRenderer
+ * @param surface the software renderer's surface
+ */
+static void detachSoftwareRenderer(ZENg zEngine, HashMap stubs, SDL_Surface *surface) {
+    freeResourceManager(&zEngine->resources);
+    zEngine->resources = stubs;
+    SDL_DestroyRenderer(zEngine->display->renderer);
+    zEngine->display->renderer = NULL;
+    SDL_FreeSurface(surface);
+    TTF_Quit();
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+static double_t benchLoadPrefabs(ZENg zEngine) {
+    HashMap prefabs = zEngine->prefabs;
+    zEngine->prefabs = MapInit(127, MAP_PREFABS);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    loadPrefabs(zEngine, "data/prefabs.json");
+    double_t ms = msSince(start);
+
+    freePrefabsManager(&zEngine->prefabs);
+    zEngine->prefabs = prefabs;
+    return ms;
+}
+
+static double_t benchSpawnTanks(ZENg zEngine) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    spawnTanks(zEngine, BENCH_TANKS);
+    return msSince(start);
+}
+
+static double_t benchSpawnBullets(ZENg zEngine) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    spawnBullets(zEngine, BENCH_BULLETS);
+    return msSince(start);
+}
+
+static double_t benchCrowdedTicks(ZENg zEngine) {
+    return tickCrowd(zEngine, DEFAULT_BROADPHASE);
+}
+
+static double_t benchCrowdedSweep(ZENg zEngine) {
+    return tickCrowd(zEngine, BROADPHASE_SWEEP);
+}
+
+static double_t benchIncrementalGrid(ZENg zEngine) {
+    return tickMovers(zEngine, BROADPHASE_INCREMENTAL);
+}
+
+static double_t benchFlatGrid(ZENg zEngine) {
+    return tickMovers(zEngine, BROADPHASE_REBUILD);
+}
+
+static double_t benchSweepAndPrune(ZENg zEngine) {
+    return tickMovers(zEngine, BROADPHASE_SWEEP);
+}
+
+static double_t benchWorldCollisions(ZENg zEngine) {
+    spawnTanks(zEngine, BENCH_TANKS);
+    spawnMovers(zEngine, BENCH_MOVERS);
+    ComponentTypeSet *colComps = &zEngine->ecs->components[COLLISION_COMPONENT];
+
+    // Only the tile tests, no system runs in between so every pass sees about the same hitboxes
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (Uint32 i = 0; i < BENCH_TICKS; i++) {
+        for (Uint64 j = 0; j < colComps->denseSize; j++) {
+            checkAndHandleWorldCollisions(zEngine, colComps->denseToEntity[j]);
+        }
+    }
+    return msSince(start) / BENCH_TICKS;
+}
+
+static double_t benchRaycastBatch(ZENg zEngine) {
+    // Across the whole arena in every direction, so the rays cross long runs of tiles before the walls stop them
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (Uint32 i = 0; i < BENCH_TICKS; i++) {
+        resetFrameArena(&zEngine->frameArena);
+        RayBatch batch;
+        allocRayBatch(&batch, BENCH_RAYS, &zEngine->frameArena);
+        for (Uint32 ray = 0; ray < BENCH_RAYS; ray++) {
+            batch.fromX[ray] = TILE_SIZE + (ray * 97) % (LOGICAL_WIDTH - 2 * TILE_SIZE);
+            batch.fromY[ray] = TILE_SIZE + (ray * 53) % (LOGICAL_HEIGHT - 2 * TILE_SIZE);
+            batch.toX[ray] = TILE_SIZE + (ray * 61 + i * 7) % (LOGICAL_WIDTH - 2 * TILE_SIZE);
+            batch.toY[ray] = TILE_SIZE + (ray * 89 + i * 3) % (LOGICAL_HEIGHT - 2 * TILE_SIZE);
+        }
+        raycastTilesBatch(zEngine->map, &batch, RAY_MASK(TILE_LAYER_SOLID), zEngine->jobs);
+    }
+    return msSince(start) / BENCH_TICKS;
+}
+
+static double_t benchDeleteChurn(ZENg zEngine) {
+    ECS ecs = zEngine->ecs;
+    Entity *entities = malloc(BENCH_CHURN_ENTITIES * sizeof(Entity));
+    if (!entities) THROW_ERROR_AND_EXIT("Failed to allocate memory for the churn benchmark");
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (Uint32 round = 0; round < BENCH_CHURN_ROUNDS; round++) {
+        for (Uint32 i = 0; i < BENCH_CHURN_ENTITIES; i++) {
+            entities[i] = createEntity(ecs, STATE_PLAYING);
+            PositionComponent pos = createPositionComponent((Vec2){.x = i % LOGICAL_WIDTH, .y = i % LOGICAL_HEIGHT});
+            addComponent(ecs, entities[i], POSITION_COMPONENT, &pos);
+            DirectionComponent dir = createDirectionComponent(DIR_UP);
+            addComponent(ecs, entities[i], DIRECTION_COMPONENT, &dir);
+            LifetimeComponent life = {.lifeTime = 1.0, .timeAlive = 0.0};
+            addComponent(ecs, entities[i], LIFETIME_COMPONENT, &life);
+        }
+        // Every other one first, so the deletions hit the middle of the dense arrays too
+        for (Uint32 i = 0; i < BENCH_CHURN_ENTITIES; i += 2) deleteEntity(ecs, entities[i]);
+        for (Uint32 i = 1; i < BENCH_CHURN_ENTITIES; i += 2) deleteEntity(ecs, entities[i]);
+    }
+    double_t ms = msSince(start);
+
+    free(entities);
+    return ms;
+}
+
+static double_t benchSweepState(ZENg zEngine) {
+    ECS ecs = zEngine->ecs;
+    for (Uint32 i = 0; i < BENCH_SWEEP_ENTITIES; i++) {
+        Entity entity = createEntity(ecs, STATE_GAME_OVER);  // A state nothing else tags
+        PositionComponent pos = createPositionComponent((Vec2){.x = i % LOGICAL_WIDTH, .y = i % LOGICAL_HEIGHT});
+        addComponent(ecs, entity, POSITION_COMPONENT, &pos);
+        DirectionComponent dir = createDirectionComponent(DIR_UP);
+        addComponent(ecs, entity, DIRECTION_COMPONENT, &dir);
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    sweepState(ecs, STATE_GAME_OVER);
+    return msSince(start);
+}
+
+static double_t benchMenuStates(ZENg zEngine) {
+    StateManager stateMng = zEngine->stateMng;
+    SDL_Surface *surface = NULL;
+    HashMap stubs = attachSoftwareRenderer(zEngine, &surface);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (size_t i = 0; i < sizeof(benchMenus) / sizeof(benchMenus[0]); i++) {
+        // Stacked over the match without leaving it, the way the pause menu is
+        GameState menu = {.type = benchMenus[i].type, .isOverlay = 1};
+        stateMng->states[stateMng->top++] = &menu;
+        benchMenus[i].onEnter(zEngine);
+
+        // Same order as popState
+        stateMng->top--;
+        if (menu.stateData) clearStateData(&menu);
+        benchMenus[i].onExit(zEngine);
+    }
+    double_t ms = msSince(start);
+
+    detachSoftwareRenderer(zEngine, stubs, surface);
+    return ms;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+static const BenchScenario benchScenarios[] = {
+    {"load_prefabs", &benchLoadPrefabs},
+    {"spawn_2k_tanks", &benchSpawnTanks},
+    {"spawn_10k_bullets", &benchSpawnBullets},
+    {"tick_200_tanks_1k_bullets", &benchCrowdedTicks},
+    {"tick_200_tanks_1k_bullets_sweep", &benchCrowdedSweep},
+    {"grid_incremental_10k_movers", &benchIncrementalGrid},
+    {"grid_rebuild_10k_movers", &benchFlatGrid},
+    {"sweep_and_prune_10k_movers", &benchSweepAndPrune},
+    {"world_collisions_12k", &benchWorldCollisions},
+    {"raycast_batch_10k", &benchRaycastBatch},
+    {"delete_churn_10x10k", &benchDeleteChurn},
+    {"sweep_state_50k", &benchSweepState},
+    {"menu_states_ui", &benchMenuStates}
+};
+
+#define BENCH_SCENARIO_COUNT (sizeof(benchScenarios) / sizeof(benchScenarios[0]))
+
+/**
+ * Times a scenario over enough iterations to add up BENCH_SAMPLE_MS
+ * @param zEngine pointer to the engine
+ * @param scenario the scenario to run
+ * @return double_t = mean duration of an iteration's timed part, in milliseconds
+ */
+static double_t sampleScenario(ZENg zEngine, const BenchScenario *scenario) {
+    double_t total = 0.0;
+    Uint32 iterations = 0;
+    do {
+        // Every iteration starts from a freshly loaded arena, under the broadphase a match starts with
+        GameState *playState = getCurrState(zEngine->stateMng);
+        playState->onExit(zEngine);
+        setBroadphaseMode(zEngine->collisionMng, zEngine->ecs, zEngine->jobs, DEFAULT_BROADPHASE);
+        playState->onEnter(zEngine);
+
+        total += scenario->run(zEngine);
+        iterations++;
+    } while (total < BENCH_SAMPLE_MS);
+    return total / iterations;
+}
+
+/**
+ * Orders durations from the shortest to the longest
+ */
+static int compareDurations(const void *a, const void *b) {
+    double_t x = *(const double_t *)a, y = *(const double_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Reads the lower quartile and the fastest run of every scenario from a results file
+ * @param filePath path to the JSON file, as written by the benchmark
+ * @param quartiles where the lower quartiles go, indexed like benchScenarios, negative when the file lacks one
+ * @param fastest where the fastest runs go, indexed like benchScenarios, negative when the file lacks a scenario
+ * @return 1 if the file could be read, 0 otherwise
+ */
+static Uint8 loadBaseline(
+    const char *filePath, double_t quartiles[BENCH_SCENARIO_COUNT], double_t fastest[BENCH_SCENARIO_COUNT]
+) {
+    for (size_t i = 0; i < BENCH_SCENARIO_COUNT; i++) quartiles[i] = fastest[i] = -1.0;
+
+    FILE *f = fopen(filePath, "rb");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *data = malloc(size + 1);
+    if (!data) THROW_ERROR_AND_EXIT("Failed to allocate memory for the benchmark baseline");
+    fread(data, 1, size, f);
+    data[size] = '\0';
+    fclose(f);
+
+    cJSON *root = cJSON_Parse(data);
+    free(data);
+    if (!root) THROW_ERROR_AND_RETURN("Failed to parse the benchmark baseline", 0);
+
+    cJSON *scenarios = cJSON_GetObjectItem(root, "scenarios");
+    for (size_t i = 0; i < BENCH_SCENARIO_COUNT; i++) {
+        cJSON *scenario = cJSON_GetObjectItem(scenarios, benchScenarios[i].name);
+        cJSON *quartile = cJSON_GetObjectItem(scenario, "quartile_ms");
+        cJSON *min = cJSON_GetObjectItem(scenario, "min_ms");
+        if (cJSON_IsNumber(min)) fastest[i] = min->valuedouble;
+        if (cJSON_IsNumber(quartile)) quartiles[i] = quartile->valuedouble;
+    }
+    cJSON_Delete(root);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    // --baseline FILE compares against another results file, --out FILE is where the results go
+    // --threshold X is the tolerated slowdown (0.2 = 20%) on top of the spread of the runs
+    // --min-delta MS is the smallest slowdown in milliseconds that counts
+    // --repeat N the timed runs per scenario
+    const char *baselinePath = BENCH_BASELINE;
+    const char *outPath = BENCH_RESULTS;
+    double_t threshold = BENCH_THRESHOLD;
+    double_t minDelta = BENCH_MIN_DELTA_MS;
+    Uint32 repeats = BENCH_REPEATS;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) outPath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--min-delta") == 0 && i + 1 < argc) minDelta = atof(argv[++i]);
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeats = (Uint32)strtoul(argv[++i], NULL, 10);
+        else fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+    }
+    if (repeats == 0) repeats = 1;
+
+    ZENg zEngine = initGame(1);
+
+    double_t medians[BENCH_SCENARIO_COUNT], quartiles[BENCH_SCENARIO_COUNT], fastest[BENCH_SCENARIO_COUNT];
+    double_t *runs = malloc(BENCH_SCENARIO_COUNT * repeats * sizeof(double_t));
+    if (!runs) THROW_ERROR_AND_EXIT("Failed to allocate memory for the benchmark runs");
+
+    // Every round runs every scenario once, a slow spell of the machine costs each scenario one run, not all of them
+    for (Uint32 r = 0; r < repeats; r++) {
+        for (size_t i = 0; i < BENCH_SCENARIO_COUNT; i++) {
+            runs[i * repeats + r] = sampleScenario(zEngine, &benchScenarios[i]);
+        }
+    }
+    for (size_t i = 0; i < BENCH_SCENARIO_COUNT; i++) {
+        double_t *scenarioRuns = &runs[i * repeats];
+        qsort(scenarioRuns, repeats, sizeof(double_t), compareDurations);
+        medians[i] = scenarioRuns[repeats / 2];
+        quartiles[i] = scenarioRuns[repeats / 4];
+        fastest[i] = scenarioRuns[0];
+    }
+    free(runs);
+
+    destroyEngine(&zEngine);
+
+    // Results
+    FILE *fout = fopen(outPath, "w");
+    if (!fout) THROW_ERROR_AND_DO("Failed to open the benchmark results file ", fprintf(stderr, "'%s'\n", outPath););
+    else {
+        fprintf(fout, "{\n    \"repeats\": %u,\n    \"scenarios\": {\n", repeats);
+        for (size_t i = 0; i < BENCH_SCENARIO_COUNT; i++) {
+            fprintf(
+                fout, "        \"%s\": {\"median_ms\": %.4f, \"quartile_ms\": %.4f, \"min_ms\": %.4f}%s\n",
+                benchScenarios[i].name, medians[i], quartiles[i], fastest[i], i + 1 < BENCH_SCENARIO_COUNT ? "," : ""
+            );
+        }
+        fprintf(fout, "    }\n}\n");
+        fclose(fout);
+    }
+
+    // Comparison
+    double_t baselineQuartiles[BENCH_SCENARIO_COUNT], baseline[BENCH_SCENARIO_COUNT];
+    Uint8 hasBaseline = loadBaseline(baselinePath, baselineQuartiles, baseline);
+    if (!hasBaseline) printf("No baseline in %s, nothing to compare against\n", baselinePath);
+
+    Uint32 regressions = 0;
+    printf("%-32s %12s %12s %12s %9s %9s\n", "scenario", "median ms", "min ms", "baseline min", "change", "allowed");
+    for (size_t i = 0; i < BENCH_SCENARIO_COUNT; i++) {
+        printf("%-32s %12.4f %12.4f", benchScenarios[i].name, medians[i], fastest[i]);
+        if (baseline[i] <= 0.0) {
+            printf(" %12s %9s %9s\n", "-", "-", "-");
+            continue;
+        }
+        // How far the lower quartile sits above the fastest run, in whichever of the two runs was noisier
+        double_t spread = fastest[i] > 0.0 ? quartiles[i] / fastest[i] - 1.0 : 0.0;
+        if (baselineQuartiles[i] / baseline[i] - 1.0 > spread) spread = baselineQuartiles[i] / baseline[i] - 1.0;
+        double_t change = fastest[i] / baseline[i] - 1.0;
+        Uint8 regressed = change > threshold + spread && fastest[i] - baseline[i] > minDelta;
+        regressions += regressed;
+        printf(
+            " %12.4f %+8.1f%% %+8.1f%%%s\n", baseline[i], change * 100.0, (threshold + spread) * 100.0,
+            regressed ? "  REGRESSION" : ""
+        );
+    }
+    printf("Results written to %s\n", outPath);
+
+    if (regressions) {
+        printf(
+            "%u scenario(s) slower than the baseline by more than %.0f%% past their spread and %.2f ms\n",
+            regressions, threshold * 100.0, minDelta
+        );
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
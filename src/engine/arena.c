@@ -2,6 +2,16 @@
 
 Uint32 TILE_SIZE = 0;
 
+const char *const tileTypeNames[TILE_COUNT] = {
+    [TILE_EMPTY] = "TILE_EMPTY",
+    [TILE_GRASS] = "TILE_GRASS",
+    [TILE_WATER] = "TILE_WATER",
+    [TILE_ROCK] = "TILE_ROCK",
+    [TILE_BRICKS] = "TILE_BRICKS",
+    [TILE_WOOD] = "TILE_WOOD",
+    [TILE_SPAWN] = "TILE_SPAWN"
+};
+
 Vec2 tileToWorld(Uint32 idx) {
     return (Vec2){
         .x = (double_t)(idx % ARENA_WIDTH) * TILE_SIZE,
@@ -20,3 +30,56 @@ Uint32 worldToTile(Vec2 pos) {
     
     return y * ARENA_WIDTH + x;
 }
+
+void setArenaTile(Arena arena, Uint32 row, Uint32 col, Tile tile) {
+    if (!arena || !arena->tiles || row >= ARENA_HEIGHT || col >= ARENA_WIDTH) {
+        THROW_ERROR_AND_RETURN_VOID("Invalid arena or tile position in setArenaTile");
+    }
+    tile.idx = row * ARENA_WIDTH + col;
+    arena->tiles[row][col] = tile;
+
+    Uint64 bit = (Uint64)1 << col;
+    const Uint8 inLayer[TILE_LAYER_COUNT] = {
+        [TILE_LAYER_SOLID] = tile.isSolid,
+        [TILE_LAYER_UNWALKABLE] = !tile.isWalkable
+    };
+    for (Uint32 layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        if (inLayer[layer]) arena->layers[layer][row] |= bit;
+        else arena->layers[layer][row] &= ~bit;
+    }
+}
+
+Uint64 getColumnsMask(Int32 minCol, Int32 maxCol) {
+    if (minCol < 0) minCol = 0;
+    if (maxCol >= ARENA_WIDTH) maxCol = ARENA_WIDTH - 1;
+    if (minCol > maxCol) return 0;
+
+    // Built from the top so a full 64 column row doesn't shift by 64
+    Uint64 upTo = ~(Uint64)0 >> (63 - maxCol);
+    return upTo & (~(Uint64)0 << minCol);
+}
+
+Uint8 findLayerTile(
+    Arena arena, TileLayer layer, Int32 minCol, Int32 maxCol, Int32 minRow, Int32 maxRow, Uint32 *tileIdx
+) {
+    if (minRow < 0) minRow = 0;
+    if (maxRow >= ARENA_HEIGHT) maxRow = ARENA_HEIGHT - 1;
+    Uint64 cols = getColumnsMask(minCol, maxCol);
+    if (!cols) return 0;
+
+    for (Int32 row = minRow; row <= maxRow; row++) {
+        Uint64 hits = arena->layers[layer][row] & cols;
+        if (!hits) continue;
+
+        if (tileIdx) {
+            Uint32 col = 0;
+            while (!(hits & 1)) {
+                hits >>= 1;
+                col++;
+            }
+            *tileIdx = row * ARENA_WIDTH + col;
+        }
+        return 1;
+    }
+    return 0;
+}
@@ -6,6 +6,11 @@
 #define ARENA_WIDTH 64  // Arena width, in tiles
 #define ARENA_HEIGHT 36  // Arena height, in tiles
 extern Uint32 TILE_SIZE;  // Size of a tile, in pixels
+#define PROJECTILES_PER_TANK 32  // Projectiles in flight per tank that a level pre-sizes the ECS for
+
+#if ARENA_WIDTH > 64
+    #error "A row of the arena's tile layers has to fit in 64 bits"
+#endif
 
 typedef enum {
     TILE_EMPTY,
@@ -18,6 +23,8 @@ typedef enum {
     TILE_COUNT  // Automatically counts
 } TileType;
 
+extern const char *const tileTypeNames[TILE_COUNT];  // Key of every tile type's prefab, indexed by TileType
+
 typedef struct {
     SDL_Texture *texture;  // Tile sprite
     double_t speedMod;  // Speed modifier for entities on this tile
@@ -28,10 +35,52 @@ typedef struct {
     Uint8 isSolid;  // If true, projectiles cannot pass through
 } Tile;
 
+// Tile flags packed one bit per column for every row, a set bit is a tile that blocks something
+typedef enum {
+    TILE_LAYER_SOLID,  // isSolid, the tiles projectiles can't pass
+    TILE_LAYER_UNWALKABLE,  // !isWalkable, the tiles tanks can't drive over
+    TILE_LAYER_COUNT  // Automatically counts
+} TileLayer;
+
 typedef struct arena {
     Tile **tiles;  // 2D array of tiles representing the arena
+    Uint64 layers[TILE_LAYER_COUNT][ARENA_HEIGHT];  // Bit col of layers[l][row] is set if tiles[row][col] is in layer l
 } *Arena;
 
+/**
+ * Places a tile in the arena and keeps the tile layers in sync with it
+ * @param arena the arena
+ * @param row row of the tile
+ * @param col column of the tile
+ * @param tile the tile, its index is set to where it goes
+ * @note every write to the arena's tiles goes through here, or the layers go stale
+ */
+void setArenaTile(Arena arena, Uint32 row, Uint32 col, Tile tile);
+
+/**
+ * Gets the bits of a range of columns, for masking the rows of a tile layer
+ * @param minCol left column, clamped to the arena
+ * @param maxCol right column, clamped to the arena
+ * @return Uint64 = the bits of the columns from minCol to maxCol, 0 if none of them is in the arena
+ */
+Uint64 getColumnsMask(Int32 minCol, Int32 maxCol);
+
+/**
+ * Looks for a tile of a layer in a block of the arena, a row at a time
+ * @param arena the arena
+ * @param layer the tile layer
+ * @param minCol left column of the block
+ * @param maxCol right column of the block
+ * @param minRow top row of the block
+ * @param maxRow bottom row of the block
+ * @param tileIdx where the index of the first tile found goes, row by row, may be NULL
+ * @return Uint8 = 1 if the block has a tile of the layer, 0 otherwise
+ * @note the parts of the block outside the arena are skipped
+ */
+Uint8 findLayerTile(
+    Arena arena, TileLayer layer, Int32 minCol, Int32 maxCol, Int32 minRow, Int32 maxRow, Uint32 *tileIdx
+);
+
 /**
  * Converts a tile's index to vector coordinates
  * @param idx the index of the tile
@@ -3,6 +3,12 @@
 #include "engine/core/ecs.h"
 #include "engine/core/engine.h"
 
+const char *const broadphaseNames[BROADPHASE_COUNT] = {
+    [BROADPHASE_INCREMENTAL] = "INCREMENTAL",
+    [BROADPHASE_REBUILD] = "REBUILD",
+    [BROADPHASE_SWEEP] = "SWEEP"
+};
+
 CollisionManager initCollisionManager() {
     CollisionManager cm = calloc(1, sizeof(struct colmng));
     if (!cm) THROW_ERROR_AND_EXIT("Failed allocating memory for the Collision Manager");
@@ -22,6 +28,14 @@ CollisionManager initCollisionManager() {
         cell->entityCount = 0;
     }
 
+    // The flat grid starts out empty, every cell's range is [0, 0)
+    cm->flatGrid.cellStart = calloc(totalCells + 1, sizeof(Uint32));
+    if (!cm->flatGrid.cellStart) THROW_ERROR_AND_EXIT("Failed allocating memory for the flat grid's cell offsets");
+    cm->flatGrid.capacity = 1024;
+    cm->flatGrid.entities = malloc(cm->flatGrid.capacity * sizeof(Entity));
+    if (!cm->flatGrid.entities) THROW_ERROR_AND_EXIT("Failed allocating memory for the flat grid's entities");
+    cm->broadphase = DEFAULT_BROADPHASE;
+
     populateHandlersTables(cm);
     return cm;
 }
@@ -40,6 +54,13 @@ void freeCollisionManager(CollisionManager cm) {
 
     // Free the spatial grid
     if (cm->spatialGrid) free(cm->spatialGrid);
+    free(cm->flatGrid.cellStart);
+    free(cm->flatGrid.entities);
+    free(cm->flatGrid.chunkCounts);
+    free(cm->pairs);
+    free(cm->candidates);
+    free(cm->sweepList.entries);
+    free(cm->swept);
 
     // Free the collision manager itself
     free(cm);
@@ -54,20 +75,23 @@ void registerEVsEHandler(CollisionManager cm, CollisionRole roleA, CollisionRole
     cm->eVsEHandlers[roleA][roleB] = handler;
     cm->eVsEHandlers[roleB][roleA] = handler;
 
-#if defined(DEBUGCOLLISION) && defined(DEBUGPP)
-    printf("Registered Entity VS Entity collision handler for roles %d | %d : %p\n", roleA, roleB, handler);
-#endif
+    LOG_DEBUG(
+        LOG_COLLISIONS, "Registered Entity VS Entity collision handler for roles %d | %d : %p",
+        roleA, roleB, (void *)handler
+    );
 }
 
 // =====================================================================================================================
 
-void registerEVsWHandler(CollisionManager cm, CollisionRole role, entityVsWorldHandler handler) {
-    if (role >= COL_ROLE_COUNT) return;
+void registerEVsWHandler(CollisionManager cm, CollisionRole role, TileLayer layer, entityVsWorldHandler handler) {
+    if (role >= COL_ROLE_COUNT || layer >= TILE_LAYER_COUNT) return;
     cm->eVsWHandlers[role] = handler;
+    cm->eVsWLayers[role] = layer;
 
-#if defined(DEBUGCOLLISION) && defined(DEBUGPP)
-    printf("Registered Entity VS World collision handler for role %d : %p\n", role, handler);
-#endif
+    LOG_DEBUG(
+        LOG_COLLISIONS, "Registered Entity VS World collision handler for role %d on layer %d : %p",
+        role, layer, (void *)handler
+    );
 }
 
 // =====================================================================================================================
@@ -87,9 +111,10 @@ void normalizeRoles(Entity *A, Entity *B, CollisionComponent **colCompA, Collisi
 // =====================================================================================================================
 
 void actorVsWorldColHandler(ZENg zEngine, Entity actor, Tile *tile) {
-#ifdef DEBUGCOLLISIONS
-    printf("[WORLD COLLISION SYSTEM] Actor VS World collision: Entity %lu | Tile type %d\n", actor, tile->type);
-#endif
+    LOG_TRACE(
+        LOG_COLLISIONS, "[WORLD COLLISION SYSTEM] Actor VS World collision: Entity %lu | Tile type %d",
+        actor, tile->type
+    );
     if (tile->isWalkable) return;  // Move freely
 
     if (!HAS_COMPONENT(zEngine->ecs, actor, COLLISION_COMPONENT))
@@ -113,9 +138,7 @@ void actorVsWorldColHandler(ZENg zEngine, Entity actor, Tile *tile) {
     aVelComp->currVelocity.x = 0.0;
     aVelComp->predictedPos.x = aColComp->hitbox->x;
 
-#ifdef DEBUGCOLLISIONS
-    printf("[WORLD COLLISION SYSTEM] Clamped entity %lu on X axis\n", actor);
-#endif
+    LOG_TRACE(LOG_COLLISIONS, "[WORLD COLLISION SYSTEM] Clamped entity %lu on X axis", actor);
 
     // Resolve Y-Axis wall collisions
     double_t moveY = aVelComp->currVelocity.y;
@@ -129,17 +152,17 @@ void actorVsWorldColHandler(ZENg zEngine, Entity actor, Tile *tile) {
     }
     aVelComp->currVelocity.y = 0.0;
     aVelComp->predictedPos.y = aColComp->hitbox->y;
-#if defined(DEBUGCOLLISIONS) && defined(DEBUGPP)
-    printf("[WORLD COLLIISON SYSTEM] Clamped entity %lu on Y axis\n", actor);
-#endif
+
+    LOG_TRACE(LOG_COLLISIONS, "[WORLD COLLISION SYSTEM] Clamped entity %lu on Y axis", actor);
 }
 
 // =====================================================================================================================
 
 void projectileVsWorldColHandler(ZENg zEngine, Entity projectile, Tile *tile) {
-#ifdef DEBUGCOLLISIONS
-    printf("[WORLD COLLISION SYSTEM] Projectile VS World collision: Entity %lu | Tile %d\n", projectile, tile->type);
-#endif
+    LOG_TRACE(
+        LOG_COLLISIONS, "[WORLD COLLISION SYSTEM] Projectile VS World collision: Entity %lu | Tile %d",
+        projectile, tile->type
+    );
     if (!tile->isSolid) return;  // Bullet passes through this wall
     if (!HAS_COMPONENT(zEngine->ecs, projectile, PROJECTILE_COMPONENT))
         THROW_ERROR_AND_RETURN_VOID("Projectile entity without projectile component in projectileVsWorldCollision");
@@ -149,28 +172,19 @@ void projectileVsWorldColHandler(ZENg zEngine, Entity projectile, Tile *tile) {
          (tile->type == TILE_BRICKS && projComp->dmg >= 15)
          || (tile->type == TILE_ROCK && projComp->dmg >= 30)
      ) {
-         char *tileTypeToStr[] = {
-             [TILE_EMPTY] = "TILE_EMPTY",
-             [TILE_GRASS] = "TILE_GRASS",
-             [TILE_WATER] = "TILE_WATER",
-             [TILE_ROCK] = "TILE_ROCK",
-             [TILE_BRICKS] = "TILE_BRICKS",
-             [TILE_WOOD] = "TILE_WOOD",
-             [TILE_SPAWN] = "TILE_SPAWN"
-         };
          Uint32 tileY = tile->idx / ARENA_WIDTH;
          Uint32 tileX = tile->idx % ARENA_WIDTH;
-         zEngine->map->tiles[tileY][tileX] = getTilePrefab(zEngine->prefabs, tileTypeToStr[TILE_EMPTY]);
+         setArenaTile(zEngine->map, tileY, tileX, getTilePrefab(zEngine->prefabs, tileTypeNames[TILE_EMPTY]));
      }
-     deleteEntity(zEngine->ecs, projectile);
+     deferDeleteEntity(zEngine->ecs, projectile);
 }
 
 // =====================================================================================================================
 
 void projectileVsActorColHandler(ZENg zEngine, Entity actor, Entity projectile) {
-#ifdef DEBUGCOLLISIONS
-    printf("[ENTITY COLLISION SYSTEM] Projectile(%lu) VS Actor(%lu) collision\n", actor, projectile);
-#endif
+    LOG_TRACE(
+        LOG_COLLISIONS, "[ENTITY COLLISION SYSTEM] Projectile(%lu) VS Actor(%lu) collision", actor, projectile
+    );
     if (!HAS_COMPONENT(zEngine->ecs, projectile, PROJECTILE_COMPONENT)) THROW_ERROR_AND_RETURN_VOID(
             "Projectile without projectile component in projectileVsActorColHandler\n"
         );
@@ -186,24 +200,51 @@ void projectileVsActorColHandler(ZENg zEngine, Entity actor, Entity projectile)
     healthComp->currentHealth -= projComp->dmg;
     markComponentDirty(zEngine->ecs, actor, HEALTH_COMPONENT);
 
-    deleteEntity(zEngine->ecs, projectile);
+    deferDeleteEntity(zEngine->ecs, projectile);
 }
 
 // =====================================================================================================================
 
 void populateHandlersTables(CollisionManager cm) {
-    registerEVsWHandler(cm, COL_ACTOR, &actorVsWorldColHandler);
-    registerEVsWHandler(cm, COL_BULLET, &projectileVsWorldColHandler);
+    registerEVsWHandler(cm, COL_ACTOR, TILE_LAYER_UNWALKABLE, &actorVsWorldColHandler);
+    registerEVsWHandler(cm, COL_BULLET, TILE_LAYER_SOLID, &projectileVsWorldColHandler);
     registerEVsEHandler(cm, COL_BULLET, COL_ACTOR, &projectileVsActorColHandler);
 }
 
 // =====================================================================================================================
 
+void appendSweepEntry(SweepList *list, Entity e) {
+    if (list->count >= list->capacity) {
+        Uint32 newCapacity = list->capacity ? list->capacity * 2 : 256;
+        SweepEntry *tmp = realloc(list->entries, newCapacity * sizeof(SweepEntry));
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the sweep list");
+        list->entries = tmp;
+        list->capacity = newCapacity;
+    }
+    list->entries[list->count++] = (SweepEntry){.entity = e};
+}
+
+// =====================================================================================================================
+
+/**
+ * Orders sweep entries by their left edge, then by entity so the order doesn't depend on qsort
+ */
+static int compareSweepEntries(const void *a, const void *b) {
+    const SweepEntry *x = (const SweepEntry *)a, *y = (const SweepEntry *)b;
+    if (x->minX != y->minX) return (x->minX > y->minX) - (x->minX < y->minX);
+    return (x->entity > y->entity) - (x->entity < y->entity);
+}
+
 void registerEntityToSG(CollisionManager cm, Entity e, CollisionComponent *colComp) {
     if (!cm) THROW_ERROR_AND_RETURN_VOID("Collision manager NULL in insertEntityToSG");
     if (!colComp) THROW_ERROR_AND_RETURN_VOID("Entity's colComp NULL in insertEntityToSG");
     SDL_Rect *hb = colComp->hitbox;
     if (!hb) THROW_ERROR_AND_RETURN_VOID("Entity's hitbox NULL in insertEntityToSG");
+    if (cm->broadphase == BROADPHASE_SWEEP) {
+        // Sorted into place by the next sweep
+        appendSweepEntry(&cm->sweepList, e);
+        return;
+    }
 
     // Compute the tile range that the entity covers. At instantiation the hitbox corresponds to the position component
     Int32 startX = hb->x / TILE_SIZE;
@@ -221,10 +262,11 @@ void registerEntityToSG(CollisionManager cm, Entity e, CollisionComponent *colCo
     colComp->coverageStart = (Uint16)COL_GRID_INDEX(cm, startX, startY);
     colComp->coverageEnd = (Uint16)COL_GRID_INDEX(cm, endX, endY);
 
-#ifdef DEBUGCOLLISIONS
-    fprintf(stderr, "[ENTITY COLLISION SYSTEM] Registering entity %lu to spatial grid: y:%d-%d, x:%d-%d\n",
-            e, startY, endY, startX, endX);
-#endif
+    LOG_TRACE(
+        LOG_COLLISIONS, "[ENTITY COLLISION SYSTEM] Registering entity %lu to spatial grid: y:%d-%d, x:%d-%d",
+        e, startY, endY, startX, endX
+    );
+    if (cm->broadphase == BROADPHASE_REBUILD) return;  // The next rebuild picks it up
 
     // Insert into all covered cells
     for (Int32 x = startX; x <= endX; x++) {
@@ -270,11 +312,11 @@ void removeEntityFromSGCell(Entity e, GridCell *cell) {
 
 // =====================================================================================================================
 
-void updateGridMembership(CollisionManager cm, Entity e, VelocityComponent *velComp, CollisionComponent *colComp) {
+void updateGridMembership(CollisionManager cm, Entity e, CollisionComponent *colComp) {
     // Get the changed grid coverage and delete/insert from corresponding cells
     
     SDL_Rect *hb = colComp->hitbox;
-    Vec2 currPos = velComp->predictedPos;
+    Vec2 currPos = {.x = hb->x, .y = hb->y};
     
     Uint16 prevMinX = colComp->coverageStart % ARENA_WIDTH;
     Uint16 prevMinY = colComp->coverageStart / ARENA_WIDTH;
@@ -305,9 +347,9 @@ void updateGridMembership(CollisionManager cm, Entity e, VelocityComponent *velC
                 size_t cellIdx = COL_GRID_INDEX(cm, x, y);
                 GridCell *cell = &cm->spatialGrid[cellIdx];
 
-#ifdef DEBUGCOLLISIONS
-                printf("[ENTITY COLLISION SYSTEM] Inserting entity %lu to cell (y=%d, x=%d)\n", e, y, x);
-#endif
+                LOG_TRACE(
+                    LOG_COLLISIONS, "[ENTITY COLLISION SYSTEM] Inserting entity %lu to cell (y=%d, x=%d)", e, y, x
+                );
 
                 insertEntityToSGCell(e, cell);
             }
@@ -321,11 +363,545 @@ void updateGridMembership(CollisionManager cm, Entity e, VelocityComponent *velC
             if (x < currMinX || x > currMaxX || y < currMinY || y > currMaxY) {
                 size_t cellIdx = COL_GRID_INDEX(cm, x, y);
                 GridCell *cell = &cm->spatialGrid[cellIdx];
-#ifdef DEBUGCOLLISIONS
-                printf("[ENTITY COLLISION SYSTEM] Removing entity %lu from cell (y=%d, x=%d)\n", e, y, x);
-#endif
+                LOG_TRACE(
+                    LOG_COLLISIONS, "[ENTITY COLLISION SYSTEM] Removing entity %lu from cell (y=%d, x=%d)", e, y, x
+                );
                 removeEntityFromSGCell(e, cell);
             }
         }
     }
 }
+
+// =====================================================================================================================
+
+typedef struct {
+    CollisionManager cm;
+    ComponentTypeSet *colComps;  // The collision components, the flat grid is built from their hitboxes
+    Uint64 chunkSize;  // Entities per chunk, to find a chunk's histogram from its start
+} FlatGridJob;
+
+/**
+ * Computes the range of cells a hitbox covers, the same way updateGridMembership does
+ * @param hb the hitbox
+ * @param minX where the leftmost column goes
+ * @param minY where the top row goes
+ * @param maxX where the rightmost column goes
+ * @param maxY where the bottom row goes
+ * @return 1 if the hitbox overlaps the grid, 0 otherwise
+ */
+static Uint8 getHitboxCoverage(const SDL_Rect *hb, Int32 *minX, Int32 *minY, Int32 *maxX, Int32 *maxY) {
+    *minX = hb->x / TILE_SIZE;
+    *minY = hb->y / TILE_SIZE;
+    *maxX = (hb->x + hb->w + TILE_SIZE - 1) / TILE_SIZE;
+    *maxY = (hb->y + hb->h + TILE_SIZE - 1) / TILE_SIZE;
+
+    // Clamp to grid boundaries
+    if (*maxX < 0 || *maxY < 0 || *minX >= ARENA_WIDTH || *minY >= ARENA_HEIGHT) return 0;
+    if (*minX < 0) *minX = 0;
+    if (*minY < 0) *minY = 0;
+    if (*maxX >= ARENA_WIDTH) *maxX = ARENA_WIDTH - 1;
+    if (*maxY >= ARENA_HEIGHT) *maxY = ARENA_HEIGHT - 1;
+    return 1;
+}
+
+/**
+ * First pass of the rebuild, counts the entities of a chunk per cell and updates their coverage
+ * @param data the FlatGridJob
+ * @param start first index in the collision components' dense array
+ * @param end one past the last index
+ */
+static void countFlatGridRange(void *data, Uint64 start, Uint64 end) {
+    FlatGridJob *job = (FlatGridJob *)data;
+    Uint32 *counts = &job->cm->flatGrid.chunkCounts[(start / job->chunkSize) * ARENA_WIDTH * ARENA_HEIGHT];
+
+    for (Uint64 i = start; i < end; i++) {
+        CollisionComponent *colComp = (CollisionComponent *)DENSE_AT(job->colComps, i);
+        Int32 minX, minY, maxX, maxY;
+        if (!getHitboxCoverage(colComp->hitbox, &minX, &minY, &maxX, &maxY)) continue;
+
+        colComp->coverageStart = COL_GRID_INDEX(job->cm, minX, minY);
+        colComp->coverageEnd = COL_GRID_INDEX(job->cm, maxX, maxY);
+        for (Int32 y = minY; y <= maxY; y++) {
+            for (Int32 x = minX; x <= maxX; x++) counts[COL_GRID_INDEX(job->cm, x, y)]++;
+        }
+    }
+}
+
+/**
+ * Second pass of the rebuild, writes the entities of a chunk at their cells' cursors
+ * @param data the FlatGridJob
+ * @param start first index in the collision components' dense array
+ * @param end one past the last index
+ */
+static void scatterFlatGridRange(void *data, Uint64 start, Uint64 end) {
+    FlatGridJob *job = (FlatGridJob *)data;
+    FlatGrid *grid = &job->cm->flatGrid;
+    Uint32 *cursors = &grid->chunkCounts[(start / job->chunkSize) * ARENA_WIDTH * ARENA_HEIGHT];
+
+    for (Uint64 i = start; i < end; i++) {
+        CollisionComponent *colComp = (CollisionComponent *)DENSE_AT(job->colComps, i);
+        Int32 minX, minY, maxX, maxY;
+        if (!getHitboxCoverage(colComp->hitbox, &minX, &minY, &maxX, &maxY)) continue;
+
+        Entity owner = job->colComps->denseToEntity[i];
+        for (Int32 y = minY; y <= maxY; y++) {
+            for (Int32 x = minX; x <= maxX; x++) grid->entities[cursors[COL_GRID_INDEX(job->cm, x, y)]++] = owner;
+        }
+    }
+}
+
+void rebuildFlatGrid(CollisionManager cm, ECS ecs, JobSystem jobs) {
+    if (!cm || !ecs) THROW_ERROR_AND_RETURN_VOID("Collision manager or ECS NULL in rebuildFlatGrid");
+    PROFILE_BEGIN(zone, "rebuildFlatGrid");
+
+    FlatGrid *grid = &cm->flatGrid;
+    ComponentTypeSet *colComps = &ecs->components[COLLISION_COMPONENT];
+    Uint64 count = colComps->denseSize;
+    const size_t totalCells = ARENA_WIDTH * ARENA_HEIGHT;
+
+    // One chunk per worker, unless that leaves them too little to do
+    Uint32 workers = getJobWorkerCount(jobs);
+    Uint64 chunkSize = (count + workers - 1) / workers;
+    if (chunkSize < FLAT_GRID_MIN_CHUNK) chunkSize = FLAT_GRID_MIN_CHUNK;
+    Uint32 chunks = (Uint32)((count + chunkSize - 1) / chunkSize);
+
+    if (chunks > grid->chunkCapacity) {
+        Uint32 *tmp = realloc(grid->chunkCounts, chunks * totalCells * sizeof(Uint32));
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the flat grid's histograms");
+        grid->chunkCounts = tmp;
+        grid->chunkCapacity = chunks;
+    }
+    if (chunks) memset(grid->chunkCounts, 0, chunks * totalCells * sizeof(Uint32));
+
+    FlatGridJob job = {.cm = cm, .colComps = colComps, .chunkSize = chunkSize};
+    parallelFor(jobs, count, chunkSize, countFlatGridRange, &job);
+
+    // Exclusive prefix sum, the chunks of a cell follow each other so the sort stays stable
+    Uint32 total = 0;
+    for (size_t c = 0; c < totalCells; c++) {
+        grid->cellStart[c] = total;
+        for (Uint32 k = 0; k < chunks; k++) {
+            Uint32 *slot = &grid->chunkCounts[k * totalCells + c];
+            Uint32 cellCount = *slot;
+            *slot = total;  // From now on the chunk's write cursor in this cell
+            total += cellCount;
+        }
+    }
+    grid->cellStart[totalCells] = total;
+
+    if (total > grid->capacity) {
+        Uint32 newCapacity = grid->capacity * 2 > total ? grid->capacity * 2 : total;
+        Entity *tmp = realloc(grid->entities, newCapacity * sizeof(Entity));
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the flat grid's entities");
+        grid->entities = tmp;
+        grid->capacity = newCapacity;
+    }
+
+    parallelFor(jobs, count, chunkSize, scatterFlatGridRange, &job);
+    PROFILE_END(zone);
+}
+
+// =====================================================================================================================
+
+size_t getSGCellEntities(CollisionManager cm, size_t cellIdx, Entity **entities) {
+    if (cm->broadphase == BROADPHASE_SWEEP) {
+        *entities = NULL;
+        return 0;
+    }
+    if (cm->broadphase == BROADPHASE_REBUILD) {
+        Uint32 start = cm->flatGrid.cellStart[cellIdx];
+        *entities = &cm->flatGrid.entities[start];
+        return cm->flatGrid.cellStart[cellIdx + 1] - start;
+    }
+    *entities = cm->spatialGrid[cellIdx].entities;
+    return cm->spatialGrid[cellIdx].entityCount;
+}
+
+// =====================================================================================================================
+
+/**
+ * Drops the handles of dead entities from a cell of the incremental grid, they never leave on their own
+ * @param ecs the ECS
+ * @param cell the cell
+ */
+static void pruneSGCell(ECS ecs, GridCell *cell) {
+    for (size_t i = 0; i < cell->entityCount; i++) {
+        if (!isAlive(ecs, cell->entities[i])) cell->entities[i--] = cell->entities[--cell->entityCount];
+    }
+}
+
+/**
+ * Appends a pair to the collision manager's pairs array, the entity with the lower role first
+ * @param cm the collision manager
+ * @param a an entity
+ * @param aColComp its collision component
+ * @param b the other entity
+ * @param bColComp its collision component
+ */
+static void pushCollisionPair(
+    CollisionManager cm, Entity a, CollisionComponent *aColComp, Entity b, CollisionComponent *bColComp
+) {
+    if (cm->pairCount >= cm->pairCapacity) {
+        Uint32 newCapacity = cm->pairCapacity ? cm->pairCapacity * 2 : 256;
+        CollisionPair *tmp = realloc(cm->pairs, newCapacity * sizeof(CollisionPair));
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the collision pairs");
+        cm->pairs = tmp;
+        cm->pairCapacity = newCapacity;
+    }
+    normalizeRoles(&a, &b, &aColComp, &bColComp);
+    cm->pairs[cm->pairCount++] = (CollisionPair){.a = a, .b = b};
+}
+
+/**
+ * Sort and sweep: refreshes the endpoints, re-sorts the list and pairs up the entries whose X spans overlap
+ * @param cm the collision manager
+ * @param ecs the ECS
+ */
+static void sweepCollisionPairs(CollisionManager cm, ECS ecs) {
+    SweepList *list = &cm->sweepList;
+
+    // Refresh the endpoints, the entities that died or lost their hitbox leave the list
+    Uint32 kept = 0;
+    for (Uint32 i = 0; i < list->count; i++) {
+        Entity e = list->entries[i].entity;
+        if (!isAlive(ecs, e) || !HAS_COMPONENT(ecs, e, COLLISION_COMPONENT)) continue;
+        CollisionComponent *colComp = NULL;
+        GET_COMPONENT(ecs, e, COLLISION_COMPONENT, colComp, CollisionComponent);
+
+        // The debug overlay still draws the coverage
+        Int32 minX, minY, maxX, maxY;
+        if (getHitboxCoverage(colComp->hitbox, &minX, &minY, &maxX, &maxY)) {
+            colComp->coverageStart = COL_GRID_INDEX(cm, minX, minY);
+            colComp->coverageEnd = COL_GRID_INDEX(cm, maxX, maxY);
+        }
+        SDL_Rect *hb = colComp->hitbox;
+        list->entries[kept++] = (SweepEntry){
+            .entity = e, .colComp = colComp, .role = colComp->role,
+            .minX = hb->x, .maxX = hb->x + hb->w, .minY = hb->y, .maxY = hb->y + hb->h
+        };
+    }
+    list->count = kept;
+
+    // Insertion sort, the order of the last tick is nearly right so each entry only moves a few slots.
+    // A burst of new entities or a teleport breaks that, then it gives up and sorts from scratch
+    Uint64 shiftBudget = (Uint64)list->count * SWEEP_MAX_SHIFTS;
+    for (Uint32 i = 1; i < list->count; i++) {
+        SweepEntry entry = list->entries[i];
+        Uint32 j = i;
+        while (j > 0 && list->entries[j - 1].minX > entry.minX && shiftBudget) {
+            list->entries[j] = list->entries[j - 1];
+            j--;
+            shiftBudget--;
+        }
+        list->entries[j] = entry;
+        if (!shiftBudget) {
+            qsort(list->entries, list->count, sizeof(SweepEntry), compareSweepEntries);
+            break;
+        }
+    }
+
+    // Every entry is only compared to the ones starting before it ends
+    for (Uint32 i = 0; i < list->count; i++) {
+        SweepEntry *a = &list->entries[i];
+        for (Uint32 j = i + 1; j < list->count && list->entries[j].minX < a->maxX; j++) {
+            SweepEntry *b = &list->entries[j];
+            if (a->minY >= b->maxY || b->minY >= a->maxY) continue;
+            if (!cm->eVsEHandlers[a->role][b->role] || b->entity == a->entity) continue;
+            pushCollisionPair(cm, a->entity, a->colComp, b->entity, b->colComp);
+        }
+    }
+}
+
+void findCollisionPairs(CollisionManager cm, ECS ecs) {
+    if (!cm || !ecs) THROW_ERROR_AND_RETURN_VOID("Collision manager or ECS NULL in findCollisionPairs");
+    PROFILE_BEGIN(zone, "findCollisionPairs");
+
+    cm->pairCount = 0;
+    if (cm->broadphase == BROADPHASE_SWEEP) {
+        sweepCollisionPairs(cm, ecs);
+        PROFILE_END(zone);
+        return;
+    }
+
+    for (size_t cellIdx = 0; cellIdx < ARENA_WIDTH * ARENA_HEIGHT; cellIdx++) {
+        if (cm->broadphase == BROADPHASE_INCREMENTAL) pruneSGCell(ecs, &cm->spatialGrid[cellIdx]);
+
+        Entity *cellEntities = NULL;
+        size_t cellCount = getSGCellEntities(cm, cellIdx, &cellEntities);
+        if (cellCount < 2) continue;
+        Uint16 cellX = cellIdx % ARENA_WIDTH;
+        Uint16 cellY = cellIdx / ARENA_WIDTH;
+
+        // Look the components up once per cell instead of once per pair
+        if (cellCount > cm->candidateCapacity) {
+            PairCandidate *tmp = realloc(cm->candidates, cellCount * sizeof(PairCandidate));
+            if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the collision pair candidates");
+            cm->candidates = tmp;
+            cm->candidateCapacity = cellCount;
+        }
+        Uint32 candidateCount = 0;
+        for (size_t i = 0; i < cellCount; i++) {
+            Entity e = cellEntities[i];
+            if (!isAlive(ecs, e) || !HAS_COMPONENT(ecs, e, COLLISION_COMPONENT)) continue;
+            CollisionComponent *colComp = NULL;
+            GET_COMPONENT(ecs, e, COLLISION_COMPONENT, colComp, CollisionComponent);
+            cm->candidates[candidateCount++] = (PairCandidate){
+                .entity = e, .colComp = colComp,
+                .minX = colComp->coverageStart % ARENA_WIDTH, .minY = colComp->coverageStart / ARENA_WIDTH
+            };
+        }
+
+        for (Uint32 i = 0; i < candidateCount; i++) {
+            PairCandidate *a = &cm->candidates[i];
+            for (Uint32 j = i + 1; j < candidateCount; j++) {
+                PairCandidate *b = &cm->candidates[j];
+                if (b->entity == a->entity) continue;
+                if (!cm->eVsEHandlers[a->colComp->role][b->colComp->role]) continue;  // Nothing would happen anyway
+
+                // The pair is in every cell of the overlap of their coverages, the top left one owns it
+                if ((a->minX > b->minX ? a->minX : b->minX) != cellX) continue;
+                if ((a->minY > b->minY ? a->minY : b->minY) != cellY) continue;
+
+                pushCollisionPair(cm, a->entity, a->colComp, b->entity, b->colComp);
+            }
+        }
+    }
+    PROFILE_END(zone);
+}
+
+// =====================================================================================================================
+
+void setBroadphaseMode(CollisionManager cm, ECS ecs, JobSystem jobs, BroadphaseMode mode) {
+    if (!cm || !ecs) THROW_ERROR_AND_RETURN_VOID("Collision manager or ECS NULL in setBroadphaseMode");
+    if (mode >= BROADPHASE_COUNT || mode == cm->broadphase) return;
+
+    cm->broadphase = mode;
+    refillBroadphase(cm, ecs, jobs);
+}
+
+// =====================================================================================================================
+
+void refillBroadphase(CollisionManager cm, ECS ecs, JobSystem jobs) {
+    if (!cm || !ecs) THROW_ERROR_AND_RETURN_VOID("Collision manager or ECS NULL in refillBroadphase");
+
+    BroadphaseMode mode = cm->broadphase;
+    cm->sweepList.count = 0;  // Refilled below if the sweep is the broadphase
+    ComponentTypeSet *colComps = &ecs->components[COLLISION_COMPONENT];
+    if (mode == BROADPHASE_REBUILD) {
+        rebuildFlatGrid(cm, ecs, jobs);
+        return;
+    }
+    if (mode == BROADPHASE_SWEEP) {
+        // The first sweep sorts it from scratch
+        for (Uint64 i = 0; i < colComps->denseSize; i++) appendSweepEntry(&cm->sweepList, colComps->denseToEntity[i]);
+        return;
+    }
+
+    // The cells stop following the entities while another broadphase runs, they start over from the hitboxes
+    for (size_t i = 0; i < ARENA_WIDTH * ARENA_HEIGHT; i++) cm->spatialGrid[i].entityCount = 0;
+    for (Uint64 i = 0; i < colComps->denseSize; i++) {
+        registerEntityToSG(cm, colComps->denseToEntity[i], (CollisionComponent *)DENSE_AT(colComps, i));
+    }
+}
+
+// =====================================================================================================================
+
+BroadphaseMode getBroadphaseFromName(const char *name) {
+    for (BroadphaseMode mode = 0; mode < BROADPHASE_COUNT; mode++) {
+        if (strcmp(name, broadphaseNames[mode]) == 0) return mode;
+    }
+    return BROADPHASE_COUNT;
+}
+
+// =====================================================================================================================
+
+/**
+ * Finds the tiles a moving span covers right after a given moment, on one axis
+ * @param start where the span starts at that moment
+ * @param length length of the span
+ * @param move which way it moves, only the sign matters
+ * @param first where the first tile goes
+ * @param last where the last tile goes
+ * @note a span ending right on a tile's edge covers that tile only if it moves into it
+ */
+static void getSpanTiles(double_t start, double_t length, Int32 move, Int32 *first, Int32 *last) {
+    double_t tile = (double_t)TILE_SIZE;
+    *first = move < 0 ? (Int32)ceil(start / tile) - 1 : (Int32)floor(start / tile);
+    *last = move > 0 ? (Int32)floor((start + length) / tile) : (Int32)ceil((start + length) / tile) - 1;
+}
+
+Uint8 castBoxThroughTiles(
+    Arena map, TileLayer layer, const SDL_Rect *box, Int32 dx, Int32 dy, double_t *toi, Uint32 *tileIdx
+) {
+    double_t tile = (double_t)TILE_SIZE;
+
+    // Where it starts
+    Int32 minCol, maxCol, minRow, maxRow;
+    getSpanTiles(box->x, box->w, 0, &minCol, &maxCol);
+    getSpanTiles(box->y, box->h, 0, &minRow, &maxRow);
+    if (findLayerTile(map, layer, minCol, maxCol, minRow, maxRow, tileIdx)) {
+        *toi = 0.0;
+        return 1;
+    }
+
+    // The next column and row its leading edges enter, when they do, and how long crossing a tile takes
+    Int32 col = dx > 0 ? maxCol + 1 : minCol - 1;
+    Int32 row = dy > 0 ? maxRow + 1 : minRow - 1;
+    double_t nextX = INFINITY, nextY = INFINITY, stepX = INFINITY, stepY = INFINITY;
+    if (dx) {
+        nextX = (dx > 0 ? col * tile - (box->x + box->w) : (col + 1) * tile - box->x) / dx;
+        stepX = tile / abs(dx);
+    }
+    if (dy) {
+        nextY = (dy > 0 ? row * tile - (box->y + box->h) : (row + 1) * tile - box->y) / dy;
+        stepY = tile / abs(dy);
+    }
+
+    // Only the tiles just entered can stop it, so each step checks one column or one row of the box
+    while (nextX < 1.0 || nextY < 1.0) {
+        Int32 first, last;
+        if (nextX <= nextY) {
+            getSpanTiles(box->y + dy * nextX, box->h, dy, &first, &last);
+            if (findLayerTile(map, layer, col, col, first, last, tileIdx)) {
+                *toi = nextX;
+                return 1;
+            }
+            col += dx > 0 ? 1 : -1;
+            nextX += stepX;
+        } else {
+            getSpanTiles(box->x + dx * nextY, box->w, dx, &first, &last);
+            if (findLayerTile(map, layer, first, last, row, row, tileIdx)) {
+                *toi = nextY;
+                return 1;
+            }
+            row += dy > 0 ? 1 : -1;
+            nextY += stepY;
+        }
+    }
+    return 0;
+}
+
+// =====================================================================================================================
+
+/**
+ * Gets where a fast entity's hitbox was at the start of the tick
+ * @param colComp the entity's collision component, its hitbox stretched over its path
+ * @return SDL_Rect = the hitbox at the start of the tick
+ */
+static SDL_Rect getSweepStart(const CollisionComponent *colComp) {
+    SDL_Rect *hb = colComp->hitbox;
+    return (SDL_Rect){
+        .x = colComp->sweepX < 0 ? hb->x - colComp->sweepX : hb->x,
+        .y = colComp->sweepY < 0 ? hb->y - colComp->sweepY : hb->y,
+        .w = hb->w - abs(colComp->sweepX),
+        .h = hb->h - abs(colComp->sweepY)
+    };
+}
+
+void sweepFastEntity(
+    ZENg zEngine, Entity e, PositionComponent *posComp, VelocityComponent *velComp, CollisionComponent *colComp
+) {
+    CollisionManager cm = zEngine->collisionMng;
+    SDL_Rect *hb = colComp->hitbox;
+    SDL_Rect start = {.x = (int)posComp->x, .y = (int)posComp->y, .w = hb->w, .h = hb->h};
+    Int32 dx = hb->x - start.x, dy = hb->y - start.y;
+
+    double_t toi;
+    Uint32 tileIdx = SWEPT_NO_IMPACT;
+    if (castBoxThroughTiles(zEngine->map, cm->eVsWLayers[colComp->role], &start, dx, dy, &toi, &tileIdx)) {
+        // Stop where it touches the tile
+        dx = (Int32)(dx * toi);
+        dy = (Int32)(dy * toi);
+        hb->x = start.x + dx;
+        hb->y = start.y + dy;
+        velComp->predictedPos.x = hb->x;
+        velComp->predictedPos.y = hb->y;
+        LOG_TRACE(
+            LOG_COLLISIONS, "[WORLD COLLISION SYSTEM] Fast entity %lu stopped by tile %u at %.3f of its path",
+            e, tileIdx, toi
+        );
+    }
+
+    // Stretch the hitbox over the path, the broadphase and the narrowphase pick up what it passed by
+    colComp->sweepX = (Sint16)dx;
+    colComp->sweepY = (Sint16)dy;
+    hb->x = dx < 0 ? hb->x : start.x;
+    hb->y = dy < 0 ? hb->y : start.y;
+    hb->w += abs(dx);
+    hb->h += abs(dy);
+
+    if (cm->sweptCount >= cm->sweptCapacity) {
+        Uint32 newCapacity = cm->sweptCapacity ? cm->sweptCapacity * 2 : 64;
+        SweptEntity *tmp = realloc(cm->swept, newCapacity * sizeof(SweptEntity));
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the swept entities");
+        cm->swept = tmp;
+        cm->sweptCapacity = newCapacity;
+    }
+    cm->swept[cm->sweptCount++] = (SweptEntity){.entity = e, .tileIdx = tileIdx};
+}
+
+// =====================================================================================================================
+
+Uint8 getTimeOfImpact(const CollisionComponent *a, const CollisionComponent *b, double_t *toi) {
+    *toi = 0.0;
+    if (!a->sweepX && !a->sweepY && !b->sweepX && !b->sweepY) return SDL_HasIntersection(a->hitbox, b->hitbox);
+
+    const CollisionComponent *mover = (a->sweepX || a->sweepY) ? a : b;
+    const SDL_Rect *target = mover == a ? b->hitbox : a->hitbox;
+    SDL_Rect start = getSweepStart(mover);
+
+    // Slab test: on each axis the time the boxes start and stop overlapping, they touch while both overlap
+    double_t enter = -INFINITY, exit = INFINITY;
+    const Int32 moves[2] = {mover->sweepX, mover->sweepY};
+    const Int32 starts[2] = {start.x, start.y}, sizes[2] = {start.w, start.h};
+    const Int32 targetStarts[2] = {target->x, target->y}, targetSizes[2] = {target->w, target->h};
+    for (Uint8 axis = 0; axis < 2; axis++) {
+        Int32 lo = targetStarts[axis] - (starts[axis] + sizes[axis]);  // Gap to close before they overlap
+        Int32 hi = targetStarts[axis] + targetSizes[axis] - starts[axis];  // Gap to close before they part again
+        if (!moves[axis]) {
+            if (lo >= 0 || hi <= 0) return 0;  // Apart for the whole tick
+            continue;
+        }
+        double_t t0 = (double_t)lo / moves[axis], t1 = (double_t)hi / moves[axis];
+        if (t0 > t1) {
+            double_t tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+        }
+        if (t0 > enter) enter = t0;
+        if (t1 < exit) exit = t1;
+    }
+    if (enter >= exit || enter >= 1.0 || exit <= 0.0) return 0;
+
+    *toi = enter > 0.0 ? enter : 0.0;
+    return 1;
+}
+
+// =====================================================================================================================
+
+void resolveSweptEntities(ZENg zEngine) {
+    CollisionManager cm = zEngine->collisionMng;
+    ECS ecs = zEngine->ecs;
+
+    for (Uint32 i = 0; i < cm->sweptCount; i++) {
+        Entity e = cm->swept[i].entity;
+        if (!HAS_COMPONENT(ecs, e, COLLISION_COMPONENT)) continue;
+        CollisionComponent *colComp = NULL;
+        GET_COMPONENT(ecs, e, COLLISION_COMPONENT, colComp, CollisionComponent);
+
+        // Back to where it ended the tick
+        SDL_Rect *hb = colComp->hitbox;
+        if (colComp->sweepX > 0) hb->x += colComp->sweepX;
+        if (colComp->sweepY > 0) hb->y += colComp->sweepY;
+        hb->w -= abs(colComp->sweepX);
+        hb->h -= abs(colComp->sweepY);
+        colComp->sweepX = colComp->sweepY = 0;
+
+        // Nothing it hit on its way stopped it before the tile
+        Uint32 tileIdx = cm->swept[i].tileIdx;
+        if (tileIdx == SWEPT_NO_IMPACT || !isAlive(ecs, e) || !cm->eVsWHandlers[colComp->role]) continue;
+        Tile *tile = &zEngine->map->tiles[tileIdx / ARENA_WIDTH][tileIdx % ARENA_WIDTH];
+        cm->eVsWHandlers[colComp->role](zEngine, e, tile);
+    }
+    cm->sweptCount = 0;
+}
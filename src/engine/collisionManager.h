@@ -2,6 +2,7 @@
 #define COLLISION_MANAGER_H
 
 #include "engine/core/ecs.h"
+#include "engine/core/jobSystem.h"
 
 // Collisions are a bit special so treat them in their own context
 
@@ -11,20 +12,91 @@ typedef struct {
     size_t capacity;  // Capacity of the entities array
 } GridCell;
 
+typedef enum {
+    BROADPHASE_INCREMENTAL,  // Every cell owns an array, entities are moved between cells as they move
+    BROADPHASE_REBUILD,  // The flat grid is rebuilt from scratch every tick with a counting sort
+    BROADPHASE_SWEEP,  // Sort and sweep on the X axis, doesn't depend on the tiles at all
+    BROADPHASE_COUNT  // Automatically counts
+} BroadphaseMode;
+
+#define DEFAULT_BROADPHASE BROADPHASE_REBUILD
+#define FLAT_GRID_MIN_CHUNK 256  // Fewest entities a worker takes on while rebuilding the flat grid
+#define SWEEP_MAX_SHIFTS 8  // Average slots an entry may move before the sweep re-sorts its list from scratch
+
+// Compressed sparse rows: the entities of every cell lie next to each other in one array, no per cell allocation
+typedef struct {
+    Uint32 *cellStart;  // Cell c holds entities[cellStart[c]] up to entities[cellStart[c + 1]], one more than the cells
+    Entity *entities;  // Entities ordered by cell, an entity appears once per cell it covers
+    Uint32 capacity;  // Capacity of the entities array
+    Uint32 *chunkCounts;  // One histogram of the cells per chunk of entities, turned into write cursors
+    Uint32 chunkCapacity;  // Number of histograms chunkCounts has room for
+} FlatGrid;
+
+typedef struct {
+    Entity entity;
+    CollisionComponent *colComp;  // The entity's collision component, refreshed every sweep
+    Int32 minX;  // Left edge of the hitbox, the list is sorted on it
+    Int32 maxX;  // Right edge of the hitbox
+    Int32 minY;  // Top edge of the hitbox
+    Int32 maxY;  // Bottom edge of the hitbox
+    Uint8 role;  // CollisionRole, copied so the sweep never leaves the list
+} SweepEntry;
+
+// Kept sorted from one tick to the next, the entities barely move in between so re-sorting it is close to linear
+typedef struct {
+    SweepEntry *entries;  // Sorted by minX as of the last sweep, the entities registered since are appended
+    Uint32 count;  // Number of entries
+    Uint32 capacity;  // Capacity of the entries array
+} SweepList;
+
+typedef struct {
+    Entity a;  // The entity with the lower role, handlers expect them in that order
+    Entity b;
+    double_t toi;  // Fraction of the tick at which they first touch, always 0 unless one of them is fast
+} CollisionPair;
+
+#define SWEPT_NO_IMPACT UINT32_MAX  // SweptEntity.tileIdx of a fast entity that didn't run into a tile
+
+typedef struct {
+    Entity entity;  // A fast entity, its hitbox is stretched over its path until the entity collisions are done
+    Uint32 tileIdx;  // Index of the solid tile it was stopped by, SWEPT_NO_IMPACT if none
+} SweptEntity;
+
+typedef struct {
+    Entity entity;
+    CollisionComponent *colComp;  // The entity's collision component, looked up once per cell
+    Uint16 minX;  // Left column of the entity's coverage
+    Uint16 minY;  // Top row of the entity's coverage
+} PairCandidate;
+
 // Handler function types
 typedef void (*entityVsEntityHandler)(ZENg zEngine, Entity a, Entity b);
 typedef void (*entityVsWorldHandler)(ZENg zEngine, Entity entity, Tile *tile);
 
 typedef struct colmng {
-    GridCell *spatialGrid;  // Flattened 2D array representing the spatial grid
+    GridCell *spatialGrid;  // Flattened 2D array representing the spatial grid, used by BROADPHASE_INCREMENTAL
+    FlatGrid flatGrid;  // Used by BROADPHASE_REBUILD
+    SweepList sweepList;  // Used by BROADPHASE_SWEEP
+    BroadphaseMode broadphase;  // How the entity collision pairs are found
+    CollisionPair *pairs;  // This tick's candidate pairs, each one listed once
+    Uint32 pairCount;  // Number of pairs in the array
+    Uint32 pairCapacity;  // Capacity of the pairs array
+    PairCandidate *candidates;  // Live colliders of the cell being paired
+    Uint32 candidateCapacity;  // Capacity of the candidates array
+    SweptEntity *swept;  // The fast entities swept by this tick's world collisions
+    Uint32 sweptCount;  // Number of swept entities
+    Uint32 sweptCapacity;  // Capacity of the swept array
     entityVsEntityHandler eVsEHandlers[COL_ROLE_COUNT][COL_ROLE_COUNT];
     entityVsWorldHandler eVsWHandlers[COL_ROLE_COUNT];
+    TileLayer eVsWLayers[COL_ROLE_COUNT];  // The tiles each role's world handler is called for
 } *CollisionManager;
 
 // Macro to get the index of a cell in the spatial grid
 #define COL_GRID_INDEX(cm, x, y) \
     ((y) * ARENA_WIDTH + (x))
 
+extern const char *const broadphaseNames[BROADPHASE_COUNT];
+
 /**
  * Initializes the collision manager
  * @return CollisionManager
@@ -45,9 +117,10 @@ void registerEVsEHandler(CollisionManager cm, CollisionRole roleA, CollisionRole
  * Registers an Entity vs World collision handler to the collision manager's handlers table  
  * @param colMng pointer to the collision manager
  * @param role enum type, role of the entity
+ * @param layer the tiles the handler is called for, the entity passes over the rest
  * @param handler function pointer, the handler in question
  */
-void registerEVsWHandler(CollisionManager cm, CollisionRole role, entityVsWorldHandler handler);
+void registerEVsWHandler(CollisionManager cm, CollisionRole role, TileLayer layer, entityVsWorldHandler handler);
 
 /**
  * Normalizes two entities and their collision components so that entity A has a smaller role
@@ -94,6 +167,13 @@ void populateHandlersTables(CollisionManager cm);
  */
 void registerEntityToSG(CollisionManager cm, Entity e, CollisionComponent *colComp);
 
+/**
+ * Appends an entity to the sweep list, unsorted
+ * @param list the sweep list
+ * @param e the entity, sorted into place by the next sweep
+ */
+void appendSweepEntry(SweepList *list, Entity e);
+
 /**
  * Inserts an entity to the spatial grid cell
  * @param e the entity to insert
@@ -111,11 +191,111 @@ void removeEntityFromSGCell(Entity e, GridCell *cell);
 /**
  * Inserts the entity in the newly occupied cells and deletes it from the no longer occupied ones
  * @param cm the collision manager
- * @param velComp the entity's velocity component to get current frame position (after world collisions)
- * @param colComp the entity's collision component
+ * @param e the entity
+ * @param colComp the entity's collision component, its hitbox has to be resolved against the world already
+ * @note a fast entity is inserted in every cell its stretched hitbox covers
+ */
+void updateGridMembership(CollisionManager cm, Entity e, CollisionComponent *colComp);
+
+/**
+ * Rebuilds the flat grid from the collision components' hitboxes
+ * @param cm the collision manager
+ * @param ecs the ECS
+ * @param jobs the job system the counting and the scattering are split across
+ * @note every worker counts its chunk into its own histogram, so the result is the same as a serial stable sort
+ */
+void rebuildFlatGrid(CollisionManager cm, ECS ecs, JobSystem jobs);
+
+/**
+ * Looks up the entities registered in a cell of the current broadphase's grid
+ * @param cm the collision manager
+ * @param cellIdx index of the cell, see COL_GRID_INDEX
+ * @param entities where the pointer to the cell's first entity goes
+ * @return size_t = number of entities in the cell
+ * @note the incremental grid may still hold dead entities, the sweep has no cells and always returns 0
+ */
+size_t getSGCellEntities(CollisionManager cm, size_t cellIdx, Entity **entities);
+
+/**
+ * Lists every pair of entities close enough to collide, once, in the collision manager's pairs array
+ * @param cm the collision manager
+ * @param ecs the ECS
+ * @note on the grids a pair is only listed from the top left cell of the overlap of its entities' coverages,
+ * the sweep lists the pairs whose hitboxes overlap on both axes. Either way only roles with a handler are listed
+ */
+void findCollisionPairs(CollisionManager cm, ECS ecs);
+
+/**
+ * Looks up a broadphase by name, as written in the arena files
+ * @param name "INCREMENTAL", "REBUILD" or "SWEEP"
+ * @return BroadphaseMode = the broadphase, BROADPHASE_COUNT if the name is unknown
+ */
+BroadphaseMode getBroadphaseFromName(const char *name);
+
+/**
+ * Switches the broadphase, the grid or list it switches to is filled from the current hitboxes
+ * @param cm the collision manager
+ * @param ecs the ECS
+ * @param jobs the job system, for the flat grid
+ * @param mode the new broadphase
+ */
+void setBroadphaseMode(CollisionManager cm, ECS ecs, JobSystem jobs, BroadphaseMode mode);
+
+/**
+ * Empties the current broadphase's grid or list and fills it again from the current hitboxes
+ * @param cm the collision manager
+ * @param ecs the ECS
+ * @param jobs the job system, for the flat grid
+ * @note the entities go in in dense order, which may not be the order they were in before
+ */
+void refillBroadphase(CollisionManager cm, ECS ecs, JobSystem jobs);
+
+/**
+ * Casts a box through the arena's tiles, column by column and row by row as its leading edges cross them (DDA)
+ * @param map the arena
+ * @param layer the tiles that stop it
+ * @param box the box where it starts
+ * @param dx how far it moves on X
+ * @param dy how far it moves on Y
+ * @param toi where the fraction of the move at which it first touches one of those tiles goes
+ * @param tileIdx where the index of that tile goes
+ * @return Uint8 = 1 if it touches one of those tiles before the end of the move, 0 otherwise
+ * @note a box starting inside one of those tiles touches it at 0
+ */
+Uint8 castBoxThroughTiles(
+    Arena map, TileLayer layer, const SDL_Rect *box, Int32 dx, Int32 dy, double_t *toi, Uint32 *tileIdx
+);
+
+/**
+ * Sweeps a fast entity from where it started the tick to its predicted position, so it can't tunnel through
+ * thin walls or small hitboxes. It stops on the first solid tile in its way, and its hitbox is stretched over
+ * the path it took until resolveSweptEntities
+ * @param zEngine the engine
+ * @param e the fast entity
+ * @param posComp its position at the start of the tick
+ * @param velComp its velocity component, the predicted position is pulled back if a tile stops it
+ * @param colComp its collision component
+ * @note the tile's handler only runs in resolveSweptEntities, after anything the entity hit earlier on its way
+ */
+void sweepFastEntity(
+    ZENg zEngine, Entity e, PositionComponent *posComp, VelocityComponent *velComp, CollisionComponent *colComp
+);
+
+/**
+ * Checks two entities' hitboxes against each other, a fast one is swept from where it started the tick
+ * @param a an entity's collision component
+ * @param b the other entity's collision component
+ * @param toi where the fraction of the tick at which they first touch goes
+ * @return Uint8 = 1 if they touch during the tick, 0 otherwise
+ * @note the other entity is taken as still, even if it is fast too
+ */
+Uint8 getTimeOfImpact(const CollisionComponent *a, const CollisionComponent *b, double_t *toi);
+
+/**
+ * Runs the world handlers of the fast entities still alive that ran into a tile, then shrinks their hitboxes back
+ * @param zEngine the engine
  */
-void updateGridMembership(
-    CollisionManager cm, Entity e, VelocityComponent *velComp, CollisionComponent *colComp);
+void resolveSweptEntities(ZENg zEngine);
 
 /**
  * Frees the memory allocated for the collision manager
@@ -3,6 +3,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+// Read-only page every sparse page without components points to, so untouched pages cost no memory
+static const Uint64 zeroPage[PAGE_SIZE];
+#define ZERO_PAGE ((Uint64 *)zeroPage)
+
 void initECS(ECS *ecs) {
     (*ecs) = malloc(sizeof(struct EeSiEs));
     if (!(*ecs)) {
@@ -42,6 +46,9 @@ void initECS(ECS *ecs) {
         free(*ecs);
         exit(EXIT_FAILURE);
     }
+    (*ecs)->generations = malloc((*ecs)->capacity * sizeof(Uint32));
+    if (!(*ecs)->generations) THROW_ERROR_AND_EXIT("Failed to allocate memory for ECS entity generations");
+    for (Uint64 i = 0; i < (*ecs)->capacity; i++) (*ecs)->generations[i] = ENTITY_FIRST_GENERATION;
     (*ecs)->components = calloc(COMPONENT_TYPE_COUNT, sizeof(ComponentTypeSet));
     if (!(*ecs)->components) {
         fprintf(stderr, "Failed to allocate memory for ECS components\n");
@@ -53,123 +60,279 @@ void initECS(ECS *ecs) {
     for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++)
         (*ecs)->components[i].type = i;
 
+    // Components are stored by value, so every type needs its size known up front
+    const size_t componentSizes[COMPONENT_TYPE_COUNT] = {
+        [HEALTH_COMPONENT] = sizeof(HealthComponent),
+        [POSITION_COMPONENT] = sizeof(PositionComponent),
+        [VELOCITY_COMPONENT] = sizeof(VelocityComponent),
+        [DIRECTION_COMPONENT] = sizeof(DirectionComponent),
+        [WEAPON_COMPONENT] = sizeof(WeaponComponent),
+        [LOADOUT_COMPONENT] = sizeof(LoadoutComponent),
+        [PROJECTILE_COMPONENT] = sizeof(ProjectileComponent),
+        [LIFETIME_COMPONENT] = sizeof(LifetimeComponent),
+        [COLLISION_COMPONENT] = sizeof(CollisionComponent),
+        [STATE_TAG_COMPONENT] = sizeof(StateTagComponent),
+        [RENDER_COMPONENT] = sizeof(RenderComponent)
+    };
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++)
+        registerComponentType(*ecs, i, componentSizes[i]);
+
+    // The data components own outside of their dense slots comes from per-type slab pools
+    const size_t ownedDataSizes[COMPONENT_TYPE_COUNT] = {
+        [COLLISION_COMPONENT] = sizeof(SDL_Rect),  // Hitbox
+        [RENDER_COMPONENT] = sizeof(SDL_Rect)  // Destination rectangle
+    };
+    memset((*ecs)->pools, 0, sizeof((*ecs)->pools));
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+        if (ownedDataSizes[i] > 0) initSlabPool(&(*ecs)->pools[i], ownedDataSizes[i]);
+    }
+
+    // The movement, collision and transform loops walk these arrays in lockstep
+    memset((*ecs)->groups, 0, sizeof((*ecs)->groups));
+    memset(&(*ecs)->commands, 0, sizeof((*ecs)->commands));
+    registerGroup(
+        *ecs, GROUP_MOVEMENT,
+        COMPONENT_MASK(POSITION_COMPONENT) | COMPONENT_MASK(VELOCITY_COMPONENT)
+        | COMPONENT_MASK(COLLISION_COMPONENT) | COMPONENT_MASK(RENDER_COMPONENT)
+    );
+
     (*ecs)->depGraph = initDependencyGraph();
     kahnTopSort((*ecs)->depGraph);
 }
 
+/**
+ * =====================================================================================================================
+ */
+
+void registerComponentType(ECS ecs, ComponentType type, size_t elemSize) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot register component type");
+    if (type >= COMPONENT_TYPE_COUNT) THROW_ERROR_AND_RETURN_VOID("Invalid component type in registerComponentType");
+    if (elemSize == 0) THROW_ERROR_AND_RETURN_VOID("Component types cannot have a size of 0");
+    if (ecs->components[type].denseSize > 0) THROW_ERROR_AND_RETURN_VOID(
+        "Cannot change the size of a component type which already has components"
+    );
+
+    ecs->components[type].elemSize = elemSize;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+/**
+ * Swaps two components of a set, keeping the sparse and reverse mappings valid
+ * @param set pointer to the component set
+ * @param a dense index of the first component
+ * @param b dense index of the second component
+ */
+static void swapDenseSlots(ComponentTypeSet *set, Uint64 a, Uint64 b) {
+    if (a == b) return;
+
+    Uint8 *first = DENSE_AT(set, a);
+    Uint8 *second = DENSE_AT(set, b);
+    for (size_t i = 0; i < set->elemSize; i++) {
+        Uint8 tmp = first[i];
+        first[i] = second[i];
+        second[i] = tmp;
+    }
+
+    Entity entityA = set->denseToEntity[a];
+    Entity entityB = set->denseToEntity[b];
+    set->denseToEntity[a] = entityB;
+    set->denseToEntity[b] = entityA;
+    set->sparse[ENTITY_INDEX(entityA) / PAGE_SIZE][ENTITY_INDEX(entityA) % PAGE_SIZE] = b;
+    set->sparse[ENTITY_INDEX(entityB) / PAGE_SIZE][ENTITY_INDEX(entityB) % PAGE_SIZE] = a;
+}
+
+/**
+ * Moves an entity at the end of a group if it now owns all of the group's types
+ * @param ecs an ECS struct = struct ecs*
+ * @param group pointer to the group
+ * @param id the entity ID
+ */
+static void groupTryAdd(ECS ecs, ComponentGroup *group, Entity id) {
+    if ((ecs->componentsFlags[ENTITY_INDEX(id)] & group->owned) != group->owned) return;
+
+    Uint64 page = ENTITY_INDEX(id) / PAGE_SIZE;
+    Uint64 offset = ENTITY_INDEX(id) % PAGE_SIZE;
+    if (ecs->components[group->lead].sparse[page][offset] < group->size) return;  // Already a member
+
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+        if (!(group->owned & COMPONENT_MASK(i))) continue;
+        swapDenseSlots(&ecs->components[i], ecs->components[i].sparse[page][offset], group->size);
+    }
+    group->size++;
+}
+
+/**
+ * Moves a member entity right after the end of a group, so the group stays packed once it's gone
+ * @param ecs an ECS struct = struct ecs*
+ * @param group pointer to the group
+ * @param id the entity ID
+ */
+static void groupRemove(ECS ecs, ComponentGroup *group, Entity id) {
+    if (group->owned == 0) return;  // Group not registered
+    if ((ecs->componentsFlags[ENTITY_INDEX(id)] & group->owned) != group->owned) return;
+
+    Uint64 page = ENTITY_INDEX(id) / PAGE_SIZE;
+    Uint64 offset = ENTITY_INDEX(id) % PAGE_SIZE;
+    if (ecs->components[group->lead].sparse[page][offset] >= group->size) return;  // Not a member
+
+    group->size--;
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+        if (!(group->owned & COMPONENT_MASK(i))) continue;
+        swapDenseSlots(&ecs->components[i], ecs->components[i].sparse[page][offset], group->size);
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void registerGroup(ECS ecs, GroupType group, bitset owned) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot register group");
+    if (group >= GROUP_COUNT) THROW_ERROR_AND_RETURN_VOID("Invalid group in registerGroup");
+    if (owned == 0 || owned >= COMPONENT_MASK(COMPONENT_TYPE_COUNT))
+        THROW_ERROR_AND_RETURN_VOID("Invalid component mask in registerGroup");
+    if (ecs->groups[group].owned != 0) THROW_ERROR_AND_RETURN_VOID("Group already registered");
+
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+        if ((owned & COMPONENT_MASK(i)) && ecs->components[i].group)
+            THROW_ERROR_AND_RETURN_VOID("A component type can be owned by a single group");
+    }
+
+    ComponentGroup *grp = &ecs->groups[group];
+    grp->owned = owned;
+    grp->size = 0;
+    for (Uint64 i = COMPONENT_TYPE_COUNT; i-- > 0;) {
+        if (!(owned & COMPONENT_MASK(i))) continue;
+        ecs->components[i].group = grp;
+        grp->lead = i;
+    }
+
+    // Pack the entities which already qualify
+    ComponentTypeSet *lead = &ecs->components[grp->lead];
+    for (Uint64 i = 0; i < lead->denseSize; i++) {
+        groupTryAdd(ecs, grp, lead->denseToEntity[i]);
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+/**
+ * Grows the per-entity arrays of the ECS
+ * @param ecs an ECS struct = struct ecs*
+ * @param newCapacity number of entity indices the arrays need to hold
+ */
+static void growEntityArrays(ECS ecs, Uint64 newCapacity) {
+    Uint64 oldCapacity = ecs->capacity;
+    if (newCapacity <= oldCapacity) return;
+
+    LOG_DEBUG(LOG_ECS, "Resizing ECS from %lu to %lu", oldCapacity, newCapacity);
+
+    Entity *tmpActive = realloc(ecs->activeEntities, newCapacity * sizeof(Entity));
+    if (!tmpActive) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS active entities");
+    ecs->activeEntities = tmpActive;
+
+    bitset *tmpFlags = realloc(ecs->componentsFlags, newCapacity * sizeof(bitset));
+    if (!tmpFlags) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS components flags");
+    ecs->componentsFlags = tmpFlags;
+
+    Uint64 *tmpEntityToActive = realloc(ecs->entityToActiveIndex, newCapacity * sizeof(Uint64));
+    if (!tmpEntityToActive) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS entity->active array map");
+    ecs->entityToActiveIndex = tmpEntityToActive;
+
+    // Every index can end up in the free entities array
+    if (ecs->freeEntityCapacity < newCapacity) {
+        Entity *tmpFreeEntities = realloc(ecs->freeEntities, newCapacity * sizeof(Entity));
+        if (!tmpFreeEntities) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS free entities");
+        ecs->freeEntities = tmpFreeEntities;
+        ecs->freeEntityCapacity = newCapacity;
+    }
+
+    Uint32 *tmpGenerations = realloc(ecs->generations, newCapacity * sizeof(Uint32));
+    if (!tmpGenerations) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS entity generations");
+    ecs->generations = tmpGenerations;
+
+    // initalize the new flags to 0 and the generations to the first one issued
+    for (Uint64 i = oldCapacity; i < newCapacity; i++) {
+        ecs->componentsFlags[i] = 0;
+        ecs->generations[i] = ENTITY_FIRST_GENERATION;
+    }
+    ecs->capacity = newCapacity;
+}
+
+/**
+ * Grows the dense arrays of a component type, independently of the other types
+ * @param set pointer to the ComponentTypeSet
+ * @param newCapacity number of components the dense arrays need to hold
+ */
+static void growDenseSet(ComponentTypeSet *set, Uint64 newCapacity) {
+    if (newCapacity <= set->denseCapacity) return;
+
+    LOG_DEBUG(
+        LOG_ECS, "Resizing the dense array of the component %d from %lu to %lu",
+        set->type, set->denseCapacity, newCapacity
+    );
+
+    void *tmpDense = realloc(set->dense, newCapacity * set->elemSize);
+    if (!tmpDense) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS dense set");
+    set->dense = tmpDense;
+
+    Entity *tmpDenseToEntity = realloc(set->denseToEntity, newCapacity * sizeof(Entity));
+    if (!tmpDenseToEntity) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS dense set");
+    set->denseToEntity = tmpDenseToEntity;
+
+    set->denseCapacity = newCapacity;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void ecsReserve(ECS ecs, Uint64 entities) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL in ecsReserve");
+    growEntityArrays(ecs, entities);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void ecsReserveComponent(ECS ecs, ComponentType compType, Uint64 count) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL in ecsReserveComponent");
+    if (compType >= COMPONENT_TYPE_COUNT) THROW_ERROR_AND_RETURN_VOID("Invalid component type in ecsReserveComponent");
+    growDenseSet(&ecs->components[compType], count);
+}
+
 /**
  * =====================================================================================================================
  */
 
 Entity createEntity(ECS ecs, StateTagComponent state) {
-    Entity entitty;
+    Uint64 index;
     if (ecs->freeEntityCount > 0) {
-        // reuse an ID from the free entities array
-        entitty = ecs->freeEntities[--ecs->freeEntityCount];
+        // reuse an index from the free entities array, its generation was bumped when it got freed
+        index = ecs->freeEntities[--ecs->freeEntityCount];
     } else {
         // no free entities, create a new one
-        if (ecs->entityCount >= ecs->capacity) {
-            // resize the ECS if needed
-            Uint64 oldCapacity = ecs->capacity;
-            ecs->capacity *= 2;
-
-            #ifdef DEBUG
-                printf("Resizing ECS from %lu to %lu\n", oldCapacity, ecs->capacity);
-            #endif
-
-            Entity *tmpActive = realloc(ecs->activeEntities, ecs->capacity * sizeof(Entity));
-            if (!tmpActive) {
-                fprintf(stderr, "Failed to reallocate memory for ECS active entities\n");
-                free(ecs->activeEntities);
-                free(ecs->componentsFlags);
-                free(ecs->components);
-                free(ecs);
-                exit(EXIT_FAILURE);
-            }
-            ecs->activeEntities = tmpActive;
-
-            bitset *tmpFlags = realloc(ecs->componentsFlags, ecs->capacity * sizeof(bitset));
-            if (!tmpFlags) {
-                fprintf(stderr, "Failed to reallocate memory for ECS components flags\n");
-                free(ecs->componentsFlags);
-                free(ecs->components);
-                free(ecs);
-                exit(EXIT_FAILURE);
-            }
-            ecs->componentsFlags = tmpFlags;
-
-            Uint64 *tmpEntityToActive = realloc(ecs->entityToActiveIndex, ecs->capacity * sizeof(Uint64));
-            if (!tmpEntityToActive) {
-                fprintf(stderr, "Failed to reallocate memory for ECS entity->active array map\n");
-                free(ecs->activeEntities);
-                free(ecs->componentsFlags);
-                free(ecs->components);
-                free(ecs->entityToActiveIndex);
-                free(ecs);
-                exit(EXIT_FAILURE);
-            }
-            ecs->entityToActiveIndex = tmpEntityToActive;
-
-            // Resize the freeEntities array to match the new capacity
-            Entity *tmpFreeEntities = realloc(ecs->freeEntities, ecs->capacity * sizeof(Entity));
-            if (!tmpFreeEntities) {
-                fprintf(stderr, "Failed to reallocate memory for ECS free entities\n");
-                free(ecs->activeEntities);
-                free(ecs->componentsFlags);
-                free(ecs->components);
-                free(ecs->entityToActiveIndex);
-                free(ecs->freeEntities);
-                free(ecs);
-                exit(EXIT_FAILURE);
-            }
-            ecs->freeEntities = tmpFreeEntities;
-            ecs->freeEntityCapacity = ecs->capacity;
-
-            // initalize the new flags to 0
-            for (Uint64 i = oldCapacity; i < ecs->capacity; i++) {
-                ecs->componentsFlags[i] = 00000000;
-            }
-
-            // resize the components arrays - only dense part
-            for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
-                if (ecs->components[i].dense) {
-                    void **tmpDense = realloc(ecs->components[i].dense, ecs->capacity * sizeof(void *));
-                    Entity *tmpDenseToEntity = realloc(ecs->components[i].denseToEntity, ecs->capacity * sizeof(Entity));
-                    if (!tmpDense || !tmpDenseToEntity) {
-                        fprintf(stderr, "Failed to reallocate memory for component %lu dense arrays\n", i);
-                        exit(EXIT_FAILURE);
-                    }
-                    ecs->components[i].dense = tmpDense;
-                    ecs->components[i].denseToEntity = tmpDenseToEntity;
-                }
-            }
-        }
-        entitty = ecs->nextEntityID++;
+        // resize the ECS if needed, the component sets grow on their own
+        if (ecs->entityCount >= ecs->capacity) growEntityArrays(ecs, ecs->capacity * 2);
+        index = ecs->nextEntityID++;
     }
+    Entity entitty = MAKE_ENTITY(index, ecs->generations[index]);
 
-    ecs->componentsFlags[entitty] = 0;  // the new entity has no components
+    ecs->componentsFlags[index] = 0;  // the new entity has no components
     ecs->activeEntities[ecs->entityCount++] = entitty;  // add it to the active entities array
     // Create the mapping for later removal
-    ecs->entityToActiveIndex[entitty] = ecs->entityCount - 1;
+    ecs->entityToActiveIndex[index] = ecs->entityCount - 1;
 
     // Add the state tag component
-    StateTagComponent *stateTag = calloc(1, sizeof(StateTagComponent));
-    if (!stateTag) {
-        printf("Failed allocating memory for the state tag of entity %lu\n", entitty);
-        exit(EXIT_FAILURE);
-    }
-
-    *stateTag = state; 
-    addComponent(ecs, entitty, STATE_TAG_COMPONENT, (void*)stateTag);
+    addComponent(ecs, entitty, STATE_TAG_COMPONENT, &state);
 
-    ActiveTagComponent *activeTag = calloc(1, sizeof(ActiveTagComponent));
-    if (!activeTag) THROW_ERROR_AND_EXIT("Failed allocating memory for the active tag of an entity");
-    *activeTag = 1;
-    addComponent(ecs, entitty, ACTIVE_TAG_COMPONENT, activeTag);
-
-    #ifdef DEBUG
-        printf("Created entity %lu belonging to state %d\n", entitty, *stateTag);
-    #endif
+    LOG_TRACE(LOG_ECS, "Created entity %lu belonging to state %d", entitty, state);
 
     return entitty;
 }
@@ -178,28 +341,16 @@ Entity createEntity(ECS ecs, StateTagComponent state) {
  * =====================================================================================================================
  */
 
-DirectionComponent* createDirectionComponent(DirectionComponent dir) {
-    DirectionComponent *comp = calloc(1, sizeof(DirectionComponent));
-    if (!comp) {
-        printf("Failed to allocate memory for direction component\n");
-        exit(EXIT_FAILURE);
-    }
-    *comp = dir;
-    return comp;
+DirectionComponent createDirectionComponent(DirectionComponent dir) {
+    return dir;
 }
 
 /**
  * =====================================================================================================================
  */
 
-PositionComponent* createPositionComponent(PositionComponent pos) {
-    PositionComponent *comp = calloc(1, sizeof(PositionComponent));
-    if (!comp) {
-        printf("Failed to allocate memory for position component\n");
-        exit(EXIT_FAILURE);
-    }
-    *comp = pos;
-    return comp;
+PositionComponent createPositionComponent(PositionComponent pos) {
+    return pos;
 }
 
 
@@ -207,57 +358,46 @@ PositionComponent* createPositionComponent(PositionComponent pos) {
  * =====================================================================================================================
  */
 
-VelocityComponent* createVelocityComponent(Vec2 velocity, double_t maxVelocity, PositionComponent predictedPos, Axis lastAxis, Uint8 active) {
-    VelocityComponent *comp = calloc(1, sizeof(VelocityComponent));
-    if (!comp) {
-        printf("Failed to allocate memory for velocity component\n");
-        exit(EXIT_FAILURE);
-    }
-    comp->currVelocity = velocity;
-    comp->maxVelocity = maxVelocity;
-    comp->predictedPos = predictedPos;
-    comp->prevAxis = lastAxis;
-    comp->active = active;
-    return comp;
+VelocityComponent createVelocityComponent(Vec2 velocity, double_t maxVelocity, PositionComponent predictedPos, Axis lastAxis, Uint8 active) {
+    return (VelocityComponent) {
+        .currVelocity = velocity,
+        .maxVelocity = maxVelocity,
+        .predictedPos = predictedPos,
+        .prevPos = predictedPos,  // A new entity is drawn where it spawns, not slid in from elsewhere
+        .prevAxis = lastAxis,
+        .active = active
+    };
 }
 
 /**
  * =====================================================================================================================
  */
 
-HealthComponent* createHealthComponent(Int32 maxHealth, Int32 currentHealth, Uint8 active) {
-    HealthComponent *comp = calloc(1, sizeof(HealthComponent));
-    if (!comp) {
-        printf("Failed to allocate memory for health component\n");
-        exit(EXIT_FAILURE);
-    }
-    comp->maxHealth = maxHealth;
-    comp->currentHealth = currentHealth;
-    comp->active = active;
-    return comp;
+HealthComponent createHealthComponent(Int32 maxHealth, Int32 currentHealth, Uint8 active) {
+    return (HealthComponent) {
+        .maxHealth = maxHealth,
+        .currentHealth = currentHealth,
+        .active = active
+    };
 }
 
 /**
  * =====================================================================================================================
  */
 
-CollisionComponent* createCollisionComponent(int x, int y, int w, int h, Uint8 isSolid, CollisionRole role) {
-    CollisionComponent *comp = calloc(1, sizeof(CollisionComponent));
-    if (!comp) {
-        printf("Failed to allocate memory for collision component\n");
-        exit(EXIT_FAILURE);
-    }
-    comp->hitbox = calloc(1, sizeof(SDL_Rect));
-    if (!comp->hitbox) {
+CollisionComponent createCollisionComponent(ECS ecs, int x, int y, int w, int h, Uint8 isSolid, CollisionRole role) {
+    CollisionComponent comp = {0};
+    comp.hitbox = slabAlloc(&ecs->pools[COLLISION_COMPONENT]);
+    if (!comp.hitbox) {
         printf("Failed to allocate memory for collision hitbox\n");
         exit(EXIT_FAILURE);
     }
-    comp->hitbox->x = x;
-    comp->hitbox->y = y;
-    comp->hitbox->w = w;
-    comp->hitbox->h = h;
-    comp->isSolid = isSolid;
-    comp->role = role;
+    comp.hitbox->x = x;
+    comp.hitbox->y = y;
+    comp.hitbox->w = w;
+    comp.hitbox->h = h;
+    comp.isSolid = isSolid;
+    comp.role = role;
     return comp;
 }
 
@@ -265,22 +405,18 @@ CollisionComponent* createCollisionComponent(int x, int y, int w, int h, Uint8 i
  * =====================================================================================================================
  */
 
-RenderComponent* createRenderComponent(SDL_Texture *texture, int x, int y, int w, int h, Uint8 active) {
-    RenderComponent *comp = calloc(1, sizeof(RenderComponent));
-    if (!comp) {
-        printf("Failed to allocate memory for render component\n");
-        exit(EXIT_FAILURE);
-    }
-    comp->texture = texture;
-    comp->active = active;
+RenderComponent createRenderComponent(ECS ecs, SDL_Texture *texture, int x, int y, int w, int h, Uint8 active) {
+    RenderComponent comp = {0};
+    comp.texture = texture;
+    comp.active = active;
 
-    comp->destRect = calloc(1, sizeof(SDL_Rect));
-    if (!comp->destRect) {
+    comp.destRect = slabAlloc(&ecs->pools[RENDER_COMPONENT]);
+    if (!comp.destRect) {
         printf("Failed to allocate memory for render destination rectangle\n");
         exit(EXIT_FAILURE);
     }
 
-    *comp->destRect = (SDL_Rect) {
+    *comp.destRect = (SDL_Rect) {
         .x = x,
         .y = y,
         .w = w,
@@ -294,128 +430,219 @@ RenderComponent* createRenderComponent(SDL_Texture *texture, int x, int y, int w
  * =====================================================================================================================
  */
 
-LoadoutComponent *createLoadoutComponent(Entity primaryGun, CDLLNode *currSecondaryGun, Entity hull, Entity module) {
-    LoadoutComponent *comp = calloc(1, sizeof(LoadoutComponent));
-    if (!comp) {
-        printf("Failed to allocate memory for loadout component\n");
-        exit(EXIT_FAILURE);
-    }
-    comp->primaryGun = primaryGun;
-    comp->currSecondaryGun = currSecondaryGun;
-    comp->hull = hull;
-    comp->module = module;
-    return comp;
+LoadoutComponent createLoadoutComponent(Entity primaryGun, CDLLNode *currSecondaryGun, Entity hull, Entity module) {
+    return (LoadoutComponent) {
+        .primaryGun = primaryGun,
+        .currSecondaryGun = currSecondaryGun,
+        .hull = hull,
+        .module = module
+    };
 }
 
 /**
  * =====================================================================================================================
  */
 
-ProjectileComponent *createProjectileComponent(Int32 dmg, Uint8 piercing, Uint8 exploding, Uint8 friendly) {
-    ProjectileComponent *comp = calloc(1, sizeof(ProjectileComponent));
-    if (!comp) {
-        printf("Failed to allocate memory for projectile component\n");
-        exit(EXIT_FAILURE);
-    }
-    comp->dmg = dmg;
-    comp->piercing = piercing;
-    comp->exploding = exploding;
-    comp->friendly = friendly;
-    return comp;
+ProjectileComponent createProjectileComponent(Int32 dmg, Uint8 piercing, Uint8 exploding, Uint8 friendly) {
+    return (ProjectileComponent) {
+        .dmg = dmg,
+        .piercing = piercing,
+        .exploding = exploding,
+        .friendly = friendly
+    };
 }
 
 /**
  * =====================================================================================================================
  */
 
-void addComponent(ECS ecs, Entity id, ComponentType compType, void *component) {
-    Uint64 page = id / PAGE_SIZE;  // determine the page for the entity
-    Uint64 index = id % PAGE_SIZE;  // determine the index within the page
-
-    if (compType >= COMPONENT_TYPE_COUNT) {
-        fprintf(stderr, "Invalid component type %d\n", compType);
-        return;
+/**
+ * Appends a component at the end of its type's dense array and sets the entity's bit
+ * @param ecs an ECS struct = struct ecs*
+ * @param id the owner entity ID, alive and without a component of this type
+ * @param compType component type = enum variable
+ * @param component the component, copied into the dense slot
+ * @return pointer to the stored component
+ * @note the groups and the dirty lists are left to the caller
+ */
+static void* appendToSet(ECS ecs, Entity id, ComponentType compType, const void *component) {
+    Uint64 page = ENTITY_INDEX(id) / PAGE_SIZE;  // determine the page for the entity
+    Uint64 index = ENTITY_INDEX(id) % PAGE_SIZE;  // determine the index within the page
+    ComponentTypeSet *set = &ecs->components[compType];
+
+    // Make room for the page index, the new pages start out as the shared zero page
+    if (set->pageCount <= page) {
+        Uint64 **tmpSparse = realloc(set->sparse, (page + 1) * sizeof(Uint64 *));
+        if (!tmpSparse) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS sparse set");
+        set->sparse = tmpSparse;
+
+        Uint32 *tmpOccupancy = realloc(set->pageOccupancy, (page + 1) * sizeof(Uint32));
+        if (!tmpOccupancy) THROW_ERROR_AND_EXIT("Failed to reallocate memory for ECS sparse page occupancy");
+        set->pageOccupancy = tmpOccupancy;
+
+        for (Uint64 i = set->pageCount; i <= page; i++) {
+            set->sparse[i] = ZERO_PAGE;
+            set->pageOccupancy[i] = 0;
+        }
+        set->pageCount = page + 1;
     }
 
-    // Check if the page exists, if not, allocate it
-    if (ecs->components[compType].sparse == NULL || ecs->components[compType].pageCount <= page) {
-        #ifdef DEBUG
-            printf("Allocating memory for a page of the component %d's array\n", compType);
-        #endif
+    // Only the page the entity lives in gets real memory
+    if (set->sparse[page] == ZERO_PAGE) {
+        LOG_DEBUG(LOG_ECS, "Allocating memory for page %lu of the component %d's array", page, compType);
 
-        // Allocate memory for a new page
-        ecs->components[compType].sparse = realloc(ecs->components[compType].sparse, (page + 1) * sizeof(Uint64 *));
-        if (!ecs->components[compType].sparse) {
-            fprintf(stderr, "Failed to reallocate memory for ECS sparse set\n");
-            exit(EXIT_FAILURE);
-        }
-        // Allocate PAGE_SIZE memory for each page
-        for (Uint64 i = ecs->components[compType].pageCount; i <= page; i++) {
-            ecs->components[compType].sparse[i] = calloc(PAGE_SIZE, sizeof(Uint64));
-            if (!ecs->components[compType].sparse[i]) {
-                fprintf(stderr, "Failed to allocate memory for ECS sparse set page %lu\n", i);
-                exit(EXIT_FAILURE);
-            }
-        }
-        ecs->components[compType].pageCount = page + 1;
+        set->sparse[page] = calloc(PAGE_SIZE, sizeof(Uint64));
+        if (!set->sparse[page]) THROW_ERROR_AND_EXIT("Failed to allocate memory for an ECS sparse set page");
     }
-    
-    // Check if the dense array exists, if not, allocate it
-    if (ecs->components[compType].dense == NULL) {
-        #ifdef DEBUG
-            printf("Allocating memory for the dense array of the component %d\n", compType);
-        #endif
-
-        // initially, it will have INIT_CAPACITY memory allocated
-        ecs->components[compType].dense = calloc(ecs->capacity, sizeof(void *));
-        ecs->components[compType].denseToEntity = calloc(ecs->capacity, sizeof(Entity));
-        if (!ecs->components[compType].dense || !ecs->components[compType].denseToEntity) {
-            fprintf(stderr, "Failed to allocate memory for ECS dense set\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    // Check if the entity ID will fit in the dense array
-    if (id >= ecs->capacity) {
-        #ifdef DEBUG
-            printf("Reallocating memory for the dense array of the component %d's array\n", compType);
-        #endif
+    set->pageOccupancy[page]++;
 
-        // Resize the dense array if needed
-        void **tmpDense = realloc(ecs->components[compType].dense, ecs->capacity * sizeof(void *));
-        Entity *tmpDenseToEntity = realloc(ecs->components[compType].denseToEntity, ecs->capacity * sizeof(Entity));
-        if (!tmpDense || !tmpDenseToEntity) {
-            fprintf(stderr, "Failed to reallocate memory for ECS dense set\n");
-            exit(EXIT_FAILURE);
-        }
-        ecs->components[compType].dense = tmpDense;
-        ecs->components[compType].denseToEntity = tmpDenseToEntity;
+    // Every component type grows on its own, so rarely used types stay small
+    if (set->denseSize >= set->denseCapacity) {
+        growDenseSet(set, set->denseCapacity ? set->denseCapacity * 2 : INIT_CAPACITY);
     }
 
     // Allocations done, now add the component
     Uint64 denseIdx = ecs->components[compType].denseSize;
+    void *stored = DENSE_AT(&ecs->components[compType], denseIdx);
     ecs->components[compType].sparse[page][index] = denseIdx;
-    ecs->components[compType].dense[denseIdx] = component;
+    memcpy(stored, component, ecs->components[compType].elemSize);
     ecs->components[compType].denseToEntity[denseIdx] = id;  // map the component to its entity ID
     ecs->components[compType].denseSize++;
 
     // And set the corresponding bit
-    ecs->componentsFlags[id] |= (1 << compType);
+    ecs->componentsFlags[ENTITY_INDEX(id)] |= (1 << compType);
+    return stored;
+}
+
+/**
+ * =====================================================================================================================
+ */
 
-    const ComponentType fineGrainedType[] = {
-        HEALTH_COMPONENT,
+void* addComponent(ECS ecs, Entity id, ComponentType compType, const void *component) {
+    if (compType >= COMPONENT_TYPE_COUNT) {
+        fprintf(stderr, "Invalid component type %d\n", compType);
+        return NULL;
+    }
+    if (!component) THROW_ERROR_AND_RETURN("Cannot add a NULL component", NULL);
+    if (!isAlive(ecs, id)) THROW_ERROR_AND_RETURN("Cannot add a component to a dead entity", NULL);
+    // A second slot would leave the first one orphaned in the dense array and its sparse page pinned forever
+    if (HAS_COMPONENT(ecs, id, compType)) THROW_ERROR_AND_RETURN("Entity already has a component of this type", NULL);
+
+    Uint64 page = ENTITY_INDEX(id) / PAGE_SIZE;
+    Uint64 index = ENTITY_INDEX(id) % PAGE_SIZE;
+    void *stored = appendToSet(ecs, id, compType, component);
+
+    // The last missing type of a group moves the entity's components into the group's packed range
+    if (ecs->components[compType].group) {
+        groupTryAdd(ecs, ecs->components[compType].group, id);
+        stored = DENSE_AT(&ecs->components[compType], ecs->components[compType].sparse[page][index]);
+    }
+
+    if (isFineGrainedComponent(compType)) markComponentDirty(ecs, id, compType);  // Dirty at creation
+
+    LOG_TRACE(LOG_ECS, "Added component %d to entity %ld", compType, id);
+    return stored;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void* restoreComponent(ECS ecs, Entity id, ComponentType compType, const void *component) {
+    if (!ecs || compType >= COMPONENT_TYPE_COUNT || !component) {
+        THROW_ERROR_AND_RETURN("Invalid argument in restoreComponent", NULL);
+    }
+    if (!isAlive(ecs, id)) THROW_ERROR_AND_RETURN("Cannot restore a component of a dead entity", NULL);
+    if (HAS_COMPONENT(ecs, id, compType)) THROW_ERROR_AND_RETURN("Entity already has a component of this type", NULL);
+
+    // No group shuffling, the slots come back in the order they were saved in
+    return appendToSet(ecs, id, compType, component);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Entity* restoreDirtyList(ECS ecs, ComponentType compType, Uint64 count) {
+    if (!ecs || compType >= COMPONENT_TYPE_COUNT) THROW_ERROR_AND_RETURN("Invalid argument in restoreDirtyList", NULL);
+
+    ComponentTypeSet *set = &ecs->components[compType];
+    if (count > set->dirtyCapacity) {
+        Entity *tmp = realloc(set->dirtyEntities, count * sizeof(Entity));
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for a dirty list");
+        set->dirtyEntities = tmp;
+        set->dirtyCapacity = count;
+    }
+    set->dirtyCount = count;
+    return set->dirtyEntities;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void initView(ECSView *view, ECS ecs, bitset required, bitset optional) {
+    if (!view || !ecs) THROW_ERROR_AND_RETURN_VOID("View or ECS is NULL in initView");
+    if (required == 0) THROW_ERROR_AND_RETURN_VOID("A view needs at least one required component");
+
+    *view = (ECSView) {
+        .ecs = ecs,
+        .required = required,
+        .optional = optional & ~required
     };
-    const size_t fineGrainedCount = sizeof(fineGrainedType) / sizeof(ComponentType);
-    for (size_t i = 0; i < fineGrainedCount; i++) {
-        if (compType == fineGrainedType[i]) {
-            markComponentDirty(ecs, id, compType);  // Mark fine-grained components as dirty at creation
-            break;
+
+    // The smallest required set drives the iteration, every other entity would be rejected anyway
+    Uint8 driverFound = 0;
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+        bitset bit = COMPONENT_MASK(i);
+        if (!((required | optional) & bit)) continue;
+        view->types[view->typeCount++] = i;
+
+        if (!(required & bit)) continue;
+        if (!driverFound || ecs->components[i].denseSize < ecs->components[view->driver].denseSize) {
+            view->driver = i;
+            driverFound = 1;
         }
     }
+}
 
-    #ifdef DEBUG
-        printf("Added component %d to entity %ld\n", compType, id);
-    #endif
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 viewNext(ECSView *view) {
+    ComponentTypeSet *comps = view->ecs->components;
+    ComponentTypeSet *driver = &comps[view->driver];
+
+    // If the last yielded entity got deleted, the slot it left holds an entity which wasn't visited yet
+    if (view->cursor > 0 && view->cursor <= driver->denseSize
+        && driver->denseToEntity[view->cursor - 1] != view->entity) {
+        view->cursor--;
+    }
+
+    while (view->cursor < driver->denseSize) {
+        Uint64 driverIdx = view->cursor++;
+        Entity e = driver->denseToEntity[driverIdx];
+        bitset flags = view->ecs->componentsFlags[ENTITY_INDEX(e)];
+        if ((flags & view->required) != view->required) continue;
+
+        // The page math is shared by all the looked up types
+        Uint64 page = ENTITY_INDEX(e) / PAGE_SIZE;
+        Uint64 offset = ENTITY_INDEX(e) % PAGE_SIZE;
+        for (Uint8 i = 0; i < view->typeCount; i++) {
+            ComponentType type = view->types[i];
+            if (type == view->driver) {
+                view->components[type] = DENSE_AT(driver, driverIdx);
+            } else if (flags & COMPONENT_MASK(type)) {
+                view->components[type] = DENSE_AT(&comps[type], comps[type].sparse[page][offset]);
+            } else {
+                view->components[type] = NULL;
+            }
+        }
+        view->entity = e;
+        return 1;
+    }
+    return 0;
 }
 
 /**
@@ -428,7 +655,7 @@ void markComponentDirty(ECS ecs, Entity id, ComponentType compType) {
         return;
     }
 
-    if (id >= ecs->capacity || id < 0) {
+    if (!isAlive(ecs, id)) {
         printf("Warning: Attempting to mark component dirty for entity %ld which is out of bounds\n", id);
         return;
     }
@@ -497,7 +724,10 @@ void unmarkComponentDirty(ECS ecs, ComponentType compType) {
     comp->dirtyEntities[0] = comp->dirtyEntities[--comp->dirtyCount];
 }
 
-SystemNode* createSystemNode(SystemType type, void (*update)(ZENg, double_t), Uint8 isFineGrained) {
+SystemNode* createSystemNode(
+    SystemType type, void (*update)(ZENg, double_t), Uint8 isFineGrained, bitset reads, bitset writes,
+    Uint32 chunkSize, SystemPhase phase
+) {
     SystemNode *node = calloc(1, sizeof(SystemNode));
     if (!node) {
         fprintf(stderr, "Failed to allocate memory for system node #%d\n", type);
@@ -507,9 +737,34 @@ SystemNode* createSystemNode(SystemType type, void (*update)(ZENg, double_t), Ui
     node->update = update;
     node->isDirty = 1;  // At creation force the system to update
     node->isFineGrained = isFineGrained;
+    node->reads = reads;
+    node->writes = writes;
+    node->chunkSize = chunkSize;
+    node->phase = phase;
     return node;
 }
 
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 systemsConflict(const SystemNode *a, const SystemNode *b) {
+    if (a->writes & (b->reads | b->writes)) return 1;
+    if (b->writes & a->reads) return 1;
+
+    // Propagating dirtiness writes the flags of the downstream systems
+    return (a->downstream & b->downstream) != 0;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 isFineGrainedComponent(ComponentType compType) {
+    // Their dirty lists are queues that their system drains every tick
+    return compType == HEALTH_COMPONENT;
+}
+
 /**
  * =====================================================================================================================
  */
@@ -668,6 +923,28 @@ void kahnTopSort(DependencyGraph *graph) {
         fprintf(stderr, "Kahn's sort failed: graph may have cycles or missing nodes (sorted %lu of %d)\n", sortedIndex, SYS_COUNT);
     }
 
+    // A system sits one level below its deepest dependency, the sorted order visits the dependencies first
+    graph->levelCount = 0;
+    for (Uint64 i = 0; i < sortedIndex; i++) {
+        SystemNode *node = graph->sortedNodes[i];
+        node->level = 0;
+        for (Uint64 j = 0; j < node->dependenciesCount; j++) {
+            if (node->dependencies[j]->level + 1 > node->level) node->level = node->dependencies[j]->level + 1;
+        }
+        if (node->level + 1 > graph->levelCount) graph->levelCount = node->level + 1;
+    }
+
+    // The downstream masks mirror propagateSystemDirtiness, which stops at the fine-grained systems
+    for (Uint64 i = sortedIndex; i > 0; i--) {
+        SystemNode *node = graph->sortedNodes[i - 1];
+        node->downstream = 0;
+        for (Uint64 j = 0; j < node->dependentsCount; j++) {
+            SystemNode *dependent = node->dependents[j];
+            if (dependent->isFineGrained) continue;
+            node->downstream |= ((bitset)1 << dependent->type) | dependent->downstream;
+        }
+    }
+
     #ifdef DEBUG
         printf("Sorted systems order:\n");
         for (Uint64 i = 0; i < graph->nodeCount; i++) {
@@ -681,99 +958,102 @@ void kahnTopSort(DependencyGraph *graph) {
  * =====================================================================================================================
  */
 
-void deleteEntity(ECS ecs, Entity id) {
-    if (!ecs) {
-        fprintf(stderr, "ECS is NULL, cannot delete entity\n");
-        return;
-    }
-
-    if (id >= ecs->capacity || id < 0) {
-        printf("Warning: Attempting to delete entity %ld which is out of bounds\n", id);
-        return;
-    }
-
-    if (ecs->componentsFlags[id] == 0) {
-        // entity has no components, just free the ID
-        ecs->freeEntities[ecs->freeEntityCount++] = id;
-        ecs->entityCount--;
-        return;
-    }
+/**
+ * Frees the data a component owns and swap-removes it from its dense array
+ * @param ecs an ECS struct = struct ecs*
+ * @param id the owner entity ID
+ * @param compType component type = enum variable
+ * @note the entity's flags and group memberships are left to the caller
+ */
+static void removeFromSet(ECS ecs, Entity id, ComponentType compType) {
+    Uint64 page = ENTITY_INDEX(id) / PAGE_SIZE;
+    Uint64 index = ENTITY_INDEX(id) % PAGE_SIZE;
+    ComponentTypeSet *compSet = &ecs->components[compType];
     
-    // Free all components associated with this entity
-    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
-        bitset componentFlag = 1 << i;
-        
-        // Check if entity has this component
-        if (ecs->componentsFlags[id] & componentFlag) {
-            // Find the component in the sparse set
-            Uint64 page = id / PAGE_SIZE;
-            Uint64 index = id % PAGE_SIZE;
-            ComponentTypeSet *compSet = &ecs->components[i];
-            
-            if (
-                compSet->sparse && 
-                page < compSet->pageCount &&
-                compSet->dense
-            ) {
-                Uint64 denseIndex = compSet->sparse[page][index];
-                void *component = compSet->dense[denseIndex];
-                
-                // Free the component data based on its type
-                if (component) {
-                    switch (i) {
-                        case COLLISION_COMPONENT: {
-                            CollisionComponent *colComp = (CollisionComponent*)component;
-                            if (colComp->hitbox) free(colComp->hitbox);
-                            break;
-                        }
-                        case RENDER_COMPONENT: {
-                            RenderComponent *render = (RenderComponent*)component;
-                            if (render->destRect) free(render->destRect);
-                            break;
-                        }
-                        case LOADOUT_COMPONENT: {
-                            LoadoutComponent *loadout = (LoadoutComponent*)component;
-                            // Only the nodes get freed, the weapons are freed as separate entities
-                            freeList(&loadout->currSecondaryGun);
-                            break;
-                        }
-                        case WEAPON_COMPONENT: {
-                            WeaponComponent *weapComp = (WeaponComponent*)component;
-                            if (weapComp->name) free(weapComp->name);
-                            if (weapComp->projComp) free(weapComp->projComp);
-                            break;
-                        }
-                    }
-                    free(component);
-                    
-                    // Remove from dense array by swapping with the last element
-                    Uint64 lastDenseIndex = compSet->denseSize - 1;
-                    if (denseIndex != lastDenseIndex) {
-                        // Move the last element to the position of the removed element
-                        compSet->dense[denseIndex] = compSet->dense[lastDenseIndex];
-                        
-                        // Use the reverse mapping
-                        Entity lastEntity = compSet->denseToEntity[lastDenseIndex];
-                        
-                        // Update the sparse pointer for the moved entity
-                        Uint64 lastPage = lastEntity / PAGE_SIZE;
-                        Uint64 lastIndex = lastEntity % PAGE_SIZE;
-                        compSet->sparse[lastPage][lastIndex] = denseIndex;
-
-                        // update the denseToEntity mapping
-                        compSet->denseToEntity[denseIndex] = lastEntity;
-                    }
-                    
-                    // Decrease the size of the dense array
-                    compSet->denseSize--;
-                    compSet->dense[lastDenseIndex] = NULL;  // avoid dangling pointer
-                }
+    if (
+        compSet->sparse && 
+        page < compSet->pageCount &&
+        compSet->dense
+    ) {
+        Uint64 denseIndex = compSet->sparse[page][index];
+        void *component = DENSE_AT(compSet, denseIndex);
+
+        // Free the data the component owns, based on its type
+        switch (compType) {
+            case COLLISION_COMPONENT: {
+                CollisionComponent *colComp = (CollisionComponent*)component;
+                slabFree(&ecs->pools[COLLISION_COMPONENT], colComp->hitbox);
+                break;
             }
+            case RENDER_COMPONENT: {
+                RenderComponent *render = (RenderComponent*)component;
+                slabFree(&ecs->pools[RENDER_COMPONENT], render->destRect);
+                break;
+            }
+            case LOADOUT_COMPONENT: {
+                LoadoutComponent *loadout = (LoadoutComponent*)component;
+                // Only the nodes get freed, the weapons are freed as separate entities
+                freeList(&loadout->currSecondaryGun);
+                break;
+            }
+            case WEAPON_COMPONENT: {
+                WeaponComponent *weapComp = (WeaponComponent*)component;
+                if (weapComp->name) free(weapComp->name);
+                break;
+            }
+            default: break;  // The rest own nothing outside of their dense slot
+        }
+
+        // Remove from dense array by swapping with the last element
+        Uint64 lastDenseIndex = compSet->denseSize - 1;
+        if (denseIndex != lastDenseIndex) {
+            // Move the last element to the position of the removed element
+            memcpy(component, DENSE_AT(compSet, lastDenseIndex), compSet->elemSize);
+
+            // Use the reverse mapping
+            Entity lastEntity = compSet->denseToEntity[lastDenseIndex];
+
+            // Update the sparse pointer for the moved entity
+            Uint64 lastPage = ENTITY_INDEX(lastEntity) / PAGE_SIZE;
+            Uint64 lastIndex = ENTITY_INDEX(lastEntity) % PAGE_SIZE;
+            compSet->sparse[lastPage][lastIndex] = denseIndex;
+
+            // update the denseToEntity mapping
+            compSet->denseToEntity[denseIndex] = lastEntity;
+        }
+
+        // Decrease the size of the dense array
+        compSet->denseSize--;
+
+        // The last component of a page gives the page back
+        if (--compSet->pageOccupancy[page] == 0) {
+            free(compSet->sparse[page]);
+            compSet->sparse[page] = ZERO_PAGE;
         }
     }
-    
+}
+
+/**
+ * Bumps the generation of an entity's index, so every handle to it goes stale
+ * @param ecs an ECS struct = struct ecs*
+ * @param id the entity ID
+ * @note the index itself is recycled later, by releaseEntityID
+ */
+static void killEntity(ECS ecs, Entity id) {
+    Uint64 idx = ENTITY_INDEX(id);
+    ecs->generations[idx] = (ecs->generations[idx] + 1) & ENTITY_GENERATION_MASK;
+    if (ecs->generations[idx] == 0) ecs->generations[idx] = ENTITY_FIRST_GENERATION;  // Wrapped around
+}
+
+/**
+ * Recycles the ID of an entity whose components were all removed
+ * @param ecs an ECS struct = struct ecs*
+ * @param id the entity ID
+ */
+static void releaseEntityID(ECS ecs, Entity id) {
+    Uint64 idx = ENTITY_INDEX(id);
     // Reset the components flags for this entity
-    ecs->componentsFlags[id] = 0;
+    ecs->componentsFlags[idx] = 0;
     
     // Add the entity ID to the free list for reuse
     if (ecs->freeEntityCount >= ecs->freeEntityCapacity) {
@@ -791,18 +1071,62 @@ void deleteEntity(ECS ecs, Entity id) {
     }
 
     // Remove the entity from the active entities array
-    Uint64 indexInActiveEntities = ecs->entityToActiveIndex[id];
+    Uint64 indexInActiveEntities = ecs->entityToActiveIndex[idx];
 	Entity lastEntity = ecs->activeEntities[ecs->entityCount - 1];
     // Swap the removed entity with the last one. Count decremental will make it inactive
     ecs->activeEntities[indexInActiveEntities] = lastEntity;
-	ecs->entityToActiveIndex[lastEntity] = indexInActiveEntities;
-    // Add this entity to the free list
-    ecs->freeEntities[ecs->freeEntityCount++] = id;
+	ecs->entityToActiveIndex[ENTITY_INDEX(lastEntity)] = indexInActiveEntities;
+    // Add this entity's index to the free list, its generation was already bumped
+    ecs->freeEntities[ecs->freeEntityCount++] = idx;
     ecs->entityCount--;
     
-    #ifdef DEBUG
-        printf("Deleted entity with ID %ld\n", id);
-    #endif
+    LOG_TRACE(LOG_ECS, "Deleted entity with ID %ld", id);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void deleteEntity(ECS ecs, Entity id) {
+    if (!ecs) {
+        fprintf(stderr, "ECS is NULL, cannot delete entity\n");
+        return;
+    }
+
+    if (!isAlive(ecs, id)) {
+        printf("Warning: Attempting to delete entity %ld which is not alive\n", id);
+        return;
+    }
+    killEntity(ecs, id);
+
+    // Leave the groups first, so the swap removals below only ever touch slots outside of them
+    for (Uint64 i = 0; i < GROUP_COUNT; i++) {
+        groupRemove(ecs, &ecs->groups[i], id);
+    }
+
+    // Free all components associated with this entity
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+        if (ecs->componentsFlags[ENTITY_INDEX(id)] & COMPONENT_MASK(i)) removeFromSet(ecs, id, i);
+    }
+    releaseEntityID(ecs, id);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void removeComponent(ECS ecs, Entity id, ComponentType compType) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot remove component");
+    if (compType >= COMPONENT_TYPE_COUNT) THROW_ERROR_AND_RETURN_VOID("Invalid component type in removeComponent");
+    if (!isAlive(ecs, id)) THROW_ERROR_AND_RETURN_VOID("Cannot remove a component from a dead entity");
+    if (!HAS_COMPONENT(ecs, id, compType)) THROW_ERROR_AND_RETURN_VOID("Entity doesn't own the component to remove");
+
+    // Leaving the group first keeps it packed
+    if (ecs->components[compType].group) groupRemove(ecs, ecs->components[compType].group, id);
+    removeFromSet(ecs, id, compType);
+    ecs->componentsFlags[ENTITY_INDEX(id)] &= ~COMPONENT_MASK(compType);
+
+    LOG_TRACE(LOG_ECS, "Removed component %d from entity %ld", compType, id);
 }
 
 /**
@@ -810,9 +1134,12 @@ void deleteEntity(ECS ecs, Entity id) {
  */
 
 void sweepState(ECS ecs, GameStateType stateType) {
+    // Entities pending deletion are already dead, only the command buffer can free their components
+    flushCommands(ecs);
+
     // Iterating backwards because the deletion changes the entities array order
     for (Int64 i = ecs->components[STATE_TAG_COMPONENT].denseSize - 1; i >= 0; i--) {
-        StateTagComponent *stateTag = ecs->components[STATE_TAG_COMPONENT].dense[i];
+        StateTagComponent *stateTag = DENSE_AT(&ecs->components[STATE_TAG_COMPONENT], i);
         if (*stateTag == stateType) {
             Entity owner = ecs->components[STATE_TAG_COMPONENT].denseToEntity[i];
             deleteEntity(ecs, owner);
@@ -820,21 +1147,351 @@ void sweepState(ECS ecs, GameStateType stateType) {
     }
 }
 
+/**
+ * =====================================================================================================================
+ */
+
+/**
+ * Orders entity indices from the highest to the lowest
+ */
+static int compareIndicesDesc(const void *a, const void *b) {
+    Entity x = *(const Entity *)a, y = *(const Entity *)b;
+    return (x < y) - (x > y);
+}
+
+void compactECS(ECS ecs) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot compact it");
+
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+        ComponentTypeSet *set = &ecs->components[i];
+
+        // Shrink the dense arrays to fit, an empty set gives them back entirely
+        if (set->denseSize == 0) {
+            free(set->dense);
+            free(set->denseToEntity);
+            set->dense = NULL;
+            set->denseToEntity = NULL;
+            set->denseCapacity = 0;
+        } else if (set->denseCapacity > set->denseSize && set->denseCapacity > INIT_CAPACITY) {
+            Uint64 newCapacity = set->denseSize > INIT_CAPACITY ? set->denseSize : INIT_CAPACITY;
+            void *tmpDense = realloc(set->dense, newCapacity * set->elemSize);
+            Entity *tmpDenseToEntity = realloc(set->denseToEntity, newCapacity * sizeof(Entity));
+            if (tmpDense) set->dense = tmpDense;
+            if (tmpDenseToEntity) set->denseToEntity = tmpDenseToEntity;
+            if (tmpDense && tmpDenseToEntity) set->denseCapacity = newCapacity;
+        }
+
+        // Drop the trailing empty pages from the page index
+        while (set->pageCount > 0 && set->sparse[set->pageCount - 1] == ZERO_PAGE) set->pageCount--;
+        if (set->pageCount == 0) {
+            free(set->sparse);
+            free(set->pageOccupancy);
+            set->sparse = NULL;
+            set->pageOccupancy = NULL;
+        }
+
+        if (set->dirtyCount == 0 && set->dirtyEntities) {
+            free(set->dirtyEntities);
+            set->dirtyEntities = NULL;
+            set->dirtyCapacity = 0;
+        }
+
+        trimSlabPool(&ecs->pools[i]);
+    }
+
+    // Hand out the lowest free indices first, so new entities land in few sparse pages
+    qsort(ecs->freeEntities, ecs->freeEntityCount, sizeof(Entity), compareIndicesDesc);
+
+    // Free indices at the top of the range are forgotten, createEntity hands them out again in order
+    // Their generations are kept, so the handles that died with them stay stale
+    Uint64 trimmed = 0;
+    while (trimmed < ecs->freeEntityCount && ecs->freeEntities[trimmed] == ecs->nextEntityID - 1) {
+        ecs->nextEntityID--;
+        trimmed++;
+    }
+    ecs->freeEntityCount -= trimmed;
+    memmove(ecs->freeEntities, ecs->freeEntities + trimmed, ecs->freeEntityCount * sizeof(Entity));
+
+    LOG_DEBUG(
+        LOG_ECS, "Compacted the ECS: %lu entities, %lu free IDs, next ID %lu",
+        ecs->entityCount, ecs->freeEntityCount, ecs->nextEntityID
+    );
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void clearECS(ECS ecs) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot clear it");
+    flushCommands(ecs);
+
+    // From the back, so the active entities array doesn't get shuffled
+    while (ecs->entityCount > 0) deleteEntity(ecs, ecs->activeEntities[ecs->entityCount - 1]);
+    for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) ecs->components[i].dirtyCount = 0;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/**
+ * Feeds bytes to a FNV-1a hash
+ * @param hash the hash so far
+ * @param data the bytes to add
+ * @param size number of bytes
+ * @return the updated hash
+ */
+static Uint64 hashBytes(Uint64 hash, const void *data, size_t size) {
+    const Uint8 *bytes = (const Uint8 *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+Uint64 getWorldChecksum(ECS ecs) {
+    if (!ecs) THROW_ERROR_AND_RETURN("ECS is NULL in getWorldChecksum", 0);
+
+    Uint64 hash = hashBytes(FNV_OFFSET_BASIS, &ecs->entityCount, sizeof(Uint64));
+    for (ComponentType type = 0; type < COMPONENT_TYPE_COUNT; type++) {
+        hash = hashBytes(hash, &ecs->components[type].denseSize, sizeof(Uint64));
+    }
+
+    // Field by field, the padding inside the structs holds garbage
+    ComponentTypeSet *set = &ecs->components[HEALTH_COMPONENT];
+    for (Uint64 i = 0; i < set->denseSize; i++) {
+        HealthComponent *health = DENSE_AT(set, i);
+        hash = hashBytes(hash, &health->currentHealth, sizeof(Int32));
+        hash = hashBytes(hash, &health->active, sizeof(Uint8));
+    }
+    set = &ecs->components[POSITION_COMPONENT];
+    for (Uint64 i = 0; i < set->denseSize; i++) hash = hashBytes(hash, DENSE_AT(set, i), sizeof(PositionComponent));
+    set = &ecs->components[DIRECTION_COMPONENT];
+    for (Uint64 i = 0; i < set->denseSize; i++) hash = hashBytes(hash, DENSE_AT(set, i), sizeof(DirectionComponent));
+    set = &ecs->components[VELOCITY_COMPONENT];
+    for (Uint64 i = 0; i < set->denseSize; i++) {
+        VelocityComponent *vel = DENSE_AT(set, i);
+        hash = hashBytes(hash, &vel->currVelocity, sizeof(Vec2));
+        hash = hashBytes(hash, &vel->predictedPos, sizeof(Vec2));
+    }
+    set = &ecs->components[WEAPON_COMPONENT];
+    for (Uint64 i = 0; i < set->denseSize; i++) {
+        hash = hashBytes(hash, &((WeaponComponent *)DENSE_AT(set, i))->timeSinceUse, sizeof(double_t));
+    }
+    set = &ecs->components[LIFETIME_COMPONENT];
+    for (Uint64 i = 0; i < set->denseSize; i++) {
+        hash = hashBytes(hash, &((LifetimeComponent *)DENSE_AT(set, i))->timeAlive, sizeof(double_t));
+    }
+    set = &ecs->components[COLLISION_COMPONENT];
+    for (Uint64 i = 0; i < set->denseSize; i++) {
+        SDL_Rect *hitbox = ((CollisionComponent *)DENSE_AT(set, i))->hitbox;
+        if (hitbox) hash = hashBytes(hash, hitbox, sizeof(SDL_Rect));
+    }
+
+    return hash;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+/**
+ * Appends a command to the ECS command buffer
+ * @param ecs an ECS struct = struct ecs*
+ * @param type what the command does
+ * @param id the target entity
+ * @param compType the component the command works with, if any
+ * @return pointer to the recorded command
+ */
+static ECSCommand* pushCommand(ECS ecs, ECSCommandType type, Entity id, ComponentType compType) {
+    CommandBuffer *cb = &ecs->commands;
+    if (cb->count >= cb->capacity) {
+        cb->capacity = cb->capacity ? cb->capacity * 2 : INIT_CAPACITY;
+        ECSCommand *tmp = realloc(cb->commands, cb->capacity * sizeof(ECSCommand));
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the ECS command buffer");
+        cb->commands = tmp;
+    }
+    ECSCommand *cmd = &cb->commands[cb->count++];
+    *cmd = (ECSCommand) {
+        .type = type,
+        .entity = id,
+        .compType = compType,
+        .payload = 0
+    };
+    return cmd;
+}
+
+/**
+ * Makes sure an entity array can hold a number of entities
+ * @param arr pointer to the array
+ * @param capacity pointer to the array's capacity
+ * @param count number of entities the array needs to hold
+ */
+static void reserveEntityArray(Entity **arr, Uint64 *capacity, Uint64 count) {
+    if (count <= *capacity) return;
+
+    Uint64 newCapacity = *capacity ? *capacity : INIT_CAPACITY;
+    while (newCapacity < count) newCapacity *= 2;
+    Entity *tmp = realloc(*arr, newCapacity * sizeof(Entity));
+    if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the ECS command buffer");
+    *arr = tmp;
+    *capacity = newCapacity;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Entity deferCreateEntity(ECS ecs, StateTagComponent state) {
+    if (!ecs) THROW_ERROR_AND_RETURN("ECS is NULL, cannot defer an entity creation", 0);
+
+    Entity deferred = DEFERRED_ENTITY_BIT | ecs->commands.createdCount++;
+    pushCommand(ecs, CMD_CREATE_ENTITY, deferred, 0)->payload = state;
+    return deferred;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void deferDeleteEntity(ECS ecs, Entity id) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot defer an entity deletion");
+
+    if (!IS_DEFERRED_ENTITY(id)) {
+        // Killing the entity right away drops duplicate requests and tells the systems the entity is gone
+        if (!isAlive(ecs, id)) return;
+        killEntity(ecs, id);
+    }
+    pushCommand(ecs, CMD_DELETE_ENTITY, id, 0);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void deferAddComponent(ECS ecs, Entity id, ComponentType compType, const void *component) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot defer a component addition");
+    if (compType >= COMPONENT_TYPE_COUNT) THROW_ERROR_AND_RETURN_VOID("Invalid component type in deferAddComponent");
+    if (!component) THROW_ERROR_AND_RETURN_VOID("Cannot add a NULL component");
+
+    CommandBuffer *cb = &ecs->commands;
+    size_t elemSize = ecs->components[compType].elemSize;
+    if (cb->payloadSize + elemSize > cb->payloadCapacity) {
+        Uint64 newCapacity = cb->payloadCapacity ? cb->payloadCapacity : 256;
+        while (newCapacity < cb->payloadSize + elemSize) newCapacity *= 2;
+        Uint8 *tmp = realloc(cb->payload, newCapacity);
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the ECS command buffer payload");
+        cb->payload = tmp;
+        cb->payloadCapacity = newCapacity;
+    }
+    memcpy(cb->payload + cb->payloadSize, component, elemSize);
+    pushCommand(ecs, CMD_ADD_COMPONENT, id, compType)->payload = cb->payloadSize;
+    cb->payloadSize += elemSize;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void deferRemoveComponent(ECS ecs, Entity id, ComponentType compType) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot defer a component removal");
+    if (compType >= COMPONENT_TYPE_COUNT) THROW_ERROR_AND_RETURN_VOID("Invalid component type in deferRemoveComponent");
+
+    pushCommand(ecs, CMD_REMOVE_COMPONENT, id, compType);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void flushCommands(ECS ecs) {
+    if (!ecs) THROW_ERROR_AND_RETURN_VOID("ECS is NULL, cannot flush the command buffer");
+    CommandBuffer *cb = &ecs->commands;
+    if (cb->count == 0) return;
+
+    LOG_DEBUG(LOG_ECS, "Flushing %lu ECS commands", cb->count);
+
+    reserveEntityArray(&cb->created, &cb->createdCapacity, cb->createdCount);
+    reserveEntityArray(&cb->deleted, &cb->deletedCapacity, cb->count);
+    Uint64 createdCount = 0;
+    Uint64 deletedCount = 0;
+
+    for (Uint64 i = 0; i < cb->count; i++) {
+        ECSCommand *cmd = &cb->commands[i];
+        Entity id = cmd->entity;
+        if (IS_DEFERRED_ENTITY(id) && cmd->type != CMD_CREATE_ENTITY) id = cb->created[id & ~DEFERRED_ENTITY_BIT];
+
+        switch (cmd->type) {
+            case CMD_CREATE_ENTITY: {
+                cb->created[createdCount++] = createEntity(ecs, (StateTagComponent)cmd->payload);
+                break;
+            }
+            case CMD_ADD_COMPONENT: {
+                if (!isAlive(ecs, id)) break;  // Deleted earlier in the batch, or since the command was recorded
+                addComponent(ecs, id, cmd->compType, cb->payload + cmd->payload);
+                break;
+            }
+            case CMD_REMOVE_COMPONENT: {
+                if (!isAlive(ecs, id)) break;  // Its components go with the deletion anyway
+                removeComponent(ecs, id, cmd->compType);
+                break;
+            }
+            case CMD_DELETE_ENTITY: {
+                // Deferred entities only got an ID now, drop duplicate requests the same way
+                if (IS_DEFERRED_ENTITY(cmd->entity)) {
+                    if (!isAlive(ecs, id)) break;
+                    killEntity(ecs, id);
+                }
+                cb->deleted[deletedCount++] = id;
+                break;
+            }
+        }
+    }
+
+    // Deletions go last, after leaving their groups the sets are emptied one component type at a time
+    for (Uint64 i = 0; i < deletedCount; i++) {
+        Entity id = cb->deleted[i];
+        for (Uint64 g = 0; g < GROUP_COUNT; g++) {
+            groupRemove(ecs, &ecs->groups[g], id);
+        }
+    }
+    for (Uint64 t = 0; t < COMPONENT_TYPE_COUNT; t++) {
+        for (Uint64 i = 0; i < deletedCount; i++) {
+            Entity id = cb->deleted[i];
+            if (ecs->componentsFlags[ENTITY_INDEX(id)] & COMPONENT_MASK(t)) removeFromSet(ecs, id, t);
+        }
+    }
+    for (Uint64 i = 0; i < deletedCount; i++) {
+        releaseEntityID(ecs, cb->deleted[i]);
+    }
+
+    cb->count = 0;
+    cb->payloadSize = 0;
+    cb->createdCount = 0;
+}
+
 /**
  * =====================================================================================================================
  */
 
 void freeECS(ECS ecs) {
     if (ecs) {
-        // Free all entities' components first
-        if (ecs->entityCount > 0) {
-            for (Int64 i = ecs->activeEntities[ecs->entityCount - 1]; i >= 0; i--) {
-                deleteEntity(ecs, ecs->activeEntities[i]);
-            }
+        // Pending deletions first, then all the remaining entities' components
+        flushCommands(ecs);
+        for (Uint64 i = ecs->entityCount; i > 0; i--) {
+            deleteEntity(ecs, ecs->activeEntities[i - 1]);
         }
         if (ecs->componentsFlags) {
             free(ecs->componentsFlags);
         }
+        if (ecs->generations) {
+            free(ecs->generations);
+        }
         if (ecs->activeEntities) {
             free(ecs->activeEntities);
         }
@@ -849,13 +1506,17 @@ void freeECS(ECS ecs) {
                 }
                 if (ecs->components[i].sparse) {
                     for (Uint64 j = 0; j < ecs->components[i].pageCount; j++) {
-                        if (ecs->components[i].sparse[j]) {
+                        if (ecs->components[i].sparse[j] != ZERO_PAGE) {
                             free(ecs->components[i].sparse[j]);
                         }
                     }
                     free(ecs->components[i].sparse);
                     ecs->components[i].sparse = NULL;
                 }
+                if (ecs->components[i].pageOccupancy) {
+                    free(ecs->components[i].pageOccupancy);
+                    ecs->components[i].pageOccupancy = NULL;
+                }
                 if (ecs->components[i].dense) {
                     free(ecs->components[i].dense);
                     ecs->components[i].dense = NULL;
@@ -867,9 +1528,16 @@ void freeECS(ECS ecs) {
             }
             free(ecs->components);
         }
+        for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+            freeSlabPool(&ecs->pools[i]);
+        }
         if (ecs->freeEntities) {
             free(ecs->freeEntities);
         }
+        if (ecs->commands.commands) free(ecs->commands.commands);
+        if (ecs->commands.payload) free(ecs->commands.payload);
+        if (ecs->commands.created) free(ecs->commands.created);
+        if (ecs->commands.deleted) free(ecs->commands.deleted);
         if (ecs->depGraph) {
             if (ecs->depGraph->nodes) {
                 for (Uint64 i = 0; i < ecs->depGraph->nodeCount; i++) {
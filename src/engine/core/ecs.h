@@ -28,7 +28,17 @@ typedef GameStateType StateTagComponent;
 
 // =================================================ENTITIES============================================================
 
-typedef Uint64 Entity;  // In an ECS, an entity is just an ID
+typedef Uint64 Entity;  // In an ECS, an entity is just an ID, carrying its index and generation
+
+// The low bits of an entity index the ECS arrays, the high ones tell apart the entities which reused the index
+#define ENTITY_INDEX_BITS 32
+#define ENTITY_GENERATION_MASK 0x7FFFFFFFu  // The top bit is reserved for deferred entities
+#define ENTITY_INDEX(entity) ((Uint64)((entity) & 0xFFFFFFFFu))
+#define ENTITY_GENERATION(entity) ((Uint32)(((entity) >> ENTITY_INDEX_BITS) & ENTITY_GENERATION_MASK))
+#define MAKE_ENTITY(index, generation) \
+    (((Entity)((generation) & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | (Entity)(index))
+#define ENTITY_FIRST_GENERATION 1u  // Generation 0 is never issued, so a zeroed handle can't pass for a live entity
+
 extern Entity PLAYER_ID;  // Global variable for the player entity ID
 typedef Uint64 bitset;  // A bitset to indicate which components an entity has
 
@@ -44,16 +54,28 @@ typedef Uint64 bitset;  // A bitset to indicate which components an entity has
  */
 
 #define HAS_COMPONENT(ecs, entity, compType) \
-    ((ecs)->componentsFlags[(entity)] & (1 << (compType)))
+    ((ecs)->componentsFlags[ENTITY_INDEX(entity)] & (1 << (compType)))
+
+// Bit of a component type inside an entity's components bitset
+#define COMPONENT_MASK(compType) ((bitset)1 << (compType))
 
 #define GET_COMPONENT(ecs, entity, compType, outVar, outVarType) \
     do { \
-        Uint64 page = (entity) / PAGE_SIZE; \
-        Uint64 idx  = (entity) % PAGE_SIZE; \
+        Uint64 page = ENTITY_INDEX(entity) / PAGE_SIZE; \
+        Uint64 idx  = ENTITY_INDEX(entity) % PAGE_SIZE; \
         Uint64 denseIdx = (ecs)->components[(compType)].sparse[page][idx]; \
-        outVar = (outVarType *)((ecs)->components[(compType)].dense[denseIdx]); \
+        outVar = (outVarType *)DENSE_AT(&(ecs)->components[(compType)], denseIdx); \
     } while (0)
 
+/**
+ * Macro to get the address of the component stored at an index of a component type's dense array
+ * @param compSet pointer to the ComponentTypeSet
+ * @param denseIdx index in the dense array
+ * @note components are stored by value, so the address is only valid until the next structural change of the set
+ */
+#define DENSE_AT(compSet, denseIdx) \
+    ((void *)((Uint8 *)(compSet)->dense + (Uint64)(denseIdx) * (compSet)->elemSize))
+
 
 // Available component types enum
 typedef enum {
@@ -67,7 +89,6 @@ typedef enum {
     LIFETIME_COMPONENT,
     COLLISION_COMPONENT,
     STATE_TAG_COMPONENT,
-    ACTIVE_TAG_COMPONENT,
     RENDER_COMPONENT,
     COMPONENT_TYPE_COUNT  // Number of components the ECS currently supports
 } ComponentType;
@@ -76,20 +97,38 @@ typedef enum {
 
 // General definition of a component type's sparse set
 typedef struct ComponentTypeSet {
-    Uint64 **sparse;  // Array of index arrays -- sparse[page][offset] = denseIndex
-    void **dense;  // Array of components -- dense[index] = (void *)component
+    Uint64 **sparse;  // Array of index arrays -- sparse[page][offset] = denseIndex, empty pages share a zero page
+    Uint32 *pageOccupancy;  // Number of components in every sparse page, a page is freed once it empties
+    void *dense;  // Contiguous array of components stored by value -- dense + index * elemSize
+    size_t elemSize;  // Size in bytes of one component of this type, set at registration
     Entity *denseToEntity;  // Maps component in dense array to its owner entity's ID
     Uint64 denseSize;  // Current size of the dense array
+    Uint64 denseCapacity;  // Number of components the dense arrays can hold, grows independently of the ECS
     Uint64 pageCount;  // Number of pages allocated for this component
     ComponentType type;  // The type of the component, needed for further info on each component
 
     Entity *dirtyEntities;  // Array of entities that need to be updated
     Uint64 dirtyCount;  // Number of dirty entities
     Uint64 dirtyCapacity;  // Capacity of the dirty entities array
+
+    struct componentGroup *group;  // The group owning this set, NULL if the set isn't grouped
 } ComponentTypeSet;
 
-// Boolean value to tell if an entity is active
-typedef Uint8 ActiveTagComponent;
+// Hot component signatures whose dense arrays are kept co-sorted
+typedef enum {
+    GROUP_MOVEMENT,  // Position, velocity, collision and render
+    GROUP_COUNT  // Automatically counts
+} GroupType;
+
+/**
+ * An owning group keeps the dense arrays of its types packed and in the same order:
+ * the first size entries of every owned array belong to the same entities
+ */
+typedef struct componentGroup {
+    bitset owned;  // Component types owned by the group
+    ComponentType lead;  // One of the owned types, tells where an entity sits in the group
+    Uint64 size;  // Number of entities owning all the types in the group
+} ComponentGroup;
 
 typedef struct {
     Int32 maxHealth; // Maximum health of the entity
@@ -104,6 +143,7 @@ typedef struct {
     double_t maxVelocity;  // Maximum speed of the entity
     Axis prevAxis;  // The last axis the entity moved on
     PositionComponent predictedPos;  // holds the predicted position based on the current velocity and direction
+    PositionComponent prevPos;  // Position at the start of the last simulation tick, rendering interpolates from it
     Uint8 active;
 } VelocityComponent;
 
@@ -136,7 +176,10 @@ typedef struct {
     CollisionRole role;  // The role of the entity in the collision
     Uint16 coverageStart;  // Index in the spatial grid array of the upper left corner of the owner entity's coverage
     Uint16 coverageEnd;  // Index in the spatial grid array of the bottom right corner of the owner entity's coverage
+    Sint16 sweepX;  // How far the hitbox is stretched on X over the path of a fast entity, 0 outside the collisions
+    Sint16 sweepY;  // How far the hitbox is stretched on Y
     Uint8 isSolid;  // Indicates if entities can pass through
+    Uint8 isFast;  // Swept from where it starts every tick instead of only being checked where it ends
     Uint8 numCells;  // How many cells the entity spans on
 } CollisionComponent;
 
@@ -156,7 +199,7 @@ typedef struct {
     int projW;  // Width of the projectile
     int projH;  // Height of the projectile
     double_t projSpeed;  // Speed of the projectile
-    ProjectileComponent *projComp;  // Pointer to the projectile component describing the projectile's behavior
+    ProjectileComponent projComp;  // The projectile component describing the projectile's behavior
     double_t projLifeTime;  // How long the projectile lasts before disappearing, in seconds
     SDL_Texture *projTexture;  // Pointer to the texture of the projectile
     Mix_Chunk *projSound;  // Pointer to the sound that plays when the gun fires
@@ -189,10 +232,42 @@ typedef enum {
     SYS_COUNT  // Automatically counts
 } SystemType;
 
+// When a system runs: once per fixed simulation tick or once per rendered frame
+typedef enum {
+    PHASE_SIMULATION,  // Advances the game state by a fixed tick
+    PHASE_PRESENTATION,  // Draws the game state, interpolating between the last two ticks
+    PHASE_COUNT  // Automatically counts
+} SystemPhase;
+
+/**
+ * Shared state besides the component sets that systems touch
+ * Declared in the same access masks as the component types, right after them
+ */
+typedef enum {
+    ACCESS_ENTITIES = COMPONENT_TYPE_COUNT,  // Entity liveness and the command buffer
+    ACCESS_WORLD,  // The level's tiles and the collision manager's spatial grid
+    ACCESS_FRAME_ARENA,  // The engine's frame arena
+    ACCESS_MAIN_THREAD,  // SDL renderer, UI tree and fonts, the systems touching them run on the main thread
+    ACCESS_COUNT  // Automatically counts
+} SystemAccess;
+
+/**
+ * Macro to get the access mask bit of a component type or of a SystemAccess
+ * @param access the component type or the SystemAccess
+ */
+#define ACCESS_MASK(access) ((bitset)1 << (access))
+
 typedef struct sysNode {
     SystemType type;  // System identifier
     void (*update)(ZENg, double_t);  // Function pointer to the system's update function
 
+    bitset reads;  // Access mask of the components and shared state the system only reads
+    bitset writes;  // Access mask of the components and shared state the system modifies
+    bitset downstream;  // Systems whose dirty flags the system can set, one bit per SystemType
+    Uint8 level;  // Longest dependency chain leading to the system, systems of a level are independent
+    Uint32 chunkSize;  // Entities handed to a worker at once by the system's parallel loops
+    SystemPhase phase;  // Whether the system runs every simulation tick or every rendered frame
+
     struct sysNode **dependents;  // Array of systems depending on this one
     Uint64 dependentsCount;  // Number of dependents
 
@@ -203,14 +278,55 @@ typedef struct sysNode {
     Uint8 isFineGrained;
     Uint8 isDirty;  // For coarse-grained systems, indicates if the system needs to be updated
     Uint8 isActive;  // Indicates if this system is currently active
+    double_t lastRunMs;  // Duration of the system's last run, in milliseconds
 } SystemNode;
 
 typedef struct depGraph {
     SystemNode **nodes;  // Array of all systems in the graph
     Uint64 nodeCount;  // Number of systems in the graph
     SystemNode **sortedNodes;  // Array of systems sorted by dependencies
+    Uint8 levelCount;  // Number of topological levels, set by the sort
 } DependencyGraph;
 
+// ================================================COMMANDS=============================================================
+
+// Structural changes a system can record instead of applying them mid-iteration
+typedef enum {
+    CMD_CREATE_ENTITY,
+    CMD_DELETE_ENTITY,
+    CMD_ADD_COMPONENT,
+    CMD_REMOVE_COMPONENT
+} ECSCommandType;
+
+// Entities created through the command buffer get a placeholder ID until the buffer is flushed
+// The placeholder uses the bit left out of the generation, so it can't be mistaken for a real entity
+#define DEFERRED_ENTITY_BIT ((Entity)1 << 63)
+#define IS_DEFERRED_ENTITY(entity) (((entity) & DEFERRED_ENTITY_BIT) != 0)
+
+typedef struct {
+    ECSCommandType type;  // What the command does
+    Entity entity;  // The target entity, may be a deferred one
+    ComponentType compType;  // The component added or removed
+    Uint64 payload;  // Offset of an added component in the payload buffer, or the state of a created entity
+} ECSCommand;
+
+typedef struct {
+    ECSCommand *commands;  // The recorded commands, in recording order
+    Uint64 count;  // Number of recorded commands
+    Uint64 capacity;  // Capacity of the commands array
+
+    Uint8 *payload;  // Copies of the components to add, stored back to back
+    Uint64 payloadSize;  // Number of bytes used in the payload buffer
+    Uint64 payloadCapacity;  // Capacity of the payload buffer
+
+    Entity *created;  // Real IDs of the deferred entities, filled while flushing
+    Uint64 createdCount;  // Number of deferred entities recorded since the last flush
+    Uint64 createdCapacity;  // Capacity of the created entities array
+
+    Entity *deleted;  // Entities to delete, gathered while flushing so they're deleted one component type at a time
+    Uint64 deletedCapacity;  // Capacity of the deleted entities array
+} CommandBuffer;
+
 // =====================================================================================================================
 
 #define INIT_CAPACITY 10  // Capacity with which the ECS is initialised
@@ -223,6 +339,7 @@ typedef struct EeSiEs {
 	Uint64 *entityToActiveIndex;  // Mapping entity ID -> index in the active entities array, for O(1) removal
     Entity *activeEntities;  // Array of active entities
     bitset *componentsFlags;  // An array of bitsets, one for each active
+    Uint32 *generations;  // Current generation of every entity index, bumped when the entity dies
     Entity nextEntityID;  // Next available entity ID
 
     Entity *freeEntities;  // Array of free entities, used for recycling IDs
@@ -230,10 +347,64 @@ typedef struct EeSiEs {
     Uint64 freeEntityCapacity;  // Capacity of the free entities array
 
     ComponentTypeSet *components;  // Array of component sparse sets, one for each type
+    SlabPool pools[COMPONENT_TYPE_COUNT];  // Pools for the data components own outside of their dense slots
+    ComponentGroup groups[GROUP_COUNT];  // Owning groups of component types, indexed by GroupType
+    CommandBuffer commands;  // Structural changes recorded by the systems, applied between them
 
     DependencyGraph *depGraph;  // Dependency graph for systems
 } *ECS;
 
+/**
+ * Tells whether an entity handle still refers to a living entity
+ * @param ecs an ECS struct = struct ecs*
+ * @param entity the entity handle, possibly stored a few frames ago
+ * @return 1 if the entity is alive, 0 if it was deleted (or is pending deletion)
+ * @note indices that were never issued and deferred placeholders are never alive
+ */
+static inline Uint8 isAlive(ECS ecs, Entity entity) {
+    return !IS_DEFERRED_ENTITY(entity)
+        && ENTITY_INDEX(entity) < ecs->nextEntityID
+        && ecs->generations[ENTITY_INDEX(entity)] == ENTITY_GENERATION(entity);
+}
+
+/**
+ * Macro to get a component of a group member, all the owned types share the same index
+ * @param ecs an ECS struct = struct ecs*
+ * @param compType the type of the component to get (enum variable), must be owned by the group
+ * @param groupIdx index of the member, less than the group's size
+ * @param outVarType the type of the component (e.g., PositionComponent)
+ */
+#define GROUP_GET(ecs, compType, groupIdx, outVarType) \
+    ((outVarType *)DENSE_AT(&(ecs)->components[(compType)], (groupIdx)))
+
+// =================================================VIEWS===============================================================
+
+/**
+ * A view iterates all the entities owning a set of components and yields all of them at once
+ * The smallest of the required sets drives the iteration, the others are looked up once per entity
+ */
+typedef struct {
+    ECS ecs;  // The ECS the view iterates
+    bitset required;  // Components an entity must own to be yielded
+    bitset optional;  // Components fetched when present, NULL otherwise
+    ComponentType driver;  // The smallest required set, its dense array is walked linearly
+    ComponentType types[COMPONENT_TYPE_COUNT];  // Required and optional types, fetched for every yielded entity
+    Uint8 typeCount;  // Number of types in the array above
+    Uint64 cursor;  // Next index in the driver's dense array
+    Entity entity;  // The entity currently yielded
+    void *components[COMPONENT_TYPE_COUNT];  // The current entity's components, indexed by component type
+} ECSView;
+
+/**
+ * Macro to get a component of the entity currently yielded by a view
+ * @param view pointer to the ECSView
+ * @param compType the type of the component to get (enum variable)
+ * @param outVarType the type of the component (e.g., PositionComponent)
+ * @note yields NULL for an optional component the entity doesn't own
+ */
+#define VIEW_GET(view, compType, outVarType) \
+    ((outVarType *)((view)->components[(compType)]))
+
 /**
  * Initialises the game ECS
  * @param ecs pointer to the ECS = struct ecs**
@@ -246,6 +417,23 @@ void initECS(ECS *ecs);
  */
 void freeECS(ECS ecs);
 
+/**
+ * Pre-sizes the per-entity arrays so creating entities doesn't reallocate them
+ * @param ecs an ECS struct = struct ecs*
+ * @param entities number of entities the ECS should hold without growing
+ * @note never shrinks the ECS
+ */
+void ecsReserve(ECS ecs, Uint64 entities);
+
+/**
+ * Pre-sizes the dense arrays of a component type so adding components doesn't reallocate them
+ * @param ecs an ECS struct = struct ecs*
+ * @param compType the type of the component
+ * @param count number of components of this type the set should hold without growing
+ * @note never shrinks the set
+ */
+void ecsReserveComponent(ECS ecs, ComponentType compType, Uint64 count);
+
 /**
  * Creates a new entity in an ECS
  * @param ecs an ECS struct = struct ecs*
@@ -262,6 +450,14 @@ Entity createEntity(ECS ecs, StateTagComponent state);
  */
 void deleteEntity(ECS ecs, Entity id);
 
+/**
+ * Removes a component from an entity, freeing the data it owns
+ * @param ecs an ECS struct = struct ecs*
+ * @param id the entity ID
+ * @param compType component type = enum variable
+ */
+void removeComponent(ECS ecs, Entity id, ComponentType compType);
+
 /**
  * Deletes all the entities belonging to a state
  * @param ecs pointer to the ECS
@@ -269,6 +465,69 @@ void deleteEntity(ECS ecs, Entity id);
  */
 void sweepState(ECS ecs, GameStateType stateType);
 
+/**
+ * Deletes every entity, whatever state it belongs to, and empties the dirty lists
+ * @param ecs an ECS struct = struct ecs*
+ * @note the bumped generations are kept, the entity bookkeeping is left for a snapshot to overwrite
+ */
+void clearECS(ECS ecs);
+
+/**
+ * Gives back the memory the ECS no longer needs, meant to run after the sweep that ends a session
+ * @param ecs an ECS struct = struct ecs*
+ * @note shrinks the dense arrays to fit, drops the empty sparse pages and slabs,
+ * and renumbers the free IDs so the lowest ones are handed out first
+ */
+void compactECS(ECS ecs);
+
+/**
+ * Hashes the simulated state of the world, used to tell whether two runs of the simulation diverged
+ * @param ecs an ECS struct = struct ecs*
+ * @return FNV-1a hash of the components' plain values, walked in dense order
+ * @note pointers and entity IDs are left out, they differ between runs even when the simulation doesn't
+ */
+Uint64 getWorldChecksum(ECS ecs);
+
+/**
+ * Records the creation of an entity, the entity is created when the command buffer is flushed
+ * @param ecs an ECS struct = struct ecs*
+ * @param state the state the entity belongs to
+ * @return a deferred entity ID, usable only with the other deferred operations until the flush
+ */
+Entity deferCreateEntity(ECS ecs, StateTagComponent state);
+
+/**
+ * Records the deletion of an entity
+ * @param ecs an ECS struct = struct ecs*
+ * @param id the entity ID, may be a deferred one
+ * @note the entity dies right away (isAlive fails), its components are removed at the flush
+ */
+void deferDeleteEntity(ECS ecs, Entity id);
+
+/**
+ * Records the addition of a component, the component is copied into the command buffer
+ * @param ecs an ECS struct = struct ecs*
+ * @param id the entity ID, may be a deferred one
+ * @param compType component type = enum variable
+ * @param component pointer to the component to copy
+ */
+void deferAddComponent(ECS ecs, Entity id, ComponentType compType, const void *component);
+
+/**
+ * Records the removal of a component
+ * @param ecs an ECS struct = struct ecs*
+ * @param id the entity ID, may be a deferred one
+ * @param compType component type = enum variable
+ */
+void deferRemoveComponent(ECS ecs, Entity id, ComponentType compType);
+
+/**
+ * Applies all the recorded structural changes
+ * @param ecs an ECS struct = struct ecs*
+ * @note creations, additions and removals are applied in recording order, deletions last and per component type
+ */
+void flushCommands(ECS ecs);
+
 /**
  * Marks an entity's component as dirty, meaning it needs to be updated
  * @param ecs an ECS struct = struct ecs*
@@ -277,6 +536,14 @@ void sweepState(ECS ecs, GameStateType stateType);
  */
 void markComponentDirty(ECS ecs, Entity id, ComponentType compType);
 
+/**
+ * Tells whether a component type's dirty list has a consumer
+ * @param compType component type = enum variable
+ * @return 1 if its fine-grained system cleans the components one by one, 0 if nothing reads its dirty list
+ * @note fine-grained components are marked dirty when they are added
+ */
+Uint8 isFineGrainedComponent(ComponentType compType);
+
 /**
  * Propagates the dirty state through the dependency graph
  * @param node the system node to start propagation from
@@ -297,9 +564,25 @@ void unmarkComponentDirty(ECS ecs, ComponentType compType);
  * @param type the type of the system
  * @param update the function pointer to the system's update function
  * @param isFineGrained indicates if the system is fine-grained (1) or coarse-grained (0)
+ * @param reads access mask of what the system only reads
+ * @param writes access mask of what the system modifies
+ * @param chunkSize entities handed to a worker at once by the system's parallel loops, 0 to split evenly
+ * @param phase whether the system runs every simulation tick or every rendered frame
  * @return a pointer to the newly created SystemNode
+ * @note the masks let the scheduler run systems concurrently, so they must cover everything the system touches
+ */
+SystemNode* createSystemNode(
+    SystemType type, void (*update)(ZENg, double_t), Uint8 isFineGrained, bitset reads, bitset writes,
+    Uint32 chunkSize, SystemPhase phase
+);
+
+/**
+ * Tells whether two systems can't run at the same time
+ * @param a pointer to a SystemNode
+ * @param b pointer to another SystemNode
+ * @return 1 if one writes what the other touches or both can dirty the same system, 0 otherwise
  */
-SystemNode* createSystemNode(SystemType type, void (*update)(ZENg, double_t), Uint8 isFineGrained);
+Uint8 systemsConflict(const SystemNode *a, const SystemNode *b);
 
 /**
  * Adds a dependency between two system nodes
@@ -334,31 +617,44 @@ void insertSystem(DependencyGraph *graph, SystemNode *node);
 /**
  * Performs a topological sort by Kahn's algorithm on the dependency graph
  * @param graph pointer to the dependency graph
- * @note the function allocates and populates the sortedNodes array in the graph
+ * @note the function allocates and populates the sortedNodes array in the graph,
+ * and sets the systems' levels and downstream masks
  */
 void kahnTopSort(DependencyGraph *graph);
 
 /**
- * Runs the active systems for the current frame
+ * Runs the active systems of a phase
  * @param zEngine pointer to the engine
- * @param deltaTime time since the last frame in seconds
+ * @param phase PHASE_SIMULATION once per tick, PHASE_PRESENTATION once per frame
+ * @param deltaTime the tick length for the simulation, the time since the last frame for the presentation
  * @note a topological sort must be done on the dependency graph prior to calling this function
+ * @note the systems of a level that don't conflict run concurrently, the commands are flushed after every batch
+ * @note a simulation tick starts by saving the positions the presentation interpolates from
+ */
+void runSystems(ZENg zEngine, SystemPhase phase, double_t deltaTime);
+
+/**
+ * Registers a component type to the ECS
+ * @param ecs an ECS struct = struct ecs*
+ * @param type the component type = enum variable
+ * @param elemSize size in bytes of one component of this type
+ * @note components are stored by value in their type's dense array, so the size must be known before any is added
  */
-void runSystems(ZENg zEngine, double_t deltaTime);
+void registerComponentType(ECS ecs, ComponentType type, size_t elemSize);
 
 /**
  * Creates a direction component
  * @param dir a direction vector
- * @return a pointer to a DirectionComponent
+ * @return a DirectionComponent
  */
-DirectionComponent* createDirectionComponent(DirectionComponent dir);
+DirectionComponent createDirectionComponent(DirectionComponent dir);
 
 /**
  * Creates a position component
  * @param pos a position vector
- * @return a pointer to a PositionComponent
+ * @return a PositionComponent
  */
-PositionComponent* createPositionComponent(PositionComponent pos);
+PositionComponent createPositionComponent(PositionComponent pos);
 
 /**
  * Creates a velocity component
@@ -367,9 +663,9 @@ PositionComponent* createPositionComponent(PositionComponent pos);
  * @param predictedPos the predicted position based on the current velocity and direction
  * @param lastAxis the last axis the entity moved on
  * @param active indicates if the component is active
- * @return a pointer to a VelocityComponent
+ * @return a VelocityComponent
  */
-VelocityComponent* createVelocityComponent(
+VelocityComponent createVelocityComponent(
     Vec2 velocity, double_t maxVelocity, PositionComponent predictedPos, Axis lastAxis, Uint8 active
 );
 
@@ -378,33 +674,37 @@ VelocityComponent* createVelocityComponent(
  * @param maxHealth the maximum health of the entity
  * @param currentHealth the current health of the entity
  * @param active indicates if the component is active
- * @return a pointer to a HealthComponent
+ * @return a HealthComponent
  */
-HealthComponent* createHealthComponent(Int32 maxHealth, Int32 currentHealth, Uint8 active);
+HealthComponent createHealthComponent(Int32 maxHealth, Int32 currentHealth, Uint8 active);
 
 /**
  * Creates a collision component
+ * @param ecs an ECS struct = struct ecs*
  * @param x the x coordinate of the hitbox
  * @param y the y coordinate of the hitbox
  * @param w the width of the hitbox
  * @param h the height of the hitbox
  * @param isSolid indicates if the entity can be passed through
  * @param role the role of the entity in the collision
- * @return a pointer to a CollisionComponent
+ * @return a CollisionComponent
+ * @note the hitbox comes from the collision components' pool and goes back when the owner entity is deleted
  */
-CollisionComponent* createCollisionComponent(int x, int y, int w, int h, Uint8 isSolid, CollisionRole role);
+CollisionComponent createCollisionComponent(ECS ecs, int x, int y, int w, int h, Uint8 isSolid, CollisionRole role);
 
 /**
  * Creates a render component
+ * @param ecs an ECS struct = struct ecs*
  * @param texture the texture to render
  * @param x the x coordinate of the destination rectangle
  * @param y the y coordinate of the destination rectangle
  * @param w the width of the destination rectangle
  * @param h the height of the destination rectangle
  * @param active indicates if the component is active
- * @return a pointer to a RenderComponent
+ * @return a RenderComponent
+ * @note the destination rectangle comes from the render components' pool and goes back when the owner is deleted
  */
-RenderComponent* createRenderComponent(SDL_Texture *texture, int x, int y, int w, int h, Uint8 active);
+RenderComponent createRenderComponent(ECS ecs, SDL_Texture *texture, int x, int y, int w, int h, Uint8 active);
 
 /**
  * Creates a loadout component
@@ -412,26 +712,77 @@ RenderComponent* createRenderComponent(SDL_Texture *texture, int x, int y, int w
  * @param currSecondaryGun pointer to a circular doubly linked list node, holding the current weapon
  * @param hull entity ID of the hull
  * @param module entity ID of the equipped module
- * @return a pointer to a WeaponComponent
+ * @return a LoadoutComponent
  */
-LoadoutComponent *createLoadoutComponent(Entity primaryGun, CDLLNode *currSecondaryGun, Entity hull, Entity module);
+LoadoutComponent createLoadoutComponent(Entity primaryGun, CDLLNode *currSecondaryGun, Entity hull, Entity module);
 
 /**
  * Creates a projectile component
  * @param dmg damage the projectile will deal on hit
  * @param piercing whether the projectile can pierce through entities (1) or not (0)
  * @param exploding whether the projectile explodes on impact (1) or not (0)
- * @return a pointer to a ProjectileComponent
+ * @return a ProjectileComponent
  */
-ProjectileComponent *createProjectileComponent(Int32 dmg, Uint8 piercing, Uint8 exploding, Uint8 friendly);
+ProjectileComponent createProjectileComponent(Int32 dmg, Uint8 piercing, Uint8 exploding, Uint8 friendly);
 
 /**
  * Adds a component to an entity in an ECS
  * @param ecs an ECS struct = struct ecs*
  * @param id ID of the owner entity
  * @param compType component type = enum variable
- * @param component address of a component to be added to the entity
+ * @param component address of a component to be copied into the type's dense array
+ * @return the address of the stored component
+ * @note the returned address is invalidated by the next structural change of the component type's set
 */
-void addComponent(ECS ecs, Entity id, ComponentType compType, void *component);
+void* addComponent(ECS ecs, Entity id, ComponentType compType, const void *component);
+
+/**
+ * Puts a saved component back at the end of its type's dense array, for rebuilding a world from a snapshot
+ * @param ecs an ECS struct = struct ecs*
+ * @param id ID of the owner entity
+ * @param compType component type = enum variable
+ * @param component address of the saved component, its pointers already pointing to live data
+ * @return the address of the stored component
+ * @note the groups and the dirty lists are left as they are, restoring a set slot by slot in its saved order
+ * gives back the same dense order, group ranges included
+ */
+void* restoreComponent(ECS ecs, Entity id, ComponentType compType, const void *component);
+
+/**
+ * Sizes a dirty list to be refilled from a snapshot
+ * @param ecs an ECS struct = struct ecs*
+ * @param compType component type = enum variable
+ * @param count number of entities the list will hold
+ * @return Entity * = the list, to be filled with count entities
+ * @note nothing is propagated, the systems' dirty flags are restored on their own
+ */
+Entity* restoreDirtyList(ECS ecs, ComponentType compType, Uint64 count);
+
+/**
+ * Declares an owning group and packs the entities which already own all of its types
+ * @param ecs an ECS struct = struct ecs*
+ * @param group the group to declare
+ * @param owned mask of the component types owned by the group, built with COMPONENT_MASK
+ * @note a component type can be owned by one group at most
+ */
+void registerGroup(ECS ecs, GroupType group, bitset owned);
+
+/**
+ * Prepares a view over the entities owning a set of components
+ * @param view pointer to the ECSView to initialise
+ * @param ecs an ECS struct = struct ecs*
+ * @param required mask of the components an entity must own, built with COMPONENT_MASK
+ * @param optional mask of the components fetched only when present
+ * @note the view can be walked with viewNext
+ */
+void initView(ECSView *view, ECS ecs, bitset required, bitset optional);
+
+/**
+ * Advances a view to the next entity owning all the required components
+ * @param view pointer to the ECSView
+ * @return 1 if an entity was yielded, 0 when the view is exhausted
+ * @note deleting the yielded entity is safe, the entity swapped into its slot is visited next
+ */
+Uint8 viewNext(ECSView *view);
 
 #endif // ECS_H
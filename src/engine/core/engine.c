@@ -6,6 +6,20 @@
 #include <SDL2/SDL_rect.h>
 #include <SDL2/SDL_render.h>
 
+// Names of the systems in the logs and the profiler's summary
+const char *const systemNames[SYS_COUNT] = {
+    [SYS_LIFETIME] = "SYS_LIFETIME",
+    [SYS_WEAPONS] = "SYS_WEAPONS",
+    [SYS_VELOCITY] = "SYS_VELOCITY",
+    [SYS_WORLD_COLLISIONS] = "SYS_WORLD_COLLISIONS",
+    [SYS_ENTITY_COLLISIONS] = "SYS_ENTITY_COLLISIONS",
+    [SYS_POSITION] = "SYS_POSITION",
+    [SYS_HEALTH] = "SYS_HEALTH",
+    [SYS_TRANSFORM] = "SYS_TRANSFORM",
+    [SYS_RENDER] = "SYS_RENDER",
+    [SYS_UI] = "SYS_UI"
+};
+
 void loadSettings(ZENg zEngine, const char *filePath) {
     // look for the file
     FILE *fin = fopen(filePath, "r");
@@ -21,6 +35,7 @@ void loadSettings(ZENg zEngine, const char *filePath) {
         fprintf(stderr, "No config file found in %s. Using defaults\n", filePath);
         setDefaultBindings(zEngine->inputMng);
         setDefaultDisplaySettings(zEngine->display);
+        if (zEngine->headless) return;  // Nothing to show the game on
         
         // the function above doesn't create the window and the renderer
         zEngine->display->window = SDL_CreateWindow(
@@ -45,11 +60,14 @@ void loadSettings(ZENg zEngine, const char *filePath) {
     }
 
     // if the file exists, read the settings
+    setDefaultBindings(zEngine->inputMng);  // For the actions the file doesn't bind
 
     enum {
         NONE,
         SECTION_DISPLAY,
-        SECTION_BINDINGS
+        SECTION_BINDINGS,
+        SECTION_TIMING,
+        SECTION_LOGGING
     } currSect = NONE;
 
     /* In case display settings are not fully specified, here's a failsafe*/
@@ -71,6 +89,12 @@ void loadSettings(ZENg zEngine, const char *filePath) {
         } else if (strcmp(line, "[INPUT]") == 0) {
             currSect = SECTION_BINDINGS;
             continue;
+        } else if (strcmp(line, "[TIMING]") == 0) {
+            currSect = SECTION_TIMING;
+            continue;
+        } else if (strcmp(line, "[LOGGING]") == 0) {
+            currSect = SECTION_LOGGING;
+            continue;
         }
 
         // Skip comments
@@ -123,11 +147,36 @@ void loadSettings(ZENg zEngine, const char *filePath) {
                     zEngine->inputMng->bindings[INPUT_SWITCH_RIGHT] = scancode;
                 } else if (strcmp(setting, "SPECIAL") == 0) {
                     zEngine->inputMng->bindings[INPUT_SPECIAL] = scancode;
+                } else if (strcmp(setting, "PERF_OVERLAY") == 0) {
+                    zEngine->inputMng->bindings[INPUT_PERF_OVERLAY] = scancode;
                 } else {
                     printf("Unknown action '%s'\n", setting);
                 }
                 break;
             }
+            case SECTION_TIMING: {
+                if (strcmp(setting, "TICK_RATE") == 0) {
+                    setTickRate(&zEngine->timestep, atoi(value));
+                } else if (strcmp(setting, "MAX_FPS") == 0) {
+                    zEngine->timestep.maxFPS = atoi(value);
+                } else {
+                    printf("Unknown TIMING setting: %s\n", setting);
+                }
+                break;
+            }
+            case SECTION_LOGGING: {
+                LogChannel channel = getLogChannelFromName(setting);
+                LogLevel level = getLogLevelFromName(value);
+                if (channel == LOG_CHANNEL_COUNT) {
+                    printf("Unknown log channel '%s'\n", setting);
+                } else if (level == LOG_LEVEL_COUNT) {
+                    printf("Unknown log level '%s' for channel '%s'\n", value, setting);
+                } else {
+                    setLogLevel(channel, level);
+                }
+                break;
+            }
+            default: break;
         }
     }
     fclose(fin);
@@ -138,6 +187,11 @@ void loadSettings(ZENg zEngine, const char *filePath) {
     zEngine->display->fullscreen = fullscreen;
     zEngine->display->vsync = vsync;
 
+    if (zEngine->headless) {
+        printf("Settings loaded from %s\n", filePath);
+        return;  // Nothing to show the game on
+    }
+
     // Create the window with the read settings
     zEngine->display->window = SDL_CreateWindow(
         "Crimson Shells",
@@ -182,6 +236,7 @@ void loadSettings(ZENg zEngine, const char *filePath) {
 
 void initLevel(ZENg zEngine, const char *levelFilePath) {
     if (!zEngine || !levelFilePath) THROW_ERROR_AND_RETURN_VOID("zEngine or levelFilePath is NULL in initLevel");
+    PROFILE_BEGIN(zone, "initLevel");
 
     zEngine->map = calloc(1, sizeof(struct arena));
     if (!zEngine->map) THROW_ERROR_AND_EXIT("Failed to allocate memory for Arena");
@@ -217,16 +272,6 @@ void initLevel(ZENg zEngine, const char *levelFilePath) {
     cJSON *tilesArray = cJSON_GetObjectItem(root, "tiles");
     if (!cJSON_IsArray(tilesArray)) THROW_ERROR_AND_RETURN_VOID("Invalid or missing 'tiles' array in level file");
 
-    char *tileTypeToStr[] = {
-        [TILE_EMPTY] = "TILE_EMPTY",
-        [TILE_GRASS] = "TILE_GRASS",
-        [TILE_WATER] = "TILE_WATER",
-        [TILE_ROCK] = "TILE_ROCK",
-        [TILE_BRICKS] = "TILE_BRICKS",
-        [TILE_WOOD] = "TILE_WOOD",
-        [TILE_SPAWN] = "TILE_SPAWN"
-    };
-
     Uint32 row = 0;
     cJSON *tileRow = NULL;
 
@@ -254,8 +299,7 @@ void initLevel(ZENg zEngine, const char *levelFilePath) {
                 fprintf(stderr, "%d, column %d: %d. Defaulting to TILE_EMPTY\n", row, col, currTileType);
                 currTileType = TILE_EMPTY;
             );
-            zEngine->map->tiles[row][col] = getTilePrefab(zEngine->prefabs, tileTypeToStr[currTileType]);
-            zEngine->map->tiles[row][col].idx = row * ARENA_WIDTH + col;
+            setArenaTile(zEngine->map, row, col, getTilePrefab(zEngine->prefabs, tileTypeNames[currTileType]));
             col++;
         }
         if (col < ARENA_WIDTH) THROW_ERROR_AND_DO(
@@ -271,8 +315,40 @@ void initLevel(ZENg zEngine, const char *levelFilePath) {
         row, ARENA_HEIGHT);
     );
 
+    // Optional, each arena can pick the broadphase that suits its crowds best
+    cJSON *broadphaseJson = cJSON_GetObjectItem(root, "broadphase");
+    if (cJSON_IsString(broadphaseJson)) {
+        BroadphaseMode mode = getBroadphaseFromName(broadphaseJson->valuestring);
+        if (mode < BROADPHASE_COUNT) setBroadphaseMode(zEngine->collisionMng, zEngine->ecs, zEngine->jobs, mode);
+        else THROW_ERROR_AND_DO(
+            "Unknown broadphase in level file: ",
+            fprintf(stderr, "'%s', keeping %s\n", broadphaseJson->valuestring, broadphaseNames[DEFAULT_BROADPHASE]);
+        );
+    }
+
     cJSON *entitiesArray = cJSON_GetObjectItem(root, "entities");
     if (cJSON_IsArray(entitiesArray)) {
+        // Pre-size the ECS from the level, so spawning tanks and their bullets mid-fight never reallocates
+        ECS ecs = zEngine->ecs;
+        Uint64 tanks = cJSON_GetArraySize(entitiesArray);
+        Uint64 projectiles = tanks * PROJECTILES_PER_TANK;
+        ecsReserve(ecs, ecs->entityCount + tanks + projectiles);
+
+        const Uint64 expected[COMPONENT_TYPE_COUNT] = {
+            [HEALTH_COMPONENT] = tanks,
+            [POSITION_COMPONENT] = tanks + projectiles,
+            [VELOCITY_COMPONENT] = tanks + projectiles,
+            [DIRECTION_COMPONENT] = tanks + projectiles,
+            [PROJECTILE_COMPONENT] = projectiles,
+            [LIFETIME_COMPONENT] = projectiles,
+            [COLLISION_COMPONENT] = tanks + projectiles,
+            [STATE_TAG_COMPONENT] = tanks + projectiles,
+            [RENDER_COMPONENT] = tanks + projectiles
+        };
+        for (Uint64 i = 0; i < COMPONENT_TYPE_COUNT; i++) {
+            if (expected[i] > 0) ecsReserveComponent(ecs, i, ecs->components[i].denseSize + expected[i]);
+        }
+
         cJSON *entityJson;
         cJSON_ArrayForEach(entityJson, entitiesArray) {
             cJSON *entityTypeJson = cJSON_GetObjectItem(entityJson, "entityType");
@@ -305,6 +381,7 @@ void initLevel(ZENg zEngine, const char *levelFilePath) {
     }
 
     cJSON_Delete(root);
+    PROFILE_END(zone);
 }
 
 /**
@@ -345,23 +422,87 @@ DependencyGraph* initDependencyGraph() {
         SystemType type;
         void (*update)(ZENg, double_t);
         Uint8 isFineGrained;
+        bitset reads;
+        bitset writes;
+        Uint32 chunkSize;
+        SystemPhase phase;
     } SysPair;
 
+    // What every system touches, the systems of a level run together on the job system when these don't overlap
+    // The collision systems declare what their handlers touch as well
+    // The chunk sizes keep a worker's slice of the dense arrays big enough to be worth the hand-off
+    // The presentation systems run once per rendered frame, the others once per simulation tick
     const SysPair sysPairs[] = {
-        {SYS_LIFETIME, &lifetimeSystem, 0},
-        {SYS_VELOCITY, &velocitySystem, 0},
-        {SYS_WORLD_COLLISIONS, &worldCollisionSystem, 0},
-        {SYS_ENTITY_COLLISIONS, &entityCollisionSystem, 0},
-        {SYS_POSITION, &positionSystem, 0},
-        {SYS_HEALTH, &healthSystem, 1},
-        {SYS_TRANSFORM, &transformSystem, 0},
-        {SYS_RENDER, &renderSystem, 0},
-        {SYS_UI, &uiSystem, 1},
-        {SYS_WEAPONS, &weaponSystem, 0}
+        {
+            SYS_LIFETIME, &lifetimeSystem, 0,
+            0,
+            ACCESS_MASK(LIFETIME_COMPONENT) | ACCESS_MASK(ACCESS_ENTITIES),
+            0, PHASE_SIMULATION
+        },
+        {
+            SYS_VELOCITY, &velocitySystem, 0,
+            ACCESS_MASK(POSITION_COMPONENT) | ACCESS_MASK(RENDER_COMPONENT) | ACCESS_MASK(PROJECTILE_COMPONENT),
+            ACCESS_MASK(VELOCITY_COMPONENT) | ACCESS_MASK(COLLISION_COMPONENT) | ACCESS_MASK(ACCESS_FRAME_ARENA),
+            256, PHASE_SIMULATION
+        },
+        {
+            SYS_WORLD_COLLISIONS, &worldCollisionSystem, 0,
+            ACCESS_MASK(PROJECTILE_COMPONENT),
+            ACCESS_MASK(VELOCITY_COMPONENT) | ACCESS_MASK(COLLISION_COMPONENT) | ACCESS_MASK(HEALTH_COMPONENT)
+            | ACCESS_MASK(ACCESS_ENTITIES) | ACCESS_MASK(ACCESS_WORLD),
+            0, PHASE_SIMULATION
+        },
+        {
+            SYS_ENTITY_COLLISIONS, &entityCollisionSystem, 0,
+            ACCESS_MASK(PROJECTILE_COMPONENT),
+            ACCESS_MASK(VELOCITY_COMPONENT) | ACCESS_MASK(COLLISION_COMPONENT) | ACCESS_MASK(HEALTH_COMPONENT)
+            | ACCESS_MASK(ACCESS_ENTITIES) | ACCESS_MASK(ACCESS_WORLD),
+            0, PHASE_SIMULATION
+        },
+        {
+            SYS_POSITION, &positionSystem, 0,
+            ACCESS_MASK(HEALTH_COMPONENT) | ACCESS_MASK(DIRECTION_COMPONENT),
+            ACCESS_MASK(POSITION_COMPONENT) | ACCESS_MASK(VELOCITY_COMPONENT) | ACCESS_MASK(COLLISION_COMPONENT),
+            0, PHASE_SIMULATION
+        },
+        {
+            SYS_HEALTH, &healthSystem, 1,
+            0,
+            ACCESS_MASK(HEALTH_COMPONENT) | ACCESS_MASK(ACCESS_ENTITIES),
+            0, PHASE_SIMULATION
+        },
+        {
+            SYS_TRANSFORM, &transformSystem, 0,
+            ACCESS_MASK(POSITION_COMPONENT) | ACCESS_MASK(VELOCITY_COMPONENT) | ACCESS_MASK(ACCESS_ENTITIES),
+            ACCESS_MASK(RENDER_COMPONENT),
+            0, PHASE_PRESENTATION
+        },
+        {
+            SYS_RENDER, &renderSystem, 0,
+            ACCESS_MASK(RENDER_COMPONENT) | ACCESS_MASK(DIRECTION_COMPONENT) | ACCESS_MASK(COLLISION_COMPONENT)
+            | ACCESS_MASK(ACCESS_WORLD),
+            ACCESS_MASK(ACCESS_MAIN_THREAD),
+            0, PHASE_PRESENTATION
+        },
+        {
+            SYS_UI, &uiSystem, 1,
+            ACCESS_MASK(ACCESS_ENTITIES) | ACCESS_MASK(ACCESS_WORLD),  // The performance overlay reads the ECS
+            ACCESS_MASK(ACCESS_MAIN_THREAD),
+            0, PHASE_PRESENTATION
+        },
+        {
+            SYS_WEAPONS, &weaponSystem, 0,
+            0,
+            ACCESS_MASK(WEAPON_COMPONENT),
+            512, PHASE_SIMULATION
+        }
     };
 
     for (Uint64 i = 0; i < SYS_COUNT; i++) {
-        insertSystem(graph, createSystemNode(sysPairs[i].type, sysPairs[i].update, sysPairs[i].isFineGrained));
+        insertSystem(graph, createSystemNode(
+            sysPairs[i].type, sysPairs[i].update, sysPairs[i].isFineGrained, sysPairs[i].reads, sysPairs[i].writes,
+            sysPairs[i].chunkSize, sysPairs[i].phase
+        ));
     }
 
     typedef struct {
@@ -389,19 +530,10 @@ DependencyGraph* initDependencyGraph() {
             addSystemDependency(dependency, dependent);
 
             #ifdef DEBUG
-                const char* sysNames[] = {
-                    "SYS_LIFETIME",
-                    "SYS_WEAPONS",
-                    "SYS_VELOCITY",
-                    "SYS_WORLD_COLLISIONS",
-                    "SYS_ENTITY_COLLISIONS",
-                    "SYS_POSITION",
-                    "SYS_HEALTH",
-                    "SYS_TRANSFORM",
-                    "SYS_RENDER",
-                    "SYS_UI"
-                };
-                printf("Added system dependency: %s -> %s\n", sysNames[dependency->type], sysNames[dependent->type]);
+                printf(
+                    "Added system dependency: %s -> %s\n",
+                    systemNames[dependency->type], systemNames[dependent->type]
+                );
             #endif
         } else THROW_ERROR_AND_DO(
             "Invalid system relationship in dependencies array: ",
@@ -416,38 +548,51 @@ DependencyGraph* initDependencyGraph() {
  * =====================================================================================================================
  */
 
-ZENg initGame() {
+ZENg initGame(Uint8 headless) {
     ZENg zEngine = calloc(1, sizeof(struct engine));
     if (!zEngine) THROW_ERROR_AND_EXIT("Failed to allocate memory for the game engine");
-    // Initialize SDL
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) THROW_ERROR_AND_DO(
+    zEngine->headless = headless;
+
+    // Initialize SDL, a headless engine only needs the timers
+    if (SDL_Init(headless ? SDL_INIT_TIMER : SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) THROW_ERROR_AND_DO(
         "SDL_Init Error: ", fprintf(stderr, "%s\n", SDL_GetError()); exit(EXIT_FAILURE);
     );
+    // Started before anything logs, the channel levels are read with the rest of the settings
+    initLogger();
 
-    // Prepare the audio device
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) THROW_ERROR_AND_DO(
-        "SDL_Mixer could not initialize: ",
-        fprintf(stderr, "%s\n", Mix_GetError()); exit(EXIT_FAILURE);
-    );
+    #ifdef PROFILER
+        // Every system gets a line in the summary printed at exit
+        initProfiler(systemNames, SYS_COUNT);
+    #endif
 
-    // Init fonts
-    if (TTF_Init() == -1) THROW_ERROR_AND_DO(
-        "SDL_TTF could not initialize: ",
-        fprintf(stderr, "%s\n", TTF_GetError()); exit(EXIT_FAILURE);
-    );
+    if (!headless) {
+        // Prepare the audio device
+        if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) THROW_ERROR_AND_DO(
+            "SDL_Mixer could not initialize: ",
+            fprintf(stderr, "%s\n", Mix_GetError()); exit(EXIT_FAILURE);
+        );
 
-    // Init SDL_Image
-    if (IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) == 0) THROW_ERROR_AND_DO(
-        "SDL_Image could not initialize: ",
-        fprintf(stderr, "%s\n", IMG_GetError()); exit(EXIT_FAILURE);
-    );
+        // Init fonts
+        if (TTF_Init() == -1) THROW_ERROR_AND_DO(
+            "SDL_TTF could not initialize: ",
+            fprintf(stderr, "%s\n", TTF_GetError()); exit(EXIT_FAILURE);
+        );
+
+        // Init SDL_Image
+        if (IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) == 0) THROW_ERROR_AND_DO(
+            "SDL_Image could not initialize: ",
+            fprintf(stderr, "%s\n", IMG_GetError()); exit(EXIT_FAILURE);
+        );
+    }
 
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
     
     // Initalize the display and input managers by reading settings file if existent
+    // The settings file may override the clock's tick rate
+    initTimestep(&zEngine->timestep, DEFAULT_TICK_RATE);
     loadSettings(zEngine, "settings.ini");
     // Set logical screen size
-    if (SDL_RenderSetLogicalSize(zEngine->display->renderer, LOGICAL_WIDTH, LOGICAL_HEIGHT) < 0)
+    if (!headless && SDL_RenderSetLogicalSize(zEngine->display->renderer, LOGICAL_WIDTH, LOGICAL_HEIGHT) < 0)
         THROW_ERROR_AND_DO("SDL_RenderSetLogicalSize failed: ", fprintf(stderr, "%s\n", SDL_GetError()););
                 
     // After setting the display resolution define the tile size
@@ -456,19 +601,34 @@ ZENg initGame() {
 
     // Initialize ECS
     initECS(&zEngine->ecs);
+    initMotionKernels();
+    initFrameArena(&zEngine->frameArena, FRAME_ARENA_SIZE);
+    // One worker per core, the main thread being the first of them
+    zEngine->jobs = initJobSystem(0);
 
     // Initialize the resource manager and preload resources
     zEngine->resources = MapInit(257, MAP_RESOURCES);
-    preloadResources(zEngine->resources, zEngine->display->renderer);
+    preloadResources(zEngine->resources, zEngine->display->renderer, headless);
 
     // Initialize the prefabs manager
     zEngine->prefabs = MapInit(127, MAP_PREFABS);
     loadPrefabs(zEngine, "data/prefabs.json");
 
     zEngine->uiManager = initUIManager();
+    if (!headless) {
+        zEngine->uiManager->overlay = createPerfOverlay(
+            zEngine->display->renderer, getFont(zEngine->resources, "assets/fonts/ByteBounce.ttf#16")
+        );
+    }
 
-    // Start on the main menu
     initStateManager(&zEngine->stateMng);
+    if (headless) {
+        // No menus to click through, go straight to the arena
+        mMenuToPlay(zEngine, NULL);
+        return zEngine;
+    }
+
+    // Start on the main menu
     GameState *mainMenuState = calloc(1, sizeof(GameState));
     if (!mainMenuState) THROW_ERROR_AND_EXIT("Failed to allocate memory for main menu state");
 
@@ -485,63 +645,92 @@ ZENg initGame() {
  * =====================================================================================================================
  */
 
+/**
+ * Shared state of the velocity system's parallel loop
+ */
+typedef struct {
+    ECS ecs;  // The ECS holding the movement group
+    MotionBatch *batch;  // SoA batch covering the whole group
+    double_t deltaTime;  // Time step of the integration
+} MotionJob;
+
+/**
+ * Predicts the positions of a slice of the movement group
+ * @param data the MotionJob
+ * @param start index of the first entity in the group
+ * @param end index past the last entity in the group
+ */
+static void integrateMotionRange(void *data, Uint64 start, Uint64 end) {
+    MotionJob *job = data;
+    ECS ecs = job->ecs;
+    MotionBatch *batch = job->batch;
+
+    // Stream the packed movement group into the SoA batch
+    for (Uint64 i = start; i < end; i++) {
+        VelocityComponent *velComp = GROUP_GET(ecs, VELOCITY_COMPONENT, i, VelocityComponent);
+        PositionComponent *posComp = GROUP_GET(ecs, POSITION_COMPONENT, i, PositionComponent);
+        SDL_Rect *entityRect = GROUP_GET(ecs, RENDER_COMPONENT, i, RenderComponent)->destRect;
+
+        batch->x[i] = posComp->x;
+        batch->y[i] = posComp->y;
+        batch->vx[i] = velComp->currVelocity.x;
+        batch->vy[i] = velComp->currVelocity.y;
+        // The predicted position is clamped to the window bounds
+        batch->maxX[i] = entityRect ? LOGICAL_WIDTH - entityRect->w : INFINITY;
+        batch->maxY[i] = entityRect ? LOGICAL_HEIGHT - entityRect->h : INFINITY;
+    }
+
+    // Update the predicted positions based on the velocities, several entities per instruction
+    MotionBatch slice = {
+        .x = batch->x + start, .y = batch->y + start,
+        .vx = batch->vx + start, .vy = batch->vy + start,
+        .maxX = batch->maxX + start, .maxY = batch->maxY + start,
+        .count = end - start
+    };
+    integrateMotionBatch(&slice, job->deltaTime);
+
+    for (Uint64 i = start; i < end; i++) {
+        VelocityComponent *velComp = GROUP_GET(ecs, VELOCITY_COMPONENT, i, VelocityComponent);
+        velComp->predictedPos.x = batch->x[i];
+        velComp->predictedPos.y = batch->y[i];
+
+        CollisionComponent *colComp = GROUP_GET(ecs, COLLISION_COMPONENT, i, CollisionComponent);
+        colComp->hitbox->x = velComp->predictedPos.x;
+        colComp->hitbox->y = velComp->predictedPos.y;
+    }
+}
+
 void velocitySystem(ZENg zEngine, double_t deltaTime) {
     if (zEngine->ecs->depGraph->nodes[SYS_VELOCITY]->isDirty == 0) {
         if (zEngine->ecs->components[PROJECTILE_COMPONENT].denseSize > 0) {
             // If there are projectiles, let them behave
             zEngine->ecs->depGraph->nodes[SYS_VELOCITY]->isDirty = 1;
         } else {
-            #ifdef DEBUGSYSTEMS
-                printf("[VELOCITY SYSTEM] Velocity system is not dirty\n");
-            #endif
+            LOG_DEBUG(LOG_SYSTEMS, "[VELOCITY SYSTEM] Velocity system is not dirty");
             return;
         }
     }
     
-    #ifdef DEBUGSYSTEMS
-        printf(
-            "[VELOCITY SYSTEM] Running velocity system for %lu entities\n",
-            zEngine->ecs->components[VELOCITY_COMPONENT].denseSize
-        );
-    #endif
+    LOG_DEBUG(
+        LOG_SYSTEMS, "[VELOCITY SYSTEM] Running velocity system for %lu entities",
+        zEngine->ecs->components[VELOCITY_COMPONENT].denseSize
+    );
 
-    ComponentTypeSet velComps = zEngine->ecs->components[VELOCITY_COMPONENT];
-    // for each entity with a VELOCITY_COMPONENT, update its position based on the current velocity
-    for (Uint64 i = 0; i < velComps.denseSize; i++) {
-        VelocityComponent *velComp = (VelocityComponent *)(velComps.dense[i]);
-        Entity entitty = velComps.denseToEntity[i];
-        
-        if (!HAS_COMPONENT(zEngine->ecs, entitty, POSITION_COMPONENT))
-            THROW_ERROR_AND_RETURN_VOID("Entity with VELOCITY_COMPONENT has no POSITION_COMPONENT");
-        PositionComponent *posComp = NULL;
-        GET_COMPONENT(zEngine->ecs, entitty, POSITION_COMPONENT, posComp, PositionComponent);
-
-        // Update the predicted position based on the velocity
-        velComp->predictedPos.x = posComp->x + velComp->currVelocity.x * deltaTime;
-        velComp->predictedPos.y = posComp->y + velComp->currVelocity.y * deltaTime;
-
-        // Clamp the position to the window bounds
-        if (velComp->predictedPos.x < 0) velComp->predictedPos.x = 0;
-        if (velComp->predictedPos.y < 0) velComp->predictedPos.y = 0;
-        RenderComponent *rendComp = NULL;
-        GET_COMPONENT(zEngine->ecs, entitty, RENDER_COMPONENT, rendComp, RenderComponent);
-        SDL_Rect *entityRect = rendComp->destRect;
-        if (entityRect) {
-            if (velComp->predictedPos.x + entityRect->w >= LOGICAL_WIDTH) {
-                velComp->predictedPos.x = LOGICAL_WIDTH - entityRect->w;
-            }
-            if (velComp->predictedPos.y + entityRect->h >= LOGICAL_HEIGHT) {
-                velComp->predictedPos.y = LOGICAL_HEIGHT - entityRect->h;
-            }
-        }
+    ECS ecs = zEngine->ecs;
+    Uint64 movingCount = ecs->groups[GROUP_MOVEMENT].size;
+    MotionBatch motion;
+    allocMotionBatch(&motion, movingCount, &zEngine->frameArena);
+
+    // The workers share the batch, each chunk is gathered, integrated and scattered back while it is still cached
+    // The chunks start on a multiple of 4 entities, which keeps the SIMD kernels' aligned loads valid
+    Uint64 chunkSize = ecs->depGraph->nodes[SYS_VELOCITY]->chunkSize;
+    Uint32 workers = getJobWorkerCount(zEngine->jobs);
+    if (chunkSize == 0) chunkSize = (movingCount + workers - 1) / workers;
+    chunkSize = (chunkSize + 3) & ~(Uint64)3;
+
+    MotionJob job = {.ecs = ecs, .batch = &motion, .deltaTime = deltaTime};
+    parallelFor(zEngine->jobs, movingCount, chunkSize, integrateMotionRange, &job);
 
-        if (HAS_COMPONENT(zEngine->ecs, entitty, COLLISION_COMPONENT)) {
-            CollisionComponent *colComp = NULL;
-            GET_COMPONENT(zEngine->ecs, entitty, COLLISION_COMPONENT, colComp, CollisionComponent);
-            colComp->hitbox->x = velComp->predictedPos.x;
-            colComp->hitbox->y = velComp->predictedPos.y;
-        }
-    }
     propagateSystemDirtiness(zEngine->ecs->depGraph->nodes[SYS_VELOCITY]);
     zEngine->ecs->depGraph->nodes[SYS_VELOCITY]->isDirty = 0;
 }
@@ -552,27 +741,25 @@ void velocitySystem(ZENg zEngine, double_t deltaTime) {
 
 void positionSystem(ZENg zEngine, double_t deltaTime) {
     if (zEngine->ecs->depGraph->nodes[SYS_POSITION]->isDirty == 0) {
-        #ifdef DEBUGSYSTEMS
-            printf("[POSITION SYSTEM] Position system is not dirty\n");
-        #endif
+        LOG_DEBUG(LOG_SYSTEMS, "[POSITION SYSTEM] Position system is not dirty");
         return;
     }
-    ComponentTypeSet posComps = zEngine->ecs->components[POSITION_COMPONENT];
-    #ifdef DEBUGSYSTEMS
-        printf(
-            "[POSITION SYSTEM] Running position system for %lu entities\n",
-            posComps.denseSize
-        );
-    #endif
+    LOG_DEBUG(
+        LOG_SYSTEMS, "[POSITION SYSTEM] Running position system for %lu entities",
+        zEngine->ecs->components[POSITION_COMPONENT].denseSize
+    );
 
-    for (Uint64 i = 0; i  < posComps.denseSize; i++) {
-        PositionComponent *posComp = (PositionComponent *)(posComps.dense[i]);
-        Entity owner = posComps.denseToEntity[i];
+    ECSView view;
+    initView(
+        &view, zEngine->ecs,
+        COMPONENT_MASK(POSITION_COMPONENT) | COMPONENT_MASK(VELOCITY_COMPONENT),
+        COMPONENT_MASK(HEALTH_COMPONENT) | COMPONENT_MASK(DIRECTION_COMPONENT) | COMPONENT_MASK(COLLISION_COMPONENT)
+    );
+    while (viewNext(&view)) {
+        PositionComponent *posComp = VIEW_GET(&view, POSITION_COMPONENT, PositionComponent);
+        VelocityComponent *velComp = VIEW_GET(&view, VELOCITY_COMPONENT, VelocityComponent);
 
         // Common part - to update the real positions
-        if (!HAS_COMPONENT(zEngine->ecs, owner, VELOCITY_COMPONENT)) continue;
-        VelocityComponent *velComp = NULL;
-        GET_COMPONENT(zEngine->ecs, owner, VELOCITY_COMPONENT, velComp, VelocityComponent);
 
         posComp->x = velComp->predictedPos.x;
         posComp->y = velComp->predictedPos.y;
@@ -580,10 +767,10 @@ void positionSystem(ZENg zEngine, double_t deltaTime) {
         // Snapping part
 
         // Only actors can have health (at least for now) and only actors obey the snap rule
-        if (!HAS_COMPONENT(zEngine->ecs, owner, HEALTH_COMPONENT)) continue;
+        if (!VIEW_GET(&view, HEALTH_COMPONENT, HealthComponent)) continue;
 
-        DirectionComponent *dirComp = NULL;
-        GET_COMPONENT(zEngine->ecs, owner, DIRECTION_COMPONENT, dirComp, DirectionComponent);
+        DirectionComponent *dirComp = VIEW_GET(&view, DIRECTION_COMPONENT, DirectionComponent);
+        CollisionComponent *colComp = VIEW_GET(&view, COLLISION_COMPONENT, CollisionComponent);
 
         Uint8 movingX = fabs(dirComp->x) > EPSILON;
         Uint8 movingY = fabs(dirComp->y) > EPSILON;
@@ -594,20 +781,12 @@ void positionSystem(ZENg zEngine, double_t deltaTime) {
         if (movingX && (velComp->prevAxis != AXIS_X)) {
             // Axis change -> snap the position to a tile
             posComp->y = round((posComp->y) / TILE_SIZE) * TILE_SIZE;
-            if (HAS_COMPONENT(zEngine->ecs, owner, COLLISION_COMPONENT)) {
-                CollisionComponent *colComp = NULL;
-                GET_COMPONENT(zEngine->ecs, owner, COLLISION_COMPONENT, colComp, CollisionComponent);
-                colComp->hitbox->y = posComp->y;
-            }
+            if (colComp) colComp->hitbox->y = posComp->y;
             velComp->prevAxis = AXIS_X;
         } else if (movingY && (velComp->prevAxis != AXIS_Y)) {
             // Axis change -> snap the position to a tile
             posComp->x = round((posComp->x) / TILE_SIZE) * TILE_SIZE;
-            if (HAS_COMPONENT(zEngine->ecs, owner, COLLISION_COMPONENT)) {
-                CollisionComponent *colComp = NULL;
-                GET_COMPONENT(zEngine->ecs, owner, COLLISION_COMPONENT, colComp, CollisionComponent);
-                colComp->hitbox->x = posComp->x;
-            }
+            if (colComp) colComp->hitbox->x = posComp->x;
             velComp->prevAxis = AXIS_Y;
         }
     }
@@ -622,25 +801,21 @@ void positionSystem(ZENg zEngine, double_t deltaTime) {
 
 void lifetimeSystem(ZENg zEngine, double_t deltaTime) {
     if (zEngine->ecs->depGraph->nodes[SYS_LIFETIME]->isDirty == 0) {
-        #ifdef DEBUGSYSTEMS
-            printf("[LIFETIME SYSTEM] Lifetime system is not dirty. Something wrong happened\n");
-        #endif
+        LOG_DEBUG(LOG_SYSTEMS, "[LIFETIME SYSTEM] Lifetime system is not dirty. Something wrong happened");
         return;
     }
     ComponentTypeSet *comps = zEngine->ecs->components;
-    #ifdef DEBUGSYSTEMS
-        printf(
-            "[LIFETIME SYSTEM] Running lifetime system for %lu entities\n",
-            comps[LIFETIME_COMPONENT].denseSize
-        );
-    #endif
+    LOG_DEBUG(
+        LOG_SYSTEMS, "[LIFETIME SYSTEM] Running lifetime system for %lu entities",
+        comps[LIFETIME_COMPONENT].denseSize
+    );
 
     for (Uint64 i = 0; i < comps[LIFETIME_COMPONENT].denseSize; i++) {
-        LifetimeComponent *lftComp = (LifetimeComponent *)(comps[LIFETIME_COMPONENT].dense[i]);
+        LifetimeComponent *lftComp = (LifetimeComponent *)DENSE_AT(&comps[LIFETIME_COMPONENT], i);
         lftComp->timeAlive += deltaTime;
         if (lftComp->timeAlive >= lftComp->lifeTime) {
             Entity dirtyOwner = comps[LIFETIME_COMPONENT].denseToEntity[i];
-            deleteEntity(zEngine->ecs, dirtyOwner);
+            deferDeleteEntity(zEngine->ecs, dirtyOwner);
         }
     }
     propagateSystemDirtiness(zEngine->ecs->depGraph->nodes[SYS_LIFETIME]);
@@ -651,63 +826,57 @@ void lifetimeSystem(ZENg zEngine, double_t deltaTime) {
  * =====================================================================================================================
  */
 
-Uint8 checkAndHandleEntityCollisions(ZENg zEngine, Entity entity) {
-    CollisionComponent *colComp = NULL;
-    GET_COMPONENT(zEngine->ecs, entity, COLLISION_COMPONENT, colComp, CollisionComponent);
-    SDL_Rect *hitbox = colComp->hitbox;
+/**
+ * Orders collision pairs by time of impact, then by entities so the order doesn't depend on qsort
+ */
+static int comparePairsByTime(const void *a, const void *b) {
+    const CollisionPair *x = (const CollisionPair *)a, *y = (const CollisionPair *)b;
+    if (x->toi != y->toi) return (x->toi > y->toi) - (x->toi < y->toi);
+    if (x->a != y->a) return (x->a > y->a) - (x->a < y->a);
+    return (x->b > y->b) - (x->b < y->b);
+}
 
-    Uint16 minX = colComp->coverageStart % ARENA_WIDTH;
-    Uint16 minY = colComp->coverageStart / ARENA_WIDTH;
-    Uint16 maxX = colComp->coverageEnd % ARENA_WIDTH;
-    Uint16 maxY = colComp->coverageEnd / ARENA_WIDTH;
+Uint32 handleCollisionPairs(ZENg zEngine) {
+    PROFILE_BEGIN(zone, "handleCollisionPairs");
+    CollisionManager cm = zEngine->collisionMng;
+    Uint32 numCollided = 0;
+
+    // Narrowphase, only the pairs that touch are kept
+    Uint32 touching = 0;
+    Uint8 swept = 0;
+    for (Uint32 i = 0; i < cm->pairCount; i++) {
+        CollisionPair pair = cm->pairs[i];
+        if (!isAlive(zEngine->ecs, pair.a) || !isAlive(zEngine->ecs, pair.b)) continue;
+
+        CollisionComponent *aColComp = NULL, *bColComp = NULL;
+        GET_COMPONENT(zEngine->ecs, pair.a, COLLISION_COMPONENT, aColComp, CollisionComponent);
+        GET_COMPONENT(zEngine->ecs, pair.b, COLLISION_COMPONENT, bColComp, CollisionComponent);
+        if (!getTimeOfImpact(aColComp, bColComp, &pair.toi)) continue;
+        if (pair.toi > 0.0) swept = 1;
+        cm->pairs[touching++] = pair;
+    }
+    cm->pairCount = touching;
 
-#ifdef DEBUGCOLLISIONS
-    printf("[ENTITY COLLISION SYSTEM] Entity %lu spans over (y:%d-%d, x:%d-%d)\n", entity, minY, maxY, minX, maxX);
-#endif
+    // A fast entity hits whatever is first on its way, e.g. a bullet stops at the first of two tanks in a row
+    if (swept) qsort(cm->pairs, cm->pairCount, sizeof(CollisionPair), comparePairsByTime);
 
-    Uint8 numCollided = 0;
+    for (Uint32 i = 0; i < cm->pairCount; i++) {
+        Entity a = cm->pairs[i].a, b = cm->pairs[i].b;
+        // Either may have been deleted by the handler of an earlier pair
+        if (!isAlive(zEngine->ecs, a) || !isAlive(zEngine->ecs, b)) continue;
 
-    for (Int32 y = minY; y <= maxY; y++) {
-        for (Int32 x = minX; x <= maxX; x++) {
-            size_t neighIdx = COL_GRID_INDEX(zEngine->collisionMng, x, y);
-            GridCell *neighCell = &zEngine->collisionMng->spatialGrid[neighIdx];
-            SDL_Rect neighCellRect = {
-                .x = x * TILE_SIZE,
-                .y = y * TILE_SIZE,
-                .w = TILE_SIZE,
-                .h = TILE_SIZE
-            };
+        CollisionComponent *aColComp = NULL, *bColComp = NULL;
+        GET_COMPONENT(zEngine->ecs, a, COLLISION_COMPONENT, aColComp, CollisionComponent);
+        GET_COMPONENT(zEngine->ecs, b, COLLISION_COMPONENT, bColComp, CollisionComponent);
 
-            if (SDL_HasIntersection(hitbox, &neighCellRect)) {
-                // Search for colliding entities in the collided tile
-                for (int i = 0; i < neighCell->entityCount; i++) {
-                    Entity susColEntity = neighCell->entities[i];
-                    if (susColEntity == entity) continue;
-
-                    if (!HAS_COMPONENT(zEngine->ecs, susColEntity, COLLISION_COMPONENT)) continue;
-                    CollisionComponent *susEColComp = NULL;
-                    GET_COMPONENT(zEngine->ecs, susColEntity, COLLISION_COMPONENT, susEColComp, CollisionComponent);
-                    if (SDL_HasIntersection(hitbox, susEColComp->hitbox)) {
-                        // Call the appropriate handler function
-#ifdef DEBUGCOLLISIONS
-                        printf("[ENTITY COLLISION SYSTEM] Attempting to call a collision handler for entities");
-                        printf(" %lu(role %d) vs %lu(role %d)...\n", entity, colComp->role, susColEntity, susEColComp->role);
-#endif
-                        if (zEngine->collisionMng->eVsEHandlers[colComp->role][susEColComp->role]) {
-                            normalizeRoles(&entity, &susColEntity, &colComp, &susEColComp);
-                            zEngine->collisionMng->eVsEHandlers[colComp->role][susEColComp->role](
-                                zEngine, entity, susColEntity
-                            );
-                        }
-                        numCollided++;
-
-                        // Prevent further iterations if the entity was deleted as an outcome of the collision handling
-                        if (!HAS_COMPONENT(zEngine->ecs, entity, ACTIVE_TAG_COMPONENT)) return numCollided;
-                    }
-                }
-            }
-        }
+        LOG_TRACE(
+            LOG_COLLISIONS, "[ENTITY COLLISION SYSTEM] Calling the collision handler for entities"
+            " %lu(role %d) vs %lu(role %d)", a, aColComp->role, b, bColComp->role
+        );
+        cm->eVsEHandlers[aColComp->role][bColComp->role](zEngine, a, b);
+        numCollided++;
     }
+    PROFILE_END(zone);
     return numCollided;
 }
 
@@ -717,22 +886,23 @@ Uint8 checkAndHandleEntityCollisions(ZENg zEngine, Entity entity) {
 
 void entityCollisionSystem(ZENg zEngine, double_t deltaTime) {
     if (zEngine->ecs->depGraph->nodes[SYS_ENTITY_COLLISIONS]->isDirty == 0) {
-        #ifdef DEBUGSYSTEMS
-            printf("[ENTITY COLLISION SYSTEM] Entity collision system is not dirty\n");
-        #endif
+        LOG_DEBUG(LOG_SYSTEMS, "[ENTITY COLLISION SYSTEM] Entity collision system is not dirty");
         return;
     }
     ComponentTypeSet *colComps = &zEngine->ecs->components[COLLISION_COMPONENT];
 
-    #ifdef DEBUGSYSTEMS
-        printf(
-            "[ENTITY COLLISION SYSTEM] Running entity collision system for %lu entities\n",
-            colComps->denseSize
-        );
-    #endif
+    LOG_DEBUG(
+        LOG_SYSTEMS, "[ENTITY COLLISION SYSTEM] Running entity collision system for %lu entities",
+        colComps->denseSize
+    );
+
+    // The world collisions are resolved, so the hitboxes are where the entities end the tick
+    if (zEngine->collisionMng->broadphase == BROADPHASE_REBUILD) {
+        rebuildFlatGrid(zEngine->collisionMng, zEngine->ecs, zEngine->jobs);
+    }
 
     for (Uint64 i = 0; i < colComps->denseSize; i++) {
-        CollisionComponent *colComp = (CollisionComponent *)(colComps->dense[i]);
+        CollisionComponent *colComp = (CollisionComponent *)DENSE_AT(colComps, i);
         Entity owner = colComps->denseToEntity[i];
 
         // If a bullet hits the arena edge - remove it
@@ -741,14 +911,18 @@ void entityCollisionSystem(ZENg zEngine, double_t deltaTime) {
             || colComp->hitbox->x + colComp->hitbox->w >= LOGICAL_WIDTH
             || colComp->hitbox->y + colComp->hitbox->h >= LOGICAL_HEIGHT)
         ) {
-            deleteEntity(zEngine->ecs, owner);
-            continue;  // skip to the next entity
+            deferDeleteEntity(zEngine->ecs, owner);
         }
-
-        // Check and handle collisions with other entities in the vicinity (in the spatial grid)
-        Uint8 numCollided = checkAndHandleEntityCollisions(zEngine, owner);
     }
 
+    // Every pair sharing a cell is tested once, then its handler runs once
+    findCollisionPairs(zEngine->collisionMng, zEngine->ecs);
+    Uint32 numCollided = handleCollisionPairs(zEngine);
+    LOG_DEBUG(LOG_SYSTEMS, "[ENTITY COLLISION SYSTEM] %u collisions handled", numCollided);
+
+    // The fast entities that made it to a wall hit it now
+    resolveSweptEntities(zEngine);
+
     propagateSystemDirtiness(zEngine->ecs->depGraph->nodes[SYS_ENTITY_COLLISIONS]);
     zEngine->ecs->depGraph->nodes[SYS_ENTITY_COLLISIONS]->isDirty = 0;
 }
@@ -761,46 +935,41 @@ Uint8 checkAndHandleWorldCollisions(ZENg zEngine, Entity entity) {
     CollisionComponent *colComp = NULL;
     GET_COMPONENT(zEngine->ecs, entity, COLLISION_COMPONENT, colComp, CollisionComponent);
     SDL_Rect *hitbox = colComp->hitbox;
-
-    // For entities bigger than one tile. consider the base the top-left tile
-    Uint32 tileIdx = worldToTile((PositionComponent){.x = hitbox->x, .y = hitbox->y});
-    Uint32 tileX = tileIdx % ARENA_WIDTH;
-    Uint32 tileY = tileIdx / ARENA_WIDTH;
-
-    int entityWidth = hitbox->w / TILE_SIZE;
-    int entityHeight = hitbox->h / TILE_SIZE;
-    Int32 dxMax = entityWidth + 1;
-    Int32 dyMax = entityHeight + 1;
+    entityVsWorldHandler handler = zEngine->collisionMng->eVsWHandlers[colComp->role];
+    if (!handler || hitbox->w <= 0 || hitbox->h <= 0) return 0;
+    const Uint64 *layer = zEngine->map->layers[zEngine->collisionMng->eVsWLayers[colComp->role]];
+
+    // The tiles the hitbox overlaps, touching one's edge doesn't count
+    Int32 minCol = (Int32)floor((double_t)hitbox->x / TILE_SIZE);
+    Int32 maxCol = (Int32)floor((double_t)(hitbox->x + hitbox->w - 1) / TILE_SIZE);
+    Int32 minRow = (Int32)floor((double_t)hitbox->y / TILE_SIZE);
+    Int32 maxRow = (Int32)floor((double_t)(hitbox->y + hitbox->h - 1) / TILE_SIZE);
+    if (minRow < 0) minRow = 0;
+    if (maxRow >= ARENA_HEIGHT) maxRow = ARENA_HEIGHT - 1;
+    Uint64 cols = getColumnsMask(minCol, maxCol);
 
     Uint8 numCollided = 0;
 
-    for (Int32 dy = -1; dy <= dyMax; dy++) {
-        Uint32 neighY = (Int32)tileY + dy;
-        for (Int32 dx = -1; dx <= dxMax; dx++) {
-            Uint32 neighX = (Int32)tileX + dx;
-
-            if (neighX < 0 || neighX >= ARENA_WIDTH || neighY < 0 || neighY >= ARENA_HEIGHT) continue;
-            Tile *neighTile = &zEngine->map->tiles[neighY][neighX];
-            if (neighTile->type == TILE_EMPTY) continue;
-            SDL_Rect neighTileRect = {
-                .x = neighX * TILE_SIZE,
-                .y = neighY * TILE_SIZE,
-                .w = TILE_SIZE,
-                .h = TILE_SIZE
-            };
+    // A word-wide AND per row clears nearly every entity, only the tiles of the layer are looked at one by one
+    for (Int32 row = minRow; row <= maxRow; row++) {
+        Uint64 hits = layer[row] & cols;
+        for (Uint32 col = 0; hits; col++, hits >>= 1) {
+            if (!(hits & 1)) continue;
 
-            if (SDL_HasIntersection(hitbox, &neighTileRect)) {
-#ifdef DEBUGCOLLISIONS
-                printf("[WORLD COLLISION SYSTEM] Attempting to call handler function for entity");
-                printf(" %lu vs tile type %d\n", entity, neighTile->type);
-#endif
-                if (zEngine->collisionMng->eVsWHandlers[colComp->role])
-                    zEngine->collisionMng->eVsWHandlers[colComp->role](zEngine, entity, neighTile);
-                numCollided++;
+            // An earlier handler may have pushed the hitbox off this tile
+            SDL_Rect tileRect = {.x = col * TILE_SIZE, .y = row * TILE_SIZE, .w = TILE_SIZE, .h = TILE_SIZE};
+            if (!SDL_HasIntersection(hitbox, &tileRect)) continue;
 
-                // Prevent further iterations if the entity was deleted as an outcome of collision handling
-                if (!HAS_COMPONENT(zEngine->ecs, entity, ACTIVE_TAG_COMPONENT)) return numCollided;
-            }
+            Tile *tile = &zEngine->map->tiles[row][col];
+            LOG_TRACE(
+                LOG_COLLISIONS, "[WORLD COLLISION SYSTEM] Attempting to call handler function for entity"
+                " %lu vs tile type %d", entity, tile->type
+            );
+            handler(zEngine, entity, tile);
+            numCollided++;
+
+            // Prevent further iterations if the entity was deleted as an outcome of collision handling
+            if (!isAlive(zEngine->ecs, entity)) return numCollided;
         }
     }
     return numCollided;
@@ -812,34 +981,32 @@ Uint8 checkAndHandleWorldCollisions(ZENg zEngine, Entity entity) {
 
 void worldCollisionSystem(ZENg zEngine, double_t deltaTime) {
     if (zEngine->ecs->depGraph->nodes[SYS_WORLD_COLLISIONS]->isDirty == 0) {
-        #ifdef DEBUGSYSTEMS
-            printf("[WORLD COLLISION SYSTEM] World collision system is not dirty\n");
-        #endif
+        LOG_DEBUG(LOG_SYSTEMS, "[WORLD COLLISION SYSTEM] World collision system is not dirty");
         return;
     }
 
     ComponentTypeSet *colComps = &zEngine->ecs->components[COLLISION_COMPONENT];
 
-    #ifdef DEBUGSYSTEMS
-        printf(
-            "[WORLD COLLISION SYSTEM] Running world collision system for %lu entities\n",
-            colComps->denseSize
-        );
-    #endif
+    LOG_DEBUG(
+        LOG_SYSTEMS, "[WORLD COLLISION SYSTEM] Running world collision system for %lu entities",
+        colComps->denseSize
+    );
 
-    for (Uint64 i = 0; i < colComps->denseSize; i++) {
-        CollisionComponent *colComp = colComps->dense[i];
+    ECS ecs = zEngine->ecs;
+    for (Uint64 i = 0; i < ecs->groups[GROUP_MOVEMENT].size; i++) {
         Entity e = colComps->denseToEntity[i];
-
-        if (!HAS_COMPONENT(zEngine->ecs, e, VELOCITY_COMPONENT)) continue;  // Skip entities without velocity component
-        VelocityComponent *velComp = NULL;
-        GET_COMPONENT(zEngine->ecs, e, VELOCITY_COMPONENT, velComp, VelocityComponent);
-
-        Uint8 numCollided = checkAndHandleWorldCollisions(zEngine, e);
+        CollisionComponent *colComp = GROUP_GET(ecs, COLLISION_COMPONENT, i, CollisionComponent);
+        if (colComp->isFast) {
+            // Could skip over a wall between two ticks, so it is swept along its path instead
+            PositionComponent *posComp = GROUP_GET(ecs, POSITION_COMPONENT, i, PositionComponent);
+            VelocityComponent *velComp = GROUP_GET(ecs, VELOCITY_COMPONENT, i, VelocityComponent);
+            sweepFastEntity(zEngine, e, posComp, velComp, colComp);
+        } else checkAndHandleWorldCollisions(zEngine, e);
 
         // Between world collisions and entity collisions make sure the entities' spatial grid memberships are valid
-        if (!HAS_COMPONENT(zEngine->ecs, e, ACTIVE_TAG_COMPONENT)) continue;
-        updateGridMembership(zEngine->collisionMng, e, velComp, colComp);
+        // The flat grid is rebuilt by the entity collision system instead
+        if (!isAlive(ecs, e) || zEngine->collisionMng->broadphase != BROADPHASE_INCREMENTAL) continue;
+        updateGridMembership(zEngine->collisionMng, e, colComp);
     }
 
     propagateSystemDirtiness(zEngine->ecs->depGraph->nodes[SYS_WORLD_COLLISIONS]);
@@ -853,12 +1020,10 @@ void worldCollisionSystem(ZENg zEngine, double_t deltaTime) {
 
 void healthSystem(ZENg zEngine, double_t deltaTime) {
     ComponentTypeSet *comps = zEngine->ecs->components;
-    #ifdef DEBUGSYSTEMS
-        printf(
-            "[HEALTH SYSTEM] There are %lu dirty health components\n",
-            comps[HEALTH_COMPONENT].dirtyCount
-        );
-    #endif
+    LOG_DEBUG(
+        LOG_SYSTEMS, "[HEALTH SYSTEM] There are %lu dirty health components",
+        comps[HEALTH_COMPONENT].dirtyCount
+    );
 
     if (comps[HEALTH_COMPONENT].dirtyCount != 0) {
         propagateSystemDirtiness(zEngine->ecs->depGraph->nodes[SYS_HEALTH]);
@@ -866,10 +1031,15 @@ void healthSystem(ZENg zEngine, double_t deltaTime) {
     
     while (comps[HEALTH_COMPONENT].dirtyCount > 0) {
         Entity ownerID = comps[HEALTH_COMPONENT].dirtyEntities[0];
+        if (!isAlive(zEngine->ecs, ownerID)) {
+            // Died since it was marked, e.g. its lifetime expired
+            unmarkComponentDirty(zEngine->ecs, HEALTH_COMPONENT);
+            continue;
+        }
         HealthComponent *helfComp = NULL;
         GET_COMPONENT(zEngine->ecs, ownerID, HEALTH_COMPONENT, helfComp, HealthComponent);
 
-        if (helfComp->currentHealth <= 0) deleteEntity(zEngine->ecs, ownerID);
+        if (helfComp->currentHealth <= 0) deferDeleteEntity(zEngine->ecs, ownerID);
         unmarkComponentDirty(zEngine->ecs, HEALTH_COMPONENT);
     }
 }
@@ -878,32 +1048,50 @@ void healthSystem(ZENg zEngine, double_t deltaTime) {
  * =====================================================================================================================
  */
 
-void weaponSystem(ZENg zEngine, double_t deltaTime) {
-    if (zEngine->ecs->depGraph->nodes[SYS_WEAPONS]->isDirty == 0) {
-        #ifdef DEBUGSYSTEMS
-            printf("[WEAPON SYSTEM] Weapon system is not dirty\n");
-        #endif
-        return;
-    }
-    ComponentTypeSet weapComps = zEngine->ecs->components[WEAPON_COMPONENT];
-    #ifdef DEBUGSYSTEMS
-        printf(
-            "[WEAPON SYSTEM] Running weapon system for %lu entities\n",
-            weapComps.denseSize
-        );
-    #endif
+/**
+ * Shared state of the weapon system's parallel loop
+ */
+typedef struct {
+    ComponentTypeSet *weapComps;  // The weapon components
+    double_t deltaTime;  // Time since the last frame
+} WeaponJob;
 
-    for (Uint64 i = 0; i < weapComps.denseSize; i++) {
-        WeaponComponent *currWeapon = (WeaponComponent *)(weapComps.dense[i]);
+/**
+ * Advances the cooldowns of a slice of the weapons
+ * @param data the WeaponJob
+ * @param start index of the first weapon in the dense array
+ * @param end index past the last weapon in the dense array
+ */
+static void reloadWeaponRange(void *data, Uint64 start, Uint64 end) {
+    WeaponJob *job = data;
+    for (Uint64 i = start; i < end; i++) {
+        WeaponComponent *currWeapon = (WeaponComponent *)DENSE_AT(job->weapComps, i);
 
         // Prevent overflow
         if (currWeapon->timeSinceUse > (1 / currWeapon->fireRate + EPSILON)) {
             continue;
         }
-        currWeapon->timeSinceUse += deltaTime;
+        currWeapon->timeSinceUse += job->deltaTime;
     }
-    propagateSystemDirtiness(zEngine->ecs->depGraph->nodes[SYS_TRANSFORM]);
-    // zEngine->ecs->depGraph->nodes[SYS_TRANSFORM]->isDirty = 0;
+}
+
+void weaponSystem(ZENg zEngine, double_t deltaTime) {
+    if (zEngine->ecs->depGraph->nodes[SYS_WEAPONS]->isDirty == 0) {
+        LOG_DEBUG(LOG_SYSTEMS, "[WEAPON SYSTEM] Weapon system is not dirty");
+        return;
+    }
+    ComponentTypeSet weapComps = zEngine->ecs->components[WEAPON_COMPONENT];
+    LOG_DEBUG(
+        LOG_SYSTEMS, "[WEAPON SYSTEM] Running weapon system for %lu entities",
+        weapComps.denseSize
+    );
+
+    WeaponJob job = {.weapComps = &weapComps, .deltaTime = deltaTime};
+    parallelFor(
+        zEngine->jobs, weapComps.denseSize, zEngine->ecs->depGraph->nodes[SYS_WEAPONS]->chunkSize,
+        reloadWeaponRange, &job
+    );
+    propagateSystemDirtiness(zEngine->ecs->depGraph->nodes[SYS_WEAPONS]);
 }
 
 /**
@@ -912,37 +1100,33 @@ void weaponSystem(ZENg zEngine, double_t deltaTime) {
 
 void transformSystem(ZENg zEngine, double_t deltaTime) {
     if (zEngine->ecs->depGraph->nodes[SYS_TRANSFORM]->isDirty == 0) {
-        #ifdef DEBUGSYSTEMS
-            printf("[TRANSFORM SYSTEM] Transform system is not dirty\n");
-        #endif
+        LOG_DEBUG(LOG_SYSTEMS, "[TRANSFORM SYSTEM] Transform system is not dirty");
         return;
     }
-    ComponentTypeSet posComps = zEngine->ecs->components[POSITION_COMPONENT];
-    #ifdef DEBUGSYSTEMS
-        printf(
-            "[TRANSFORM SYSTEM] Running transform system for %lu entities\n",
-            posComps.denseSize
-        );
-    #endif
-
-    // iterate through all entities with POSITION_COMPONENT and update their rendered textures
-    for (Uint64 i = 0; i < posComps.denseSize; i++) {
-        PositionComponent *posComp = (PositionComponent *)(posComps.dense[i]);
-        Entity entitty = posComps.denseToEntity[i];
-
-        if ((zEngine->ecs->componentsFlags[entitty] & (1 << RENDER_COMPONENT)) == 0) continue;
-
-        RenderComponent *renderComp = NULL;
-        GET_COMPONENT(zEngine->ecs, entitty, RENDER_COMPONENT, renderComp, RenderComponent);
+    LOG_DEBUG(
+        LOG_SYSTEMS, "[TRANSFORM SYSTEM] Running transform system for %lu entities",
+        zEngine->ecs->components[POSITION_COMPONENT].denseSize
+    );
 
-        renderComp->destRect->x = (int)posComp->x;
-        renderComp->destRect->y = (int)posComp->y;
-        
-        markComponentDirty(zEngine->ecs, entitty, RENDER_COMPONENT);
+    // iterate through all moving entities and update their rendered textures
+    // They are drawn between where the last tick found them and where it left them
+    ECS ecs = zEngine->ecs;
+    double_t alpha = zEngine->timestep.alpha;
+    Uint8 settled = 1;
+    for (Uint64 i = 0; i < ecs->groups[GROUP_MOVEMENT].size; i++) {
+        PositionComponent *posComp = GROUP_GET(ecs, POSITION_COMPONENT, i, PositionComponent);
+        PositionComponent prevPos = GROUP_GET(ecs, VELOCITY_COMPONENT, i, VelocityComponent)->prevPos;
+        RenderComponent *renderComp = GROUP_GET(ecs, RENDER_COMPONENT, i, RenderComponent);
+
+        if (prevPos.x != posComp->x || prevPos.y != posComp->y) settled = 0;
+        renderComp->destRect->x = (int)(prevPos.x + (posComp->x - prevPos.x) * alpha);
+        renderComp->destRect->y = (int)(prevPos.y + (posComp->y - prevPos.y) * alpha);
     }
 
+    // The render system redraws everything, so it only needs to know the rects moved, not which ones
     propagateSystemDirtiness(zEngine->ecs->depGraph->nodes[SYS_TRANSFORM]);
-    zEngine->ecs->depGraph->nodes[SYS_TRANSFORM]->isDirty = 0;
+    // The interpolated rects change every frame until the entities stop and are drawn where they ended up
+    if (settled) zEngine->ecs->depGraph->nodes[SYS_TRANSFORM]->isDirty = 0;
 }
 
 /**
@@ -991,16 +1175,12 @@ void UIdebugRenderNode(SDL_Renderer *rdr, UIManager uiManager, UINode *node) {
 
 void renderSystem(ZENg zEngine, double_t deltaTime) {
     if (zEngine->ecs->depGraph->nodes[SYS_RENDER]->isDirty == 0) {
-        #ifdef DEBUGSYSTEMS
-            printf("[RENDER SYSTEM] Render system is not dirty. Not good.\n");
-        #endif
+        LOG_DEBUG(LOG_SYSTEMS, "[RENDER SYSTEM] Render system is not dirty. Not good.");
     }
     ComponentTypeSet rdrComps = zEngine->ecs->components[RENDER_COMPONENT];
-    #ifdef DEBUGSYSTEMS
-        Uint64 renderCount = rdrComps.denseSize;
-        printf("[RENDER SYSTEM] Running render system for %lu entities\n", renderCount);
-    #endif
+    LOG_DEBUG(LOG_SYSTEMS, "[RENDER SYSTEM] Running render system for %lu entities", rdrComps.denseSize);
 
+    zEngine->display->drawCalls = 0;
     GameState *currState = getCurrState(zEngine->stateMng);
     if (currState->type == STATE_PLAYING || currState->type == STATE_PAUSED) {
         renderArena(zEngine);
@@ -1011,7 +1191,7 @@ void renderSystem(ZENg zEngine, double_t deltaTime) {
     #endif
 
     for (Uint64 i = 0; i < rdrComps.denseSize; i++) {
-        RenderComponent *render = (RenderComponent *)(rdrComps.dense[i]);
+        RenderComponent *render = (RenderComponent *)DENSE_AT(&rdrComps, i);
         Entity owner = rdrComps.denseToEntity[i];
 
         if (!render || !render->destRect || !render->active) continue;
@@ -1026,6 +1206,7 @@ void renderSystem(ZENg zEngine, double_t deltaTime) {
         SDL_RenderCopyEx(
             zEngine->display->renderer, render->texture, NULL, render->destRect, angle, NULL, SDL_FLIP_NONE
         );
+        zEngine->display->drawCalls++;
     }
     
     #ifdef DEBUGCOLLISIONS
@@ -1061,9 +1242,7 @@ void renderSystem(ZENg zEngine, double_t deltaTime) {
  */
 
 void uiSystem(ZENg zEngine, double_t deltaTime) {
-    #ifdef DEBUGSYSTEMS
-        printf("[UI SYSTEM] There are %lu dirty UI components\n", zEngine->uiManager->dirtyCount);
-    #endif
+    LOG_DEBUG(LOG_SYSTEMS, "[UI SYSTEM] There are %lu dirty UI components", zEngine->uiManager->dirtyCount);
     
     while (zEngine->uiManager->dirtyCount > 0) {
         UINode *dirtyNode = zEngine->uiManager->dirtyNodes[0];
@@ -1093,6 +1272,8 @@ void uiSystem(ZENg zEngine, double_t deltaTime) {
         }
         UIunmarkNodeDirty(zEngine->uiManager);
     }
+
+    updatePerfOverlay(zEngine, deltaTime);
 }
 
 /**
@@ -1122,6 +1303,7 @@ void renderArena(ZENg zEngine) {
                     NULL,
                     &tileRect
                 );
+                zEngine->display->drawCalls++;
             }
         }
     }
@@ -1162,7 +1344,7 @@ void renderDebugCollision(ZENg zEngine) {
     SDL_SetRenderDrawBlendMode(zEngine->display->renderer, SDL_BLENDMODE_BLEND);
 
     for (Uint64 i = 0; i < colComps.denseSize; i++) {
-        CollisionComponent *colComp = (CollisionComponent *)(colComps.dense[i]);
+        CollisionComponent *colComp = (CollisionComponent *)DENSE_AT(&colComps, i);
         if (!colComp || !colComp->hitbox) THROW_ERROR_AND_CONTINUE("Invalid colComp in renderDebugCollision\n");
 
         // Red
@@ -1220,13 +1402,220 @@ void renderDebugCollision(ZENg zEngine) {
  * =====================================================================================================================
  */
 
-void runSystems(ZENg zEngine, double_t deltaTime) {
-    for (Uint64 i = 0; i < zEngine->ecs->depGraph->nodeCount; i++) {
-        SystemNode *curr = zEngine->ecs->depGraph->sortedNodes[i];
-        if (curr->isActive) {
-            curr->update(zEngine, deltaTime);
+/**
+ * A system queued on the job system
+ */
+typedef struct {
+    ZENg zEngine;  // Engine passed to the system
+    SystemNode *node;  // The system to run
+    double_t deltaTime;  // Time step passed to the system
+} SystemJob;
+
+/**
+ * Runs a system inside its profiler zone
+ * @param zEngine pointer to the engine
+ * @param node the system to run
+ * @param deltaTime time step passed to the system
+ */
+static void runSystem(ZENg zEngine, SystemNode *node, double_t deltaTime) {
+    PROFILE_BEGIN_STAT(zone, systemNames[node->type], node->type);
+    Uint64 start = SDL_GetPerformanceCounter();
+    node->update(zEngine, deltaTime);
+    node->lastRunMs = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    PROFILE_END(zone);
+}
+
+/**
+ * Runs a queued system
+ * @param data the SystemJob
+ */
+static void runSystemJob(void *data) {
+    SystemJob *job = data;
+    runSystem(job->zEngine, job->node, job->deltaTime);
+}
+
+/**
+ * Runs a batch of non-conflicting systems on the job system and waits for all of them
+ * @param zEngine pointer to the engine
+ * @param batch array of systems, no two of them may conflict
+ * @param count number of systems in the batch
+ * @param deltaTime time since the last frame in seconds
+ * @note the systems touching ACCESS_MAIN_THREAD run on the calling thread, which then helps with the rest
+ */
+static void runSystemBatch(ZENg zEngine, SystemNode **batch, Uint32 count, double_t deltaTime) {
+    // Nothing to share, skip the hand-off
+    if (count == 1 || getJobWorkerCount(zEngine->jobs) == 1) {
+        for (Uint32 i = 0; i < count; i++) runSystem(zEngine, batch[i], deltaTime);
+        return;
+    }
+
+    SystemJob jobs[SYS_COUNT];
+    JobCounter counter = {0};
+    for (Uint32 i = 0; i < count; i++) {
+        if (batch[i]->writes & ACCESS_MASK(ACCESS_MAIN_THREAD)) continue;
+        jobs[i] = (SystemJob) {.zEngine = zEngine, .node = batch[i], .deltaTime = deltaTime};
+        submitJob(zEngine->jobs, runSystemJob, &jobs[i], &counter);
+    }
+
+    for (Uint32 i = 0; i < count; i++) {
+        if (batch[i]->writes & ACCESS_MASK(ACCESS_MAIN_THREAD)) runSystem(zEngine, batch[i], deltaTime);
+    }
+    waitForJobs(zEngine->jobs, &counter);
+}
+
+void runSystems(ZENg zEngine, SystemPhase phase, double_t deltaTime) {
+    DependencyGraph *graph = zEngine->ecs->depGraph;
+    ECS ecs = zEngine->ecs;
+
+    // Nothing is drawn without a display, so the renderer, UI and the interpolation feeding them stay off
+    if (zEngine->headless && phase == PHASE_PRESENTATION) return;
+
+    if (phase == PHASE_SIMULATION) {
+        // The positions before the tick are what the frames rendered until the next one interpolate from
+        for (Uint64 i = 0; i < ecs->groups[GROUP_MOVEMENT].size; i++) {
+            GROUP_GET(ecs, VELOCITY_COMPONENT, i, VelocityComponent)->prevPos =
+                *GROUP_GET(ecs, POSITION_COMPONENT, i, PositionComponent);
+        }
+    }
+
+    for (Uint8 level = 0; level < graph->levelCount; level++) {
+        // Split the level's active systems into batches of systems that don't conflict with each other
+        SystemNode *batches[SYS_COUNT][SYS_COUNT];
+        Uint32 batchSizes[SYS_COUNT] = {0};
+        Uint32 batchCount = 0;
+
+        for (Uint64 i = 0; i < graph->nodeCount; i++) {
+            SystemNode *curr = graph->sortedNodes[i];
+            if (!curr->isActive || curr->level != level || curr->phase != phase) continue;
+
+            Uint32 b = 0;
+            for (; b < batchCount; b++) {
+                Uint8 conflicts = 0;
+                for (Uint32 j = 0; j < batchSizes[b] && !conflicts; j++) {
+                    conflicts = systemsConflict(curr, batches[b][j]);
+                }
+                if (!conflicts) break;
+            }
+            if (b == batchCount) batchCount++;
+            batches[b][batchSizes[b]++] = curr;
+        }
+
+        for (Uint32 b = 0; b < batchCount; b++) {
+            runSystemBatch(zEngine, batches[b], batchSizes[b], deltaTime);
+            // Sync point, the structural changes the batch recorded are applied before the next one runs
+            flushCommands(zEngine->ecs);
+        }
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void simulateTick(ZENg zEngine) {
+    GameState *currState = getCurrState(zEngine->stateMng);
+    if (currState && currState->handleInput) currState->handleInput(zEngine);
+    runSystems(zEngine, PHASE_SIMULATION, zEngine->timestep.tickLength);
+
+    // Only the match is recorded, the ticks spent in menus or paused don't change the world
+    InputReplay replay = zEngine->inputMng->replay;
+    if (replay && currState && currState->type == STATE_PLAYING) {
+        // The recorded keyframes hold the whole world, seeking restores them
+        Uint32 snapshotSize = 0;
+        Uint8 *snapshot = isKeyframeDue(replay) ? saveWorldSnapshot(zEngine, &snapshotSize) : NULL;
+        replayEndTick(
+            replay, getWorldChecksum(zEngine->ecs), (Uint32)zEngine->ecs->entityCount, snapshot, snapshotSize
+        );
+        free(snapshot);
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 playReplay(ZENg zEngine, const char *filePath, Uint32 seekTick) {
+    if (!zEngine || !filePath) THROW_ERROR_AND_RETURN("NULL argument in playReplay", 0);
+
+    InputReplay replay = loadReplay(filePath);
+    if (!replay) return 0;
+
+    // The recorded input only makes sense at the tick rate it was recorded at
+    setTickRate(&zEngine->timestep, replay->tickRate);
+
+    GameState *currState = getCurrState(zEngine->stateMng);
+    if (!currState || currState->type != STATE_PLAYING) mMenuToPlay(zEngine, NULL);
+    zEngine->inputMng->replay = replay;
+
+    if (seekTick > 0) seekReplay(zEngine, seekTick);
+    return 1;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void seekReplay(ZENg zEngine, Uint32 tick) {
+    InputReplay replay = zEngine ? zEngine->inputMng->replay : NULL;
+    if (!replay || replay->mode != REPLAY_PLAYBACK) THROW_ERROR_AND_RETURN_VOID("No replay is playing, cannot seek");
+
+    GameState *currState = getCurrState(zEngine->stateMng);
+    if (!currState || currState->type != STATE_PLAYING) THROW_ERROR_AND_RETURN_VOID("Seeking needs the play state");
+
+    // Playback lands on the keyframe at or before the tick, where the world can be checked
+    Uint32 target = tick < replay->endTick ? tick : replay->endTick;
+    target -= target % replay->keyframeInterval;
+
+    // The world comes back from the last snapshot before the target, the ticks up to the target are simulated
+    Uint64 start = SDL_GetPerformanceCounter();
+    const ReplayKeyframe *keyframe = findReplayKeyframe(replay, target);
+    if (keyframe && restoreWorldSnapshot(zEngine, keyframe->snapshot, keyframe->snapshotSize)) {
+        jumpToKeyframe(replay, keyframe);
+    } else {
+        // No snapshot that early, the match restarts and the recorded input is simulated again from the start
+        zEngine->inputMng->replay = NULL;  // restarting the state would end the playback
+        currState->onExit(zEngine);
+        currState->onEnter(zEngine);
+        zEngine->inputMng->replay = replay;
+        rewindReplay(replay);
+    }
+
+    while (replay->tick < target) {
+        resetFrameArena(&zEngine->frameArena);
+        simulateTick(zEngine);
+    }
+    double_t seconds = (double_t)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    printf("Seeked to tick %u in %.3f s\n", replay->tick, seconds);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+double_t runHeadless(ZENg zEngine, Uint64 ticks) {
+    if (!zEngine || !zEngine->headless) THROW_ERROR_AND_RETURN("runHeadless needs a headless engine", 0.0);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (Uint64 i = 0; i < ticks; i++) {
+        // A replay only lasts as long as the recording
+        if (isReplayFinished(zEngine->inputMng->replay)) {
+            ticks = i;
+            break;
         }
+        resetFrameArena(&zEngine->frameArena);
+
+        simulateTick(zEngine);
+        zEngine->timestep.tickCount++;
     }
+    double_t seconds = (double_t)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    double_t ticksPerSecond = seconds > 0.0 ? ticks / seconds : 0.0;
+
+    printf(
+        "Simulated %lu ticks of %.2f ms in %.3f s: %.1f ticks/s, %lu entities, %lu projectiles\n",
+        ticks, zEngine->timestep.tickLength * 1000.0, seconds, ticksPerSecond,
+        zEngine->ecs->entityCount, zEngine->ecs->components[PROJECTILE_COMPONENT].denseSize
+    );
+    return ticksPerSecond;
 }
 
 /**
@@ -1236,6 +1625,8 @@ void runSystems(ZENg zEngine, double_t deltaTime) {
 void saveSettings(ZENg zEngine, const char *filePath) {
     saveKeyBindings(zEngine->inputMng, filePath);
     saveDisplaySettings(zEngine->display, filePath);
+    saveTimingSettings(&zEngine->timestep, filePath);
+    saveLogSettings(filePath);
     printf("Settings saved to %s\n", filePath);
 }
 
@@ -1244,23 +1635,46 @@ void saveSettings(ZENg zEngine, const char *filePath) {
  */
 
 void destroyEngine(ZENg *zEngine) {
-    saveSettings((*zEngine), "settings.ini");
+    if ((*zEngine)->headless) {
+        // Nothing could have changed the settings, and the level is still up as no menu was returned to
+        GameState *playState = getCurrState((*zEngine)->stateMng);
+        if (playState && playState->onExit) playState->onExit(*zEngine);
+    } else saveSettings((*zEngine), "settings.ini");
+    freeReplay(&(*zEngine)->inputMng->replay);  // quitting mid-match still ends the recording properly
     free((*zEngine)->inputMng);
 
     freeResourceManager(&(*zEngine)->resources);
     freePrefabsManager(&(*zEngine)->prefabs);
 
+    // The workers go first, they run the systems which work on the ECS
+    freeJobSystem(&(*zEngine)->jobs);
     freeECS((*zEngine)->ecs);
 
+    #ifdef PROFILER
+        // The workers are gone, nothing records zones anymore
+        dumpProfile("profile.json");
+        freeProfiler();
+    #endif
+
+    LOG_DEBUG(
+        LOG_CORE, "Frame arena: peak %lu bytes, average %.1f bytes over %lu frames, %lu frames fell back on the heap",
+        (*zEngine)->frameArena.peak, getFrameArenaAverage(&(*zEngine)->frameArena),
+        (*zEngine)->frameArena.frameCount, (*zEngine)->frameArena.overflowFrames
+    );
+    freeFrameArena(&(*zEngine)->frameArena);
+
     // Free the UI tree
     UIclose((*zEngine)->uiManager);
 
     free((*zEngine)->stateMng->states[0]);  // free the main menu state
     free((*zEngine)->stateMng);
 
-    SDL_DestroyRenderer((*zEngine)->display->renderer);
-    SDL_DestroyWindow((*zEngine)->display->window);
+    if (!(*zEngine)->headless) {
+        SDL_DestroyRenderer((*zEngine)->display->renderer);
+        SDL_DestroyWindow((*zEngine)->display->window);
+    }
     free((*zEngine)->display);
+    freeLogger();  // Last, everything above may still log
     SDL_Quit();
     free(*zEngine);
 }
@@ -2,12 +2,19 @@
 #define ZENG_H
 
 #include "engine/core/ecs.h"
+#include "engine/core/motion.h"
+#include "engine/core/jobSystem.h"
+#include "engine/core/timestep.h"
 #include "engine/io/inputManager.h"
+#include "engine/io/inputReplay.h"
 #include "engine/resourceManager.h"
 #include "engine/io/displayManager.h"
 #include "engine/arena.h"
 #include "engine/ui/uiManager.h"
+#include "engine/ui/perfOverlay.h"
 #include "engine/collisionManager.h"
+#include "engine/raycast.h"
+#include "engine/core/worldSnapshot.h"
 
 struct statemng;  // forward declaration
 typedef struct statemng *StateManager;
@@ -22,9 +29,15 @@ typedef struct engine {
     StateManager stateMng;  // Pointer to the state manager
     CollisionManager collisionMng;  // Pointer to the collision manager
     ECS ecs;  // Pointer to the game ECS
+    JobSystem jobs;  // Pointer to the work-stealing thread pool running the systems and parallel loops
     Arena map;  // Pointer to the arena structure
+    FrameArena frameArena;  // Scratch memory for the current frame, reset at the top of the main loop
+    Timestep timestep;  // Fixed-tick simulation clock driving the main loop
+    Uint8 headless;  // No window, renderer, audio or fonts, only the simulation runs
 } *ZENg;
 
+extern const char *const systemNames[SYS_COUNT];  // Printable name of every system, indexed by SystemType
+
 #include "states/stateManager.h"
 
 /**
@@ -50,9 +63,45 @@ void clearLevel(ZENg zEngine);
 
 /**
  * Initialises the game engine
+ * @param headless 1 to run the simulation alone, without a window, renderer, audio or fonts
  * @return ZENg = struct engine*
+ * @note a headless engine starts straight in the play state, as there is no menu to go through
+ */
+ZENg initGame(Uint8 headless);
+
+/**
+ * Simulates one tick: the current state's input, then the simulation systems
+ * @param zEngine pointer to the engine
+ * @note ticks of the play state are also recorded or checked against the replay, if one is running
+ */
+void simulateTick(ZENg zEngine);
+
+/**
+ * Plays a recorded match, starting the play state if the engine isn't in it
+ * @param zEngine pointer to the engine
+ * @param filePath path to the replay file
+ * @param seekTick tick to jump to before playing, 0 to play from the start
+ * @return 1 if playback started, 0 if the file couldn't be read
+ */
+Uint8 playReplay(ZENg zEngine, const char *filePath, Uint32 seekTick);
+
+/**
+ * Jumps to the keyframe at or before a tick of the replay being played
+ * @param zEngine pointer to the engine
+ * @param tick tick to jump to
+ * @note the world is restored from the keyframe's snapshot, a replay without one that early
+ * restarts the match and simulates it again up to the keyframe, checking every keyframe on the way
+ */
+void seekReplay(ZENg zEngine, Uint32 tick);
+
+/**
+ * Simulates ticks back to back, as fast as the machine allows, and reports the throughput
+ * @param zEngine pointer to a headless engine
+ * @param ticks number of ticks to simulate
+ * @return the number of ticks simulated per second
+ * @note stops early when a replay being played ends
  */
-ZENg initGame();
+double_t runHeadless(ZENg zEngine, Uint64 ticks);
 
 /**
  * Updates real positions and ensures the entities are aligned to the grid
@@ -76,12 +125,13 @@ void velocitySystem(ZENg zEngine, double_t deltaTime);
 void lifetimeSystem(ZENg zEngine, double_t deltaTime);
 
 /**
- * Checks and handles collisions between entities
+ * Runs the narrowphase on the pairs found by the broadphase and calls the handler of every pair that collides
  * @param zEngine pointer to the engine
- * @param entity entity for which the collisions are checked
- * @return the number of entities the current one has collided with (maybe will change to track them later)
+ * @return the number of colliding pairs
+ * @note each pair is handled once, with the entity of the lower role first. Only the pairs that touch are left in
+ * the collision manager, in the order they touched when a fast entity is involved
  */
-Uint8 checkAndHandleEntityCollisions(ZENg zEngine, Entity entity);
+Uint32 handleCollisionPairs(ZENg zEngine);
 
 /**
  * Passes the collision components to the collision handler
@@ -103,6 +153,7 @@ void renderDebugCollision(ZENg zEngine);
  * @param zEngine pointer to the engine
  * @param entity entity for which the collision is checker
  * @return number of tiles the entity has collided with
+ * @note only the tiles in the layer registered with the entity's role count, tested against the arena's packed rows
  */
 Uint8 checkAndHandleWorldCollisions(ZENg zEngine, Entity entity);
 
@@ -0,0 +1,272 @@
+#include "jobSystem.h"
+
+/**
+ * Shared state of a parallelFor, the jobs it spawns pull chunks from it until the range is exhausted
+ */
+typedef struct {
+    JobRangeFunc func;  // Work done on every chunk
+    void *data;  // Argument passed to the function
+    Uint64 count;  // Number of indices in the range
+    Uint64 chunkSize;  // Number of indices in a chunk
+    SDL_atomic_t nextChunk;  // Index of the next chunk to hand out
+} RangeJob;
+
+/**
+ * Finds the deque of the calling thread
+ * @param js the JobSystem
+ * @return the index of the calling worker, threads outside of the pool share the main thread's deque
+ */
+static Uint32 currentWorker(JobSystem js) {
+    SDL_threadID self = SDL_ThreadID();
+    for (Uint32 i = 1; i < js->workerCount; i++) {
+        if (js->threadIDs[i] == self) return i;
+    }
+    return 0;
+}
+
+/**
+ * Pushes a job at the bottom of a deque and wakes a sleeping worker
+ * @param js the JobSystem
+ * @param worker index of the deque
+ * @param job the job to push
+ * @return 1 if the job was queued, 0 if the deque is full
+ */
+static Uint8 pushJob(JobSystem js, Uint32 worker, Job job) {
+    JobDeque *dq = &js->deques[worker];
+
+    SDL_AtomicLock(&dq->lock);
+    if (dq->bottom - dq->top >= JOB_DEQUE_CAPACITY) {
+        SDL_AtomicUnlock(&dq->lock);
+        return 0;
+    }
+    dq->jobs[dq->bottom % JOB_DEQUE_CAPACITY] = job;
+    dq->bottom++;
+    SDL_AtomicUnlock(&dq->lock);
+
+    // A worker that saw no queued jobs is either awake to see this one or waiting for the signal
+    SDL_AtomicAdd(&js->queued, 1);
+    if (SDL_AtomicGet(&js->sleeping) > 0) {
+        SDL_LockMutex(js->sleepLock);
+        SDL_CondSignal(js->jobsAvailable);
+        SDL_UnlockMutex(js->sleepLock);
+    }
+    return 1;
+}
+
+/**
+ * Takes the newest job of a worker's own deque, or the oldest job of another one
+ * @param js the JobSystem
+ * @param worker index of the calling worker
+ * @param job where the job is written
+ * @return 1 if a job was found, 0 if every deque is empty
+ */
+static Uint8 findJob(JobSystem js, Uint32 worker, Job *job) {
+    for (Uint32 k = 0; k < js->workerCount; k++) {
+        Uint32 victim = (worker + k) % js->workerCount;
+        JobDeque *dq = &js->deques[victim];
+
+        SDL_AtomicLock(&dq->lock);
+        if (dq->bottom == dq->top) {
+            SDL_AtomicUnlock(&dq->lock);
+            continue;
+        }
+        if (k == 0) *job = dq->jobs[--dq->bottom % JOB_DEQUE_CAPACITY];  // Own deque - LIFO keeps the data warm
+        else *job = dq->jobs[dq->top++ % JOB_DEQUE_CAPACITY];  // Steal the oldest, usually the biggest piece
+        SDL_AtomicUnlock(&dq->lock);
+
+        SDL_AtomicAdd(&js->queued, -1);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Runs a job once its dependency is met and signals its counter
+ * @param js the JobSystem
+ * @param job the job to run
+ */
+static void runJob(JobSystem js, Job job) {
+    if (job.dependency) waitForJobs(js, job.dependency);
+    job.func(job.data);
+    if (job.counter) SDL_AtomicAdd(&job.counter->pending, -1);
+}
+
+/**
+ * Worker thread loop, runs and steals jobs until the job system shuts down
+ * @param data the JobSystem
+ * @return 0
+ */
+static int workerLoop(void *data) {
+    JobSystem js = data;
+    Uint32 self = (Uint32)SDL_AtomicAdd(&js->nextWorker, 1);
+    js->threadIDs[self] = SDL_ThreadID();
+    SDL_SemPost(js->started);
+
+    Job job;
+    while (!SDL_AtomicGet(&js->quit)) {
+        if (findJob(js, self, &job)) {
+            runJob(js, job);
+            continue;
+        }
+
+        // Nothing to steal, sleep until a job is pushed
+        SDL_LockMutex(js->sleepLock);
+        SDL_AtomicAdd(&js->sleeping, 1);
+        while (SDL_AtomicGet(&js->queued) == 0 && !SDL_AtomicGet(&js->quit)) {
+            SDL_CondWait(js->jobsAvailable, js->sleepLock);
+        }
+        SDL_AtomicAdd(&js->sleeping, -1);
+        SDL_UnlockMutex(js->sleepLock);
+    }
+    return 0;
+}
+
+/**
+ * Pulls chunks of a parallelFor's range until none are left
+ * @param data the RangeJob
+ */
+static void runRangeJob(void *data) {
+    RangeJob *range = data;
+    while (1) {
+        Uint64 start = (Uint64)SDL_AtomicAdd(&range->nextChunk, 1) * range->chunkSize;
+        if (start >= range->count) return;
+        Uint64 end = start + range->chunkSize < range->count ? start + range->chunkSize : range->count;
+        range->func(range->data, start, end);
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+JobSystem initJobSystem(Uint32 workerCount) {
+    JobSystem js = calloc(1, sizeof(struct jobSystem));
+    if (!js) THROW_ERROR_AND_EXIT("Failed to allocate memory for the job system");
+
+    if (workerCount == 0) workerCount = SDL_GetCPUCount();
+    if (workerCount < 1) workerCount = 1;
+    if (workerCount > MAX_JOB_WORKERS) workerCount = MAX_JOB_WORKERS;
+
+    js->deques = calloc(workerCount, sizeof(JobDeque));
+    if (!js->deques) THROW_ERROR_AND_EXIT("Failed to allocate memory for the job deques");
+
+    js->sleepLock = SDL_CreateMutex();
+    js->jobsAvailable = SDL_CreateCond();
+    js->started = SDL_CreateSemaphore(0);
+    if (!js->sleepLock || !js->jobsAvailable || !js->started) THROW_ERROR_AND_DO(
+        "Failed to create the job system's synchronization primitives: ",
+        fprintf(stderr, "%s\n", SDL_GetError()); exit(EXIT_FAILURE);
+    );
+
+    // The main thread is worker 0, the others register themselves before any job is pushed
+    js->threadIDs[0] = SDL_ThreadID();
+    js->workerCount = workerCount;
+    SDL_AtomicSet(&js->nextWorker, 1);
+    for (Uint32 i = 1; i < workerCount; i++) {
+        js->threads[i] = SDL_CreateThread(workerLoop, "JobWorker", js);
+        if (!js->threads[i]) THROW_ERROR_AND_DO(
+            "Failed to create a job worker thread: ",
+            fprintf(stderr, "%s\n", SDL_GetError()); exit(EXIT_FAILURE);
+        );
+    }
+    for (Uint32 i = 1; i < workerCount; i++) SDL_SemWait(js->started);
+
+    LOG_DEBUG(LOG_CORE, "Job system started with %u workers", js->workerCount);
+
+    return js;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void submitJob(JobSystem js, JobFunc func, void *data, JobCounter *counter) {
+    submitJobAfter(js, func, data, counter, NULL);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void submitJobAfter(JobSystem js, JobFunc func, void *data, JobCounter *counter, JobCounter *dependency) {
+    if (!js || !func) THROW_ERROR_AND_RETURN_VOID("Job system or job function NULL in submitJobAfter");
+
+    if (counter) SDL_AtomicAdd(&counter->pending, 1);
+    Job job = {.func = func, .data = data, .counter = counter, .dependency = dependency};
+
+    // A full deque means the workers are swamped anyway, so run the job in place
+    if (!pushJob(js, currentWorker(js), job)) runJob(js, job);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void waitForJobs(JobSystem js, JobCounter *counter) {
+    if (!js || !counter) THROW_ERROR_AND_RETURN_VOID("Job system or counter NULL in waitForJobs");
+
+    Uint32 self = currentWorker(js);
+    Job job;
+    while (SDL_AtomicGet(&counter->pending) > 0) {
+        if (findJob(js, self, &job)) runJob(js, job);
+        else SDL_Delay(0);  // The remaining jobs are running elsewhere, give their threads the core
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void parallelFor(JobSystem js, Uint64 count, Uint64 chunkSize, JobRangeFunc func, void *data) {
+    if (!js || !func) THROW_ERROR_AND_RETURN_VOID("Job system or range function NULL in parallelFor");
+    if (count == 0) return;
+
+    if (chunkSize == 0) chunkSize = (count + js->workerCount - 1) / js->workerCount;
+    Uint64 chunks = (count + chunkSize - 1) / chunkSize;
+    if (chunks <= 1 || js->workerCount == 1) {
+        func(data, 0, count);
+        return;
+    }
+
+    // Every helper pulls chunks until the range runs out, so a slow chunk doesn't hold the others back
+    RangeJob range = {.func = func, .data = data, .count = count, .chunkSize = chunkSize};
+    SDL_AtomicSet(&range.nextChunk, 0);
+    JobCounter counter = {0};
+
+    Uint64 helpers = (chunks < js->workerCount ? chunks : js->workerCount) - 1;
+    for (Uint64 i = 0; i < helpers; i++) submitJob(js, runRangeJob, &range, &counter);
+    runRangeJob(&range);
+    waitForJobs(js, &counter);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint32 getJobWorkerCount(JobSystem js) {
+    return js ? js->workerCount : 1;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void freeJobSystem(JobSystem *js) {
+    if (!js || !*js) return;
+
+    SDL_AtomicSet(&(*js)->quit, 1);
+    SDL_LockMutex((*js)->sleepLock);
+    SDL_CondBroadcast((*js)->jobsAvailable);
+    SDL_UnlockMutex((*js)->sleepLock);
+
+    for (Uint32 i = 1; i < (*js)->workerCount; i++) {
+        SDL_WaitThread((*js)->threads[i], NULL);
+    }
+
+    SDL_DestroySemaphore((*js)->started);
+    SDL_DestroyCond((*js)->jobsAvailable);
+    SDL_DestroyMutex((*js)->sleepLock);
+    free((*js)->deques);
+    free(*js);
+    *js = NULL;
+}
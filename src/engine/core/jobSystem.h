@@ -0,0 +1,112 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+// Work-stealing job system
+// Every thread of the pool owns a deque: it pushes and pops its own jobs at the bottom,
+// while the idle threads steal the oldest ones from the top. The main thread is worker 0
+
+#include "global/global.h"
+
+#define MAX_JOB_WORKERS 64  // Upper bound of the threads in the pool, the main thread included
+#define JOB_DEQUE_CAPACITY 1024  // Jobs a worker's deque holds, a job that doesn't fit runs right away
+
+typedef void (*JobFunc)(void *data);  // Work done by a job
+typedef void (*JobRangeFunc)(void *data, Uint64 start, Uint64 end);  // Work done on the [start, end) range
+
+/**
+ * Counts the jobs of a group that haven't finished yet
+ * Zero initialize it before submitting jobs against it
+ */
+typedef struct {
+    SDL_atomic_t pending;  // Number of unfinished jobs
+} JobCounter;
+
+typedef struct {
+    JobFunc func;  // Work to do
+    void *data;  // Argument passed to the function
+    JobCounter *counter;  // Decremented once the job finishes, may be NULL
+    JobCounter *dependency;  // Jobs that must finish before this one starts, may be NULL
+} Job;
+
+typedef struct {
+    SDL_SpinLock lock;  // Guards the deque, the owner and the thieves take it for a handful of instructions
+    Uint64 top;  // Index of the oldest job, where the thieves take from
+    Uint64 bottom;  // Index past the newest job, where the owner pushes and pops
+    Job jobs[JOB_DEQUE_CAPACITY];  // Ring buffer indexed modulo the capacity
+} JobDeque;
+
+typedef struct jobSystem {
+    JobDeque *deques;  // One deque per worker, index 0 belongs to the main thread
+    SDL_threadID threadIDs[MAX_JOB_WORKERS];  // Maps a thread to its deque
+    SDL_Thread *threads[MAX_JOB_WORKERS];  // The pool's threads, slot 0 stays NULL for the main thread
+    Uint32 workerCount;  // Number of workers, the main thread included
+
+    SDL_atomic_t queued;  // Number of jobs sitting in the deques
+    SDL_atomic_t sleeping;  // Number of workers waiting for jobs
+    SDL_mutex *sleepLock;  // Guards the sleeping workers' condition
+    SDL_cond *jobsAvailable;  // Signalled when jobs are pushed while some workers sleep
+    SDL_atomic_t quit;  // Tells the workers to exit
+    SDL_atomic_t nextWorker;  // Index handed to the next thread starting up
+    SDL_sem *started;  // Posted by every thread once it registered its ID
+} *JobSystem;
+
+/**
+ * Starts the job system's threads
+ * @param workerCount number of workers including the calling thread, 0 to match the core count
+ * @return JobSystem = struct jobSystem*
+ * @note must be called from the main thread, which becomes worker 0
+ */
+JobSystem initJobSystem(Uint32 workerCount);
+
+/**
+ * Queues a job on the calling thread's deque
+ * @param js the JobSystem
+ * @param func the work to do
+ * @param data argument passed to the function, must outlive the job
+ * @param counter incremented now and decremented when the job finishes, may be NULL
+ */
+void submitJob(JobSystem js, JobFunc func, void *data, JobCounter *counter);
+
+/**
+ * Queues a job that only starts once the jobs counted by a dependency have finished
+ * @param js the JobSystem
+ * @param func the work to do
+ * @param data argument passed to the function, must outlive the job
+ * @param counter incremented now and decremented when the job finishes, may be NULL
+ * @param dependency counter of the jobs to wait for, may be NULL
+ * @note the thread that picks the job up runs other jobs while the dependency is pending
+ */
+void submitJobAfter(JobSystem js, JobFunc func, void *data, JobCounter *counter, JobCounter *dependency);
+
+/**
+ * Runs queued jobs on the calling thread until a counter drops to zero
+ * @param js the JobSystem
+ * @param counter the counter to wait for
+ */
+void waitForJobs(JobSystem js, JobCounter *counter);
+
+/**
+ * Splits [0, count) into chunks and runs them across the workers, returning once all are done
+ * @param js the JobSystem
+ * @param count number of indices
+ * @param chunkSize number of indices handed out at once, 0 splits the range evenly between the workers
+ * @param func work done on every chunk
+ * @param data argument passed to the function
+ * @note the calling thread works on the chunks too, and small ranges run on it alone
+ */
+void parallelFor(JobSystem js, Uint64 count, Uint64 chunkSize, JobRangeFunc func, void *data);
+
+/**
+ * @param js the JobSystem
+ * @return the number of workers, the main thread included
+ */
+Uint32 getJobWorkerCount(JobSystem js);
+
+/**
+ * Stops the job system's threads and frees it
+ * @param js pointer to the JobSystem
+ * @note the queued jobs are dropped, wait for them first
+ */
+void freeJobSystem(JobSystem *js);
+
+#endif // JOB_SYSTEM_H
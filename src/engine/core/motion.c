@@ -0,0 +1,130 @@
+#include "motion.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define MOTION_X86
+    #include <immintrin.h>
+#endif
+
+typedef void (*MotionKernel)(MotionBatch *batch, Uint64 start, double_t deltaTime);
+
+/**
+ * Integrates and clamps the entities in [start, count) one at a time
+ * @param batch pointer to the MotionBatch
+ * @param start index of the first entity to integrate
+ * @param deltaTime time since the last frame in seconds
+ */
+static void integrateScalar(MotionBatch *batch, Uint64 start, double_t deltaTime) {
+    for (Uint64 i = start; i < batch->count; i++) {
+        double_t x = batch->x[i] + batch->vx[i] * deltaTime;
+        double_t y = batch->y[i] + batch->vy[i] * deltaTime;
+
+        if (x < 0) x = 0;
+        if (y < 0) y = 0;
+        if (x > batch->maxX[i]) x = batch->maxX[i];
+        if (y > batch->maxY[i]) y = batch->maxY[i];
+
+        batch->x[i] = x;
+        batch->y[i] = y;
+    }
+}
+
+#ifdef MOTION_X86
+
+/**
+ * Integrates and clamps 2 entities per instruction, the tail is left to the scalar kernel
+ */
+__attribute__((target("sse2")))
+static void integrateSSE2(MotionBatch *batch, Uint64 start, double_t deltaTime) {
+    const __m128d dt = _mm_set1_pd(deltaTime);
+    const __m128d zero = _mm_setzero_pd();
+    Uint64 i = start;
+    for (; i + 2 <= batch->count; i += 2) {
+        __m128d x = _mm_add_pd(_mm_load_pd(&batch->x[i]), _mm_mul_pd(_mm_load_pd(&batch->vx[i]), dt));
+        __m128d y = _mm_add_pd(_mm_load_pd(&batch->y[i]), _mm_mul_pd(_mm_load_pd(&batch->vy[i]), dt));
+
+        x = _mm_min_pd(_mm_max_pd(x, zero), _mm_load_pd(&batch->maxX[i]));
+        y = _mm_min_pd(_mm_max_pd(y, zero), _mm_load_pd(&batch->maxY[i]));
+
+        _mm_store_pd(&batch->x[i], x);
+        _mm_store_pd(&batch->y[i], y);
+    }
+    integrateScalar(batch, i, deltaTime);
+}
+
+/**
+ * Integrates and clamps 4 entities per instruction, the tail is left to the SSE2 kernel
+ */
+__attribute__((target("avx2")))
+static void integrateAVX2(MotionBatch *batch, Uint64 start, double_t deltaTime) {
+    const __m256d dt = _mm256_set1_pd(deltaTime);
+    const __m256d zero = _mm256_setzero_pd();
+    Uint64 i = start;
+    for (; i + 4 <= batch->count; i += 4) {
+        __m256d x = _mm256_add_pd(_mm256_load_pd(&batch->x[i]), _mm256_mul_pd(_mm256_load_pd(&batch->vx[i]), dt));
+        __m256d y = _mm256_add_pd(_mm256_load_pd(&batch->y[i]), _mm256_mul_pd(_mm256_load_pd(&batch->vy[i]), dt));
+
+        x = _mm256_min_pd(_mm256_max_pd(x, zero), _mm256_load_pd(&batch->maxX[i]));
+        y = _mm256_min_pd(_mm256_max_pd(y, zero), _mm256_load_pd(&batch->maxY[i]));
+
+        _mm256_store_pd(&batch->x[i], x);
+        _mm256_store_pd(&batch->y[i], y);
+    }
+    integrateSSE2(batch, i, deltaTime);
+}
+
+#endif
+
+static MotionKernel selectedKernel = integrateScalar;
+static const char *selectedKernelName = "scalar";
+
+/**
+ * =====================================================================================================================
+ */
+
+void initMotionKernels() {
+    selectedKernel = integrateScalar;
+    selectedKernelName = "scalar";
+
+    #ifdef MOTION_X86
+        if (SDL_HasAVX2()) {
+            selectedKernel = integrateAVX2;
+            selectedKernelName = "AVX2";
+        } else if (SDL_HasSSE2()) {
+            selectedKernel = integrateSSE2;
+            selectedKernelName = "SSE2";
+        }
+    #endif
+
+    LOG_DEBUG(LOG_SYSTEMS, "Motion integration uses the %s kernel", selectedKernelName);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+const char* getMotionKernelName() {
+    return selectedKernelName;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void allocMotionBatch(MotionBatch *batch, Uint64 count, FrameArena *arena) {
+    if (!batch) THROW_ERROR_AND_RETURN_VOID("Motion batch is NULL in allocMotionBatch");
+
+    double_t **fields[] = {&batch->x, &batch->y, &batch->vx, &batch->vy, &batch->maxX, &batch->maxY};
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        *fields[i] = frameAlloc(arena, count * sizeof(double_t));
+    }
+    batch->count = count;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void integrateMotionBatch(MotionBatch *batch, double_t deltaTime) {
+    if (!batch) THROW_ERROR_AND_RETURN_VOID("Motion batch is NULL in integrateMotionBatch");
+    selectedKernel(batch, 0, deltaTime);
+}
@@ -0,0 +1,49 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+// Structure-of-arrays motion integration
+// The moving entities are streamed into per-field arrays so a single instruction integrates several of them
+
+#include "global/global.h"
+
+/**
+ * SoA mirror of the moving entities' positions and velocities
+ * Every array is SIMD aligned and holds count valid elements, they live in the frame arena
+ */
+typedef struct {
+    double_t *x;  // Positions on the X axis, replaced by the predicted ones after integration
+    double_t *y;  // Positions on the Y axis, replaced by the predicted ones after integration
+    double_t *vx;  // Velocities on the X axis
+    double_t *vy;  // Velocities on the Y axis
+    double_t *maxX;  // Upper bound of the predicted X positions
+    double_t *maxY;  // Upper bound of the predicted Y positions
+    Uint64 count;  // Number of entities in the batch
+} MotionBatch;
+
+/**
+ * Selects the fastest integration kernel the CPU supports
+ * @note falls back to the scalar kernel when neither AVX2 nor SSE2 are available
+ */
+void initMotionKernels();
+
+/**
+ * @return the name of the selected integration kernel, for debugging
+ */
+const char* getMotionKernelName();
+
+/**
+ * Carves the arrays of a motion batch out of the frame arena
+ * @param batch pointer to the MotionBatch
+ * @param count number of entities the batch holds
+ * @param arena pointer to the FrameArena, the arrays are gone once it is reset
+ */
+void allocMotionBatch(MotionBatch *batch, Uint64 count, FrameArena *arena);
+
+/**
+ * Integrates the batch's positions in place and clamps them to [0, max]
+ * @param batch pointer to the MotionBatch
+ * @param deltaTime time since the last frame in seconds
+ */
+void integrateMotionBatch(MotionBatch *batch, double_t deltaTime);
+
+#endif // MOTION_H
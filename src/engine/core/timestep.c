@@ -0,0 +1,87 @@
+#include "timestep.h"
+
+void initTimestep(Timestep *ts, Uint32 tickRate) {
+    if (!ts) THROW_ERROR_AND_RETURN_VOID("Cannot initialize a NULL timestep");
+
+    *ts = (Timestep) {0};
+    setTickRate(ts, tickRate ? tickRate : DEFAULT_TICK_RATE);
+    ts->frequency = SDL_GetPerformanceFrequency();
+    ts->frameStart = SDL_GetPerformanceCounter();
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void setTickRate(Timestep *ts, Uint32 tickRate) {
+    if (!ts) THROW_ERROR_AND_RETURN_VOID("Timestep is NULL in setTickRate");
+
+    if (tickRate < 1) tickRate = 1;
+    if (tickRate > MAX_TICK_RATE) tickRate = MAX_TICK_RATE;
+    ts->tickRate = tickRate;
+    ts->tickLength = 1.0 / tickRate;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void beginTimestepFrame(Timestep *ts) {
+    if (!ts) THROW_ERROR_AND_RETURN_VOID("Timestep is NULL in beginTimestepFrame");
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    ts->frameTime = (double_t)(now - ts->frameStart) / ts->frequency;
+    ts->frameStart = now;
+
+    // After a stall the simulation skips ahead instead of trying to catch up tick by tick
+    ts->accumulator += ts->frameTime < MAX_FRAME_TIME ? ts->frameTime : MAX_FRAME_TIME;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 nextTick(Timestep *ts) {
+    if (!ts) THROW_ERROR_AND_RETURN("Timestep is NULL in nextTick", 0);
+
+    if (ts->accumulator >= ts->tickLength) {
+        ts->accumulator -= ts->tickLength;
+        ts->tickCount++;
+        return 1;
+    }
+    ts->alpha = ts->accumulator / ts->tickLength;
+    return 0;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void endTimestepFrame(Timestep *ts) {
+    if (!ts || ts->maxFPS == 0) return;
+
+    double_t elapsed = (double_t)(SDL_GetPerformanceCounter() - ts->frameStart) / ts->frequency;
+    double_t target = 1.0 / ts->maxFPS;
+    // SDL_Delay only has millisecond precision, so the frame may run a bit over, never under
+    if (elapsed < target) SDL_Delay((Uint32)((target - elapsed) * 1000.0));
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void saveTimingSettings(const Timestep *ts, const char *filePath) {
+    if (!ts || !filePath) return;
+
+    FILE *fout = fopen(filePath, "a");
+    if (!fout) {
+        printf("Failed to open config file for writing: %s\n", filePath);
+        return;
+    }
+
+    fprintf(fout, "[TIMING]\n");
+    fprintf(fout, "TICK_RATE=%u\n", ts->tickRate);
+    fprintf(fout, "MAX_FPS=%u\n", ts->maxFPS);
+
+    fclose(fout);
+}
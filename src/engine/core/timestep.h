@@ -0,0 +1,69 @@
+#ifndef TIMESTEP_H
+#define TIMESTEP_H
+
+// Fixed-timestep clock
+// Real time piles up in an accumulator and the simulation consumes it in ticks of constant length,
+// so the game plays the same at any frame rate. Rendering interpolates between the last two ticks
+
+#include "global/global.h"
+
+#define DEFAULT_TICK_RATE 60  // Simulation ticks per second
+#define MAX_TICK_RATE 1000  // Upper bound of the tick rate read from the settings
+#define MAX_FRAME_TIME 0.25  // Longest frame the accumulator takes in, in seconds, so a stall can't snowball
+
+typedef struct {
+    Uint32 tickRate;  // Simulation ticks per second
+    double_t tickLength;  // Seconds simulated by one tick
+    Uint32 maxFPS;  // Frame rate cap, 0 leaves rendering uncapped
+
+    Uint64 frequency;  // Performance counter increments per second
+    Uint64 frameStart;  // Performance counter value at the start of the current frame
+    double_t frameTime;  // Real duration of the previous frame, in seconds
+    double_t accumulator;  // Real time not simulated yet, in seconds
+    double_t alpha;  // Where the rendered frame sits between the last two ticks, in [0, 1)
+    Uint64 tickCount;  // Number of ticks simulated so far
+} Timestep;
+
+/**
+ * Initializes the clock
+ * @param ts pointer to the Timestep
+ * @param tickRate simulation ticks per second, 0 for DEFAULT_TICK_RATE
+ */
+void initTimestep(Timestep *ts, Uint32 tickRate);
+
+/**
+ * Changes the simulation tick rate
+ * @param ts pointer to the Timestep
+ * @param tickRate simulation ticks per second, clamped to [1, MAX_TICK_RATE]
+ */
+void setTickRate(Timestep *ts, Uint32 tickRate);
+
+/**
+ * Measures the previous frame and adds it to the accumulator
+ * @param ts pointer to the Timestep
+ * @note call it once at the top of the main loop
+ */
+void beginTimestepFrame(Timestep *ts);
+
+/**
+ * Takes one tick out of the accumulator
+ * @param ts pointer to the Timestep
+ * @return 1 if a tick must be simulated, 0 once the accumulator holds less than a tick
+ * @note the interpolation factor is updated when it returns 0
+ */
+Uint8 nextTick(Timestep *ts);
+
+/**
+ * Waits out the rest of the frame when a frame rate cap is set
+ * @param ts pointer to the Timestep
+ */
+void endTimestepFrame(Timestep *ts);
+
+/**
+ * Saves the timing settings to a file
+ * @param ts pointer to the Timestep
+ * @param filePath path to the settings file
+ */
+void saveTimingSettings(const Timestep *ts, const char *filePath);
+
+#endif // TIMESTEP_H
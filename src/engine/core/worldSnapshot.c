@@ -0,0 +1,369 @@
+#include "worldSnapshot.h"
+#include "engine/core/engine.h"
+
+#define SNAPSHOT_INIT_CAPACITY 4096  // Bytes a snapshot starts out with, it doubles from there
+#define SNAPSHOT_LAYOUT_SIZE (COMPONENT_TYPE_COUNT + 5)  // Fields describing the build a snapshot was taken by
+
+typedef void (*ProjectileSpawner)(
+    ZENg, Entity, int, int, double_t, ProjectileComponent *, double_t, SDL_Texture *, Mix_Chunk *
+);
+
+// The functions a weapon can spawn its projectiles with, a weapon's is saved as its index
+static const ProjectileSpawner projectileSpawners[] = {
+    NULL,
+    &spawnBulletProjectile
+};
+#define SPAWNER_COUNT (sizeof(projectileSpawners) / sizeof(projectileSpawners[0]))
+
+typedef struct {
+    Uint8 *data;  // The snapshot so far
+    Uint32 size;  // Number of bytes written
+    Uint32 capacity;  // Capacity of the data array
+} SnapshotWriter;
+
+typedef struct {
+    const Uint8 *data;  // The snapshot
+    Uint32 size;  // Size of the snapshot in bytes
+    Uint32 pos;  // Next byte to read
+    Uint8 failed;  // Set once a read went past the end, every read after it yields zeroes
+} SnapshotReader;
+
+/**
+ * Appends bytes to a snapshot
+ * @param out the writer
+ * @param bytes the bytes to append
+ * @param count number of bytes
+ */
+static void writeBytes(SnapshotWriter *out, const void *bytes, size_t count) {
+    if (count == 0) return;
+    if (out->size + count > out->capacity) {
+        Uint32 newCapacity = out->capacity ? out->capacity : SNAPSHOT_INIT_CAPACITY;
+        while (newCapacity < out->size + count) newCapacity *= 2;
+        Uint8 *tmp = realloc(out->data, newCapacity);
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to grow a world snapshot");
+        out->data = tmp;
+        out->capacity = newCapacity;
+    }
+    memcpy(out->data + out->size, bytes, count);
+    out->size += count;
+}
+
+static void writeU8(SnapshotWriter *out, Uint8 value) { writeBytes(out, &value, sizeof(value)); }
+static void writeU32(SnapshotWriter *out, Uint32 value) { writeBytes(out, &value, sizeof(value)); }
+static void writeU64(SnapshotWriter *out, Uint64 value) { writeBytes(out, &value, sizeof(value)); }
+
+/**
+ * Appends a string with its terminator, NULL is stored as an empty record
+ * @param out the writer
+ * @param str the string, may be NULL
+ */
+static void writeString(SnapshotWriter *out, const char *str) {
+    Uint32 length = str ? (Uint32)strlen(str) + 1 : 0;
+    writeU32(out, length);
+    if (length) writeBytes(out, str, length);
+}
+
+/**
+ * Reads bytes from a snapshot
+ * @param in the reader
+ * @param bytes where the bytes go, zeroed if the snapshot ends before them
+ * @param count number of bytes
+ */
+static void readBytes(SnapshotReader *in, void *bytes, size_t count) {
+    if (count == 0) return;
+    if (in->failed || count > in->size - in->pos) {
+        in->failed = 1;
+        memset(bytes, 0, count);
+        return;
+    }
+    memcpy(bytes, in->data + in->pos, count);
+    in->pos += count;
+}
+
+static Uint8 readU8(SnapshotReader *in) { Uint8 value; readBytes(in, &value, sizeof(value)); return value; }
+static Uint32 readU32(SnapshotReader *in) { Uint32 value; readBytes(in, &value, sizeof(value)); return value; }
+static Uint64 readU64(SnapshotReader *in) { Uint64 value; readBytes(in, &value, sizeof(value)); return value; }
+
+/**
+ * Reads a string written by writeString
+ * @param in the reader
+ * @return const char * = the string, inside the snapshot, NULL if none was stored
+ */
+static const char* readString(SnapshotReader *in) {
+    Uint32 length = readU32(in);
+    if (length == 0 || in->failed) return NULL;
+    if (length > in->size - in->pos || in->data[in->pos + length - 1] != '\0') {
+        in->failed = 1;
+        return NULL;
+    }
+    const char *str = (const char *)in->data + in->pos;
+    in->pos += length;
+    return str;
+}
+
+/**
+ * Describes the build, a snapshot only loads back where the components have the same layout
+ * @param ecs the ECS
+ * @param layout where the description goes
+ */
+static void getLayout(ECS ecs, Uint32 layout[SNAPSHOT_LAYOUT_SIZE]) {
+    layout[0] = SNAPSHOT_MAGIC;
+    layout[1] = COMPONENT_TYPE_COUNT;
+    layout[2] = ARENA_WIDTH * ARENA_HEIGHT;
+    layout[3] = GROUP_COUNT;
+    layout[4] = (Uint32)ecs->depGraph->nodeCount;
+    for (Uint32 i = 0; i < COMPONENT_TYPE_COUNT; i++) layout[5 + i] = (Uint32)ecs->components[i].elemSize;
+}
+
+/**
+ * Saves what a component points to, right after its bytes
+ * @param zEngine pointer to the engine
+ * @param out the writer
+ * @param type the component's type
+ * @param component the component
+ */
+static void writeComponentData(ZENg zEngine, SnapshotWriter *out, ComponentType type, const void *component) {
+    switch (type) {
+        case COLLISION_COMPONENT: {
+            const CollisionComponent *colComp = component;
+            SDL_Rect hitbox = colComp->hitbox ? *colComp->hitbox : (SDL_Rect){0};
+            writeBytes(out, &hitbox, sizeof(SDL_Rect));
+            break;
+        }
+        case RENDER_COMPONENT: {
+            const RenderComponent *render = component;
+            SDL_Rect destRect = render->destRect ? *render->destRect : (SDL_Rect){0};
+            writeBytes(out, &destRect, sizeof(SDL_Rect));
+            writeString(out, getResourceKey(zEngine->resources, render->texture));
+            break;
+        }
+        case WEAPON_COMPONENT: {
+            const WeaponComponent *weapon = component;
+            writeString(out, weapon->name);
+            writeString(out, getResourceKey(zEngine->resources, weapon->projTexture));
+            writeString(out, getResourceKey(zEngine->resources, weapon->projSound));
+            Uint8 spawner = 0;
+            while (spawner < SPAWNER_COUNT && projectileSpawners[spawner] != weapon->spawnProj) spawner++;
+            if (spawner == SPAWNER_COUNT) THROW_ERROR_AND_DO("Weapon with an unknown projectile spawner", spawner = 0;);
+            writeU8(out, spawner);
+            break;
+        }
+        case LOADOUT_COMPONENT: {
+            // The list from the current gun on, so the current one is the first node again
+            const LoadoutComponent *loadout = component;
+            Uint32 count = 0;
+            CDLLNode *node = loadout->currSecondaryGun;
+            if (node) do count++; while ((node = node->next) != loadout->currSecondaryGun);
+            writeU32(out, count);
+            for (Uint32 i = 0; i < count; i++, node = node->next) writeU64(out, node->data.u64);
+            break;
+        }
+        default: break;  // The rest own nothing outside of their dense slot
+    }
+}
+
+/**
+ * Reads what a component points to and points the component to fresh copies of it
+ * @param zEngine pointer to the engine
+ * @param in the reader
+ * @param type the component's type
+ * @param component the component, as it was saved
+ */
+static void readComponentData(ZENg zEngine, SnapshotReader *in, ComponentType type, void *component) {
+    ECS ecs = zEngine->ecs;
+    switch (type) {
+        case COLLISION_COMPONENT: {
+            CollisionComponent *colComp = component;
+            colComp->hitbox = slabAlloc(&ecs->pools[COLLISION_COMPONENT]);
+            readBytes(in, colComp->hitbox, sizeof(SDL_Rect));
+            break;
+        }
+        case RENDER_COMPONENT: {
+            RenderComponent *render = component;
+            render->destRect = slabAlloc(&ecs->pools[RENDER_COMPONENT]);
+            readBytes(in, render->destRect, sizeof(SDL_Rect));
+            const char *textureKey = readString(in);
+            render->texture = textureKey ? getTexture(zEngine->resources, textureKey) : NULL;
+            break;
+        }
+        case WEAPON_COMPONENT: {
+            WeaponComponent *weapon = component;
+            const char *name = readString(in);
+            weapon->name = name ? strdup(name) : NULL;
+            const char *textureKey = readString(in);
+            weapon->projTexture = textureKey ? getTexture(zEngine->resources, textureKey) : NULL;
+            const char *soundKey = readString(in);
+            weapon->projSound = soundKey ? getSound(zEngine->resources, soundKey) : NULL;
+            Uint8 spawner = readU8(in);
+            weapon->spawnProj = spawner < SPAWNER_COUNT ? projectileSpawners[spawner] : NULL;
+            break;
+        }
+        case LOADOUT_COMPONENT: {
+            LoadoutComponent *loadout = component;
+            loadout->currSecondaryGun = NULL;
+            Uint32 count = readU32(in);
+            for (Uint32 i = 0; i < count && !in->failed; i++) {
+                GenericData gun = {.u64 = readU64(in)};
+                if (!loadout->currSecondaryGun) loadout->currSecondaryGun = initList(gun, DATA_U64);
+                else CDLLInsertLast(loadout->currSecondaryGun, gun, DATA_U64);
+            }
+            break;
+        }
+        default: break;  // The rest own nothing outside of their dense slot
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8* saveWorldSnapshot(ZENg zEngine, Uint32 *size) {
+    if (!zEngine || !size) THROW_ERROR_AND_RETURN("NULL argument in saveWorldSnapshot", NULL);
+    ECS ecs = zEngine->ecs;
+    CollisionManager cm = zEngine->collisionMng;
+    SnapshotWriter out = {0};
+
+    Uint32 layout[SNAPSHOT_LAYOUT_SIZE];
+    getLayout(ecs, layout);
+    writeBytes(&out, layout, sizeof(layout));
+    writeU64(&out, PLAYER_ID);
+
+    // The tiles by type, the ones that change are only ever replaced by another prefab
+    for (Uint32 row = 0; row < ARENA_HEIGHT; row++) {
+        for (Uint32 col = 0; col < ARENA_WIDTH; col++) writeU8(&out, (Uint8)zEngine->map->tiles[row][col].type);
+    }
+
+    // Every generation, the free indices above nextEntityID keep theirs too
+    writeU64(&out, ecs->capacity);
+    writeBytes(&out, ecs->generations, ecs->capacity * sizeof(Uint32));
+    writeU64(&out, ecs->nextEntityID);
+    writeU64(&out, ecs->entityCount);
+    writeBytes(&out, ecs->activeEntities, ecs->entityCount * sizeof(Entity));
+    writeU64(&out, ecs->freeEntityCount);
+    writeBytes(&out, ecs->freeEntities, ecs->freeEntityCount * sizeof(Entity));
+
+    // The sets in dense order, the groups' ranges and the iteration order of every system come back with it
+    for (ComponentType type = 0; type < COMPONENT_TYPE_COUNT; type++) {
+        ComponentTypeSet *set = &ecs->components[type];
+        writeU64(&out, set->denseSize);
+        for (Uint64 i = 0; i < set->denseSize; i++) {
+            writeU64(&out, set->denseToEntity[i]);
+            writeBytes(&out, DENSE_AT(set, i), set->elemSize);
+            writeComponentData(zEngine, &out, type, DENSE_AT(set, i));
+        }
+        // Only the dirty lists a system drains, the others have no reader and would only grow
+        if (!isFineGrainedComponent(type)) continue;
+        writeU64(&out, set->dirtyCount);
+        writeBytes(&out, set->dirtyEntities, set->dirtyCount * sizeof(Entity));
+    }
+    for (Uint32 group = 0; group < GROUP_COUNT; group++) writeU64(&out, ecs->groups[group].size);
+    for (Uint64 i = 0; i < ecs->depGraph->nodeCount; i++) writeU8(&out, ecs->depGraph->nodes[i]->isDirty);
+
+    // The order the broadphase keeps from one tick to the next decides the order of the pairs
+    writeU8(&out, (Uint8)cm->broadphase);
+    if (cm->broadphase == BROADPHASE_INCREMENTAL) {
+        for (Uint32 cell = 0; cell < ARENA_WIDTH * ARENA_HEIGHT; cell++) {
+            writeU32(&out, (Uint32)cm->spatialGrid[cell].entityCount);
+            writeBytes(&out, cm->spatialGrid[cell].entities, cm->spatialGrid[cell].entityCount * sizeof(Entity));
+        }
+    } else if (cm->broadphase == BROADPHASE_SWEEP) {
+        writeU32(&out, cm->sweepList.count);
+        for (Uint32 i = 0; i < cm->sweepList.count; i++) writeU64(&out, cm->sweepList.entries[i].entity);
+    }
+
+    *size = out.size;
+    return out.data;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 restoreWorldSnapshot(ZENg zEngine, const Uint8 *data, Uint32 size) {
+    if (!zEngine || !data) THROW_ERROR_AND_RETURN("NULL argument in restoreWorldSnapshot", 0);
+    ECS ecs = zEngine->ecs;
+    CollisionManager cm = zEngine->collisionMng;
+    SnapshotReader in = {.data = data, .size = size};
+
+    Uint32 layout[SNAPSHOT_LAYOUT_SIZE], savedLayout[SNAPSHOT_LAYOUT_SIZE];
+    getLayout(ecs, layout);
+    readBytes(&in, savedLayout, sizeof(savedLayout));
+    if (in.failed || memcmp(layout, savedLayout, sizeof(layout)) != 0) {
+        THROW_ERROR_AND_RETURN("The world snapshot was taken by another build", 0);
+    }
+
+    clearECS(ecs);
+    PLAYER_ID = readU64(&in);
+
+    for (Uint32 row = 0; row < ARENA_HEIGHT; row++) {
+        for (Uint32 col = 0; col < ARENA_WIDTH; col++) {
+            TileType type = readU8(&in);
+            if (type >= TILE_COUNT) type = TILE_EMPTY;
+            if (zEngine->map->tiles[row][col].type == type) continue;
+            setArenaTile(zEngine->map, row, col, getTilePrefab(zEngine->prefabs, tileTypeNames[type]));
+        }
+    }
+
+    // The entities come back without components, the flags are set again as the components are restored
+    Uint64 capacity = readU64(&in);
+    ecsReserve(ecs, capacity);
+    readBytes(&in, ecs->generations, capacity * sizeof(Uint32));
+    for (Uint64 i = capacity; i < ecs->capacity; i++) ecs->generations[i] = ENTITY_FIRST_GENERATION;
+    memset(ecs->componentsFlags, 0, ecs->capacity * sizeof(bitset));
+    ecs->nextEntityID = readU64(&in);
+    ecs->entityCount = readU64(&in);
+    if (ecs->nextEntityID > capacity || ecs->entityCount > ecs->nextEntityID) in.failed = 1;
+    if (in.failed) ecs->entityCount = 0;
+    readBytes(&in, ecs->activeEntities, ecs->entityCount * sizeof(Entity));
+    for (Uint64 i = 0; i < ecs->entityCount; i++) ecs->entityToActiveIndex[ENTITY_INDEX(ecs->activeEntities[i])] = i;
+    ecs->freeEntityCount = readU64(&in);
+    if (ecs->freeEntityCount > ecs->freeEntityCapacity) in.failed = 1;
+    if (in.failed) ecs->freeEntityCount = 0;
+    readBytes(&in, ecs->freeEntities, ecs->freeEntityCount * sizeof(Entity));
+
+    for (ComponentType type = 0; type < COMPONENT_TYPE_COUNT && !in.failed; type++) {
+        ComponentTypeSet *set = &ecs->components[type];
+        Uint64 denseSize = readU64(&in);
+        if (denseSize > ecs->entityCount) in.failed = 1;
+        else ecsReserveComponent(ecs, type, denseSize);
+
+        Uint8 slot[set->elemSize];
+        for (Uint64 i = 0; i < denseSize && !in.failed; i++) {
+            Entity owner = readU64(&in);
+            readBytes(&in, slot, set->elemSize);
+            readComponentData(zEngine, &in, type, slot);
+            if (!restoreComponent(ecs, owner, type, slot)) in.failed = 1;
+        }
+
+        if (!isFineGrainedComponent(type) || in.failed) continue;
+        Uint64 dirtyCount = readU64(&in);
+        // Drained every tick, between two ticks it only holds the components added since, one entry each
+        if (dirtyCount > denseSize) in.failed = 1;
+        else readBytes(&in, restoreDirtyList(ecs, type, dirtyCount), dirtyCount * sizeof(Entity));
+    }
+    for (Uint32 group = 0; group < GROUP_COUNT; group++) ecs->groups[group].size = readU64(&in);
+    for (Uint64 i = 0; i < ecs->depGraph->nodeCount; i++) ecs->depGraph->nodes[i]->isDirty = readU8(&in);
+
+    // A broadphase switched since the snapshot starts over from the hitboxes
+    BroadphaseMode broadphase = readU8(&in);
+    if (broadphase == BROADPHASE_INCREMENTAL) {
+        for (Uint32 cell = 0; cell < ARENA_WIDTH * ARENA_HEIGHT && !in.failed; cell++) {
+            GridCell *gridCell = &cm->spatialGrid[cell];
+            gridCell->entityCount = 0;
+            Uint32 count = readU32(&in);
+            for (Uint32 i = 0; i < count && !in.failed; i++) insertEntityToSGCell(readU64(&in), gridCell);
+        }
+    } else if (broadphase == BROADPHASE_SWEEP) {
+        cm->sweepList.count = 0;
+        Uint32 count = readU32(&in);
+        for (Uint32 i = 0; i < count && !in.failed; i++) appendSweepEntry(&cm->sweepList, readU64(&in));
+    }
+    if (broadphase != cm->broadphase) refillBroadphase(cm, ecs, zEngine->jobs);
+
+    if (in.failed || in.pos != in.size) {
+        // Whatever got restored is dropped, the caller starts the match over
+        clearECS(ecs);
+        THROW_ERROR_AND_RETURN("World snapshot cut short or corrupted", 0);
+    }
+    return 1;
+}
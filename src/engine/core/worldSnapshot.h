@@ -0,0 +1,33 @@
+#ifndef WORLD_SNAPSHOT_H
+#define WORLD_SNAPSHOT_H
+
+// Snapshots of the simulated world, taken between ticks and restored exactly
+// A snapshot holds everything the next ticks depend on: the entities and their generations, every component set
+// in dense order, the dirty lists a system drains, the group ranges, the tiles and the broadphase's order.
+// Pointers are stored by what they point to: resources by key, hitboxes and render rectangles by value, weapon lists
+// by entity
+// The components are stored in the host's layout, a snapshot only loads back into the same build
+
+#include "global/global.h"
+
+#define SNAPSHOT_MAGIC 0x53575343  // "CSWS"
+
+/**
+ * Saves the world as it is between two ticks
+ * @param zEngine pointer to the engine
+ * @param size where the size of the snapshot in bytes is written
+ * @return Uint8 * = the snapshot, to be freed by the caller
+ */
+Uint8* saveWorldSnapshot(ZENg zEngine, Uint32 *size);
+
+/**
+ * Replaces the world with a snapshot of it
+ * @param zEngine pointer to the engine
+ * @param data the snapshot
+ * @param size size of the snapshot in bytes
+ * @return 1 on success, 0 if the snapshot comes from another build, the world is left untouched then
+ * @note every entity is deleted first, whatever state it belongs to, so the UI may not hold on to components
+ */
+Uint8 restoreWorldSnapshot(ZENg zEngine, const Uint8 *data, Uint32 size);
+
+#endif // WORLD_SNAPSHOT_H
@@ -11,6 +11,7 @@ typedef struct displaymng {
     Uint32 wdwFlags;  // fullscreen, borderless, etc.
     Uint8 fullscreen;
     Uint8 vsync;
+    Uint32 drawCalls;  // Copies the render system issued for the world during the last frame
 } *DisplayManager;
 
 /**
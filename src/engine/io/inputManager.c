@@ -1,4 +1,5 @@
 #include "inputManager.h"
+#include "inputReplay.h"
 
 void saveKeyBindings(InputManager inputMng, const char *filePath) {
     FILE *fout = fopen(filePath, "w");
@@ -19,7 +20,8 @@ void saveKeyBindings(InputManager inputMng, const char *filePath) {
         "SECONDARY_SHOOT",
         "SWITCH_RIGHT",
         "SWITCH_LEFT",
-        "SPECIAL"
+        "SPECIAL",
+        "PERF_OVERLAY"
     };
 
     fprintf(fout, "[INPUT]\n");
@@ -52,6 +54,36 @@ void setDefaultBindings(InputManager inputMng) {
     inputMng->bindings[INPUT_SWITCH_RIGHT] = SDL_SCANCODE_E;
     inputMng->bindings[INPUT_SWITCH_LEFT] = SDL_SCANCODE_Q;
     inputMng->bindings[INPUT_SPECIAL] = SDL_SCANCODE_L;
+    inputMng->bindings[INPUT_PERF_OVERLAY] = SDL_SCANCODE_F3;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void queueActionTap(InputManager inputMng, InputAction action) {
+    if (!inputMng || action >= INPUT_UNKNOWN) return;
+    inputMng->pendingTaps |= ACTION_BIT(action);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void sampleInput(InputManager inputMng) {
+    if (!inputMng) THROW_ERROR_AND_RETURN_VOID("Input manager is NULL in sampleInput");
+
+    inputMng->keyboardState = SDL_GetKeyboardState(NULL);
+    Uint32 held = 0;
+    for (InputAction action = 0; action < INPUT_UNKNOWN; action++) {
+        if (inputMng->keyboardState[inputMng->bindings[action]]) held |= ACTION_BIT(action);
+    }
+    Uint32 tapped = inputMng->pendingTaps;
+    inputMng->pendingTaps = 0;
+
+    if (inputMng->replay) replayInput(inputMng->replay, &held, &tapped);
+    inputMng->heldActions = held;
+    inputMng->tappedActions = tapped;
 }
 
 /**
@@ -59,7 +91,15 @@ void setDefaultBindings(InputManager inputMng) {
  */
 
 Uint8 isActionPressed(InputManager inputMng, InputAction action) {
-    return inputMng->keyboardState[inputMng->bindings[action]];
+    return (inputMng->heldActions & ACTION_BIT(action)) != 0;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 isActionTapped(InputManager inputMng, InputAction action) {
+    return (inputMng->tappedActions & ACTION_BIT(action)) != 0;
 }
 
 /**
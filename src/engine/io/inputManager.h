@@ -17,13 +17,22 @@ typedef enum {
     INPUT_SWITCH_RIGHT,
     INPUT_SWITCH_LEFT,
     INPUT_SPECIAL,
+    INPUT_PERF_OVERLAY,
     INPUT_UNKNOWN,
     INPUT_ACTION_COUNT  // automatically counts
 } InputAction;
 
+#define ACTION_BIT(action) ((Uint32)1 << (action))  // Bit of an action in the per-tick action masks
+
+struct inputReplay;  // forward declaration
+
 typedef struct inputmng {
     const Uint8 *keyboardState;  // current keyboard state
     SDL_Scancode bindings[INPUT_ACTION_COUNT];  // input configuration
+    Uint32 heldActions;  // one bit per action held during the current tick
+    Uint32 tappedActions;  // one bit per action pressed since the previous tick
+    Uint32 pendingTaps;  // presses received from events, handed to the next tick
+    struct inputReplay *replay;  // recording or playback in progress, NULL otherwise
 } *InputManager;
 
 /**
@@ -42,12 +51,34 @@ void saveKeyBindings(InputManager inputMng, const char *filePath);
 void setDefaultBindings(InputManager inputMng);
 
 /**
- * Checks if an action is currently pressed
+ * Queues a key press for the next simulation tick
+ * @param inputMng pointer to the input manager
+ * @param action the action that was pressed
+ * @note event handlers call it so one-shot actions are seen by the tick, and recorded with it
+ */
+void queueActionTap(InputManager inputMng, InputAction action);
+
+/**
+ * Samples the action states for the current simulation tick
+ * @param inputMng pointer to the input manager
+ * @note while recording the states are written to the replay, during playback they are replaced by the recorded ones
+ */
+void sampleInput(InputManager inputMng);
+
+/**
+ * Checks if an action is held during the current tick
  * @param inputMng pointer to the input manager
  * @param action enum type of the action to check
  */
 Uint8 isActionPressed(InputManager inputMng, InputAction action);
 
+/**
+ * Checks if an action was pressed right before the current tick
+ * @param inputMng pointer to the input manager
+ * @param action enum type of the action to check
+ */
+Uint8 isActionTapped(InputManager inputMng, InputAction action);
+
 /**
  * Translates a SDL scancode to an engine action
  * @param inputMng pointer to the input manager
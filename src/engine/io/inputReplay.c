@@ -0,0 +1,329 @@
+#include "inputReplay.h"
+
+/**
+ * Writes an integer in little endian, whatever the host's byte order
+ * @param file the output file
+ * @param value the value to write
+ * @param bytes number of low-order bytes to write
+ */
+static void writeLE(FILE *file, Uint64 value, Uint8 bytes) {
+    Uint8 buff[8];
+    for (Uint8 i = 0; i < bytes; i++) buff[i] = (Uint8)(value >> (8 * i));
+    fwrite(buff, 1, bytes, file);
+}
+
+/**
+ * Reads a little endian integer
+ * @param file the input file
+ * @param bytes number of bytes to read
+ * @param value where the value is written
+ * @return 1 on success, 0 at the end of the file
+ */
+static Uint8 readLE(FILE *file, Uint8 bytes, Uint64 *value) {
+    Uint8 buff[8];
+    if (fread(buff, 1, bytes, file) != bytes) return 0;
+    *value = 0;
+    for (Uint8 i = 0; i < bytes; i++) *value |= (Uint64)buff[i] << (8 * i);
+    return 1;
+}
+
+/**
+ * Appends an element to one of the replay's growable arrays
+ * @param array pointer to the array
+ * @param count pointer to the number of elements
+ * @param capacity pointer to the capacity
+ * @param elemSize size of an element in bytes
+ * @param elem the element to append
+ */
+static void appendElem(void **array, Uint32 *count, Uint32 *capacity, size_t elemSize, const void *elem) {
+    if (*count >= *capacity) {
+        Uint32 newCapacity = *capacity ? *capacity * 2 : 64;
+        void *tmp = realloc(*array, newCapacity * elemSize);
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to grow a replay array");
+        *array = tmp;
+        *capacity = newCapacity;
+    }
+    memcpy((Uint8 *)*array + (*count)++ * elemSize, elem, elemSize);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+InputReplay startRecording(const char *filePath, Uint32 seed, Uint32 tickRate) {
+    if (!filePath) THROW_ERROR_AND_RETURN("Replay file path is NULL", NULL);
+
+    InputReplay replay = calloc(1, sizeof(struct inputReplay));
+    if (!replay) THROW_ERROR_AND_EXIT("Failed to allocate memory for the input replay");
+
+    replay->file = fopen(filePath, "wb");
+    if (!replay->file) {
+        free(replay);
+        THROW_ERROR_AND_DO("Failed to create replay file ", fprintf(stderr, "'%s'\n", filePath); return NULL;);
+    }
+    replay->mode = REPLAY_RECORDING;
+    replay->seed = seed;
+    replay->tickRate = tickRate;
+    replay->keyframeInterval = REPLAY_KEYFRAME_INTERVAL;
+    srand(seed);
+
+    writeLE(replay->file, REPLAY_MAGIC, 4);
+    writeLE(replay->file, REPLAY_VERSION, 2);
+    writeLE(replay->file, tickRate, 2);
+    writeLE(replay->file, seed, 4);
+    writeLE(replay->file, replay->keyframeInterval, 4);
+
+    printf("Recording input to %s, seed %u\n", filePath, seed);
+    return replay;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+InputReplay loadReplay(const char *filePath) {
+    if (!filePath) THROW_ERROR_AND_RETURN("Replay file path is NULL", NULL);
+
+    FILE *fin = fopen(filePath, "rb");
+    if (!fin) THROW_ERROR_AND_DO("Failed to open replay file ", fprintf(stderr, "'%s'\n", filePath); return NULL;);
+
+    Uint64 magic = 0, version = 0, tickRate = 0, seed = 0, interval = 0;
+    if (
+        !readLE(fin, 4, &magic) || !readLE(fin, 2, &version) || !readLE(fin, 2, &tickRate)
+        || !readLE(fin, 4, &seed) || !readLE(fin, 4, &interval)
+        || magic != REPLAY_MAGIC || version != REPLAY_VERSION || interval == 0
+    ) {
+        fclose(fin);
+        THROW_ERROR_AND_DO("Not a replay file or wrong version: ", fprintf(stderr, "'%s'\n", filePath); return NULL;);
+    }
+
+    InputReplay replay = calloc(1, sizeof(struct inputReplay));
+    if (!replay) THROW_ERROR_AND_EXIT("Failed to allocate memory for the input replay");
+    replay->mode = REPLAY_PLAYBACK;
+    replay->tickRate = (Uint32)tickRate;
+    replay->seed = (Uint32)seed;
+    replay->keyframeInterval = (Uint32)interval;
+
+    Uint64 tag = 0, tick = 0, a = 0, b = 0;
+    Uint8 ended = 0;
+    while (!ended && readLE(fin, 1, &tag) && readLE(fin, 4, &tick)) {
+        switch (tag) {
+            case REPLAY_RECORD_INPUT: {
+                if (!readLE(fin, 4, &a) || !readLE(fin, 4, &b)) break;
+                ReplayInput input = {.tick = (Uint32)tick, .held = (Uint32)a, .tapped = (Uint32)b};
+                appendElem(
+                    (void **)&replay->inputs, &replay->inputCount, &replay->inputCapacity, sizeof(ReplayInput), &input
+                );
+                break;
+            }
+            case REPLAY_RECORD_KEYFRAME: {
+                Uint64 snapshotSize = 0;
+                if (!readLE(fin, 8, &a) || !readLE(fin, 4, &b) || !readLE(fin, 4, &snapshotSize)) break;
+                ReplayKeyframe keyframe = {.tick = (Uint32)tick, .checksum = a, .entityCount = (Uint32)b};
+                if (snapshotSize) {
+                    keyframe.snapshot = malloc(snapshotSize);
+                    if (!keyframe.snapshot) THROW_ERROR_AND_EXIT("Failed to allocate memory for a replay snapshot");
+                    keyframe.snapshotSize = (Uint32)snapshotSize;
+                    if (fread(keyframe.snapshot, 1, snapshotSize, fin) != snapshotSize) {
+                        free(keyframe.snapshot);
+                        break;
+                    }
+                }
+                appendElem(
+                    (void **)&replay->keyframes, &replay->keyframeCount, &replay->keyframeCapacity,
+                    sizeof(ReplayKeyframe), &keyframe
+                );
+                break;
+            }
+            case REPLAY_RECORD_END: {
+                replay->endTick = (Uint32)tick;
+                ended = 1;
+                break;
+            }
+            default: {
+                THROW_ERROR_AND_DO("Unknown replay record ", fprintf(stderr, "%lu, stopping there\n", tag););
+                ended = 1;
+                break;
+            }
+        }
+    }
+    fclose(fin);
+
+    // A recording cut short still plays up to its last input
+    if (!ended) {
+        fprintf(stderr, "Replay %s has no end record, it was probably cut short\n", filePath);
+        if (replay->inputCount > 0) replay->endTick = replay->inputs[replay->inputCount - 1].tick + 1;
+    }
+
+    srand(replay->seed);
+    printf(
+        "Loaded replay %s: %u ticks at %u ticks/s, %u input changes, %u keyframes\n",
+        filePath, replay->endTick, replay->tickRate, replay->inputCount, replay->keyframeCount
+    );
+    return replay;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void replayInput(InputReplay replay, Uint32 *held, Uint32 *tapped) {
+    if (!replay || !held || !tapped) THROW_ERROR_AND_RETURN_VOID("NULL argument in replayInput");
+
+    if (replay->mode == REPLAY_RECORDING) {
+        // Only the changes are stored, a tap is always a change
+        if (*held != replay->last.held || *tapped) {
+            writeLE(replay->file, REPLAY_RECORD_INPUT, 1);
+            writeLE(replay->file, replay->tick, 4);
+            writeLE(replay->file, *held, 4);
+            writeLE(replay->file, *tapped, 4);
+        }
+        replay->last = (ReplayInput) {.tick = replay->tick, .held = *held, .tapped = *tapped};
+        return;
+    }
+
+    // The recorded taps only last for the tick they were recorded on
+    replay->last.tapped = 0;
+    while (replay->nextInput < replay->inputCount && replay->inputs[replay->nextInput].tick <= replay->tick) {
+        replay->last = replay->inputs[replay->nextInput++];
+    }
+    *held = isReplayFinished(replay) ? 0 : replay->last.held;
+    *tapped = isReplayFinished(replay) || replay->last.tick != replay->tick ? 0 : replay->last.tapped;
+}
+
+/**
+ * Compares the world with the keyframe recorded at the current tick, if there is one
+ * @param replay the InputReplay being played
+ * @param checksum checksum of the world after the tick
+ * @param entityCount number of live entities after the tick
+ */
+static void checkKeyframe(InputReplay replay, Uint64 checksum, Uint32 entityCount) {
+    if (replay->nextKeyframe >= replay->keyframeCount) return;
+    ReplayKeyframe *keyframe = &replay->keyframes[replay->nextKeyframe];
+    if (keyframe->tick != replay->tick) return;
+    replay->nextKeyframe++;
+
+    if (keyframe->checksum != checksum) {
+        replay->desyncs++;
+        fprintf(
+            stderr, "Replay desync at tick %u: checksum %016lx, expected %016lx (%u entities, expected %u)\n",
+            replay->tick, checksum, keyframe->checksum, entityCount, keyframe->entityCount
+        );
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 isKeyframeDue(InputReplay replay) {
+    return replay && replay->mode == REPLAY_RECORDING && (replay->tick + 1) % replay->keyframeInterval == 0;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void replayEndTick(
+    InputReplay replay, Uint64 checksum, Uint32 entityCount, const Uint8 *snapshot, Uint32 snapshotSize
+) {
+    if (!replay) THROW_ERROR_AND_RETURN_VOID("Replay is NULL in replayEndTick");
+
+    replay->tick++;
+    if (replay->tick % replay->keyframeInterval == 0) {
+        if (replay->mode == REPLAY_RECORDING) {
+            if (!snapshot) snapshotSize = 0;
+            writeLE(replay->file, REPLAY_RECORD_KEYFRAME, 1);
+            writeLE(replay->file, replay->tick, 4);
+            writeLE(replay->file, checksum, 8);
+            writeLE(replay->file, entityCount, 4);
+            writeLE(replay->file, snapshotSize, 4);
+            if (snapshotSize) fwrite(snapshot, 1, snapshotSize, replay->file);
+        } else checkKeyframe(replay, checksum, entityCount);
+    }
+
+    if (replay->mode == REPLAY_PLAYBACK && replay->tick == replay->endTick) {
+        printf("Replay finished after %u ticks, %u desynced keyframes\n", replay->tick, replay->desyncs);
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void rewindReplay(InputReplay replay) {
+    if (!replay || replay->mode != REPLAY_PLAYBACK) THROW_ERROR_AND_RETURN_VOID("Only a playback can be rewound");
+
+    replay->tick = 0;
+    replay->nextInput = 0;
+    replay->nextKeyframe = 0;
+    replay->last = (ReplayInput) {0};
+    srand(replay->seed);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+const ReplayKeyframe* findReplayKeyframe(InputReplay replay, Uint32 tick) {
+    if (!replay) THROW_ERROR_AND_RETURN("Replay is NULL in findReplayKeyframe", NULL);
+
+    // The keyframes are in tick order
+    const ReplayKeyframe *found = NULL;
+    for (Uint32 i = 0; i < replay->keyframeCount && replay->keyframes[i].tick <= tick; i++) {
+        if (replay->keyframes[i].snapshot) found = &replay->keyframes[i];
+    }
+    return found;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void jumpToKeyframe(InputReplay replay, const ReplayKeyframe *keyframe) {
+    if (!replay || replay->mode != REPLAY_PLAYBACK || !keyframe) {
+        THROW_ERROR_AND_RETURN_VOID("Only a playback can jump to one of its keyframes");
+    }
+
+    replay->tick = keyframe->tick;
+    replay->nextKeyframe = (Uint32)(keyframe - replay->keyframes) + 1;
+
+    // The input in effect at the keyframe is the last change before it, its taps are long gone
+    replay->nextInput = 0;
+    replay->last = (ReplayInput) {0};
+    while (replay->nextInput < replay->inputCount && replay->inputs[replay->nextInput].tick < replay->tick) {
+        replay->last = replay->inputs[replay->nextInput++];
+    }
+    replay->last.tapped = 0;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 isReplayFinished(InputReplay replay) {
+    return replay && replay->mode == REPLAY_PLAYBACK && replay->tick >= replay->endTick;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void freeReplay(InputReplay *replay) {
+    if (!replay || !*replay) return;
+
+    if ((*replay)->mode == REPLAY_RECORDING) {
+        writeLE((*replay)->file, REPLAY_RECORD_END, 1);
+        writeLE((*replay)->file, (*replay)->tick, 4);
+        fclose((*replay)->file);
+        printf("Recorded %u ticks\n", (*replay)->tick);
+    } else if ((*replay)->desyncs) {
+        fprintf(stderr, "Replay desynced on %u keyframes\n", (*replay)->desyncs);
+    }
+
+    free((*replay)->inputs);
+    for (Uint32 i = 0; i < (*replay)->keyframeCount; i++) free((*replay)->keyframes[i].snapshot);
+    free((*replay)->keyframes);
+    free(*replay);
+    *replay = NULL;
+}
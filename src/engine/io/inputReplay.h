@@ -0,0 +1,149 @@
+#ifndef INPUT_REPLAY_H
+#define INPUT_REPLAY_H
+
+// Deterministic input recording and playback
+// The simulation only depends on the per-tick action states and the RNG seed, so storing those is enough
+// to play a match again. Keyframes with a checksum and a snapshot of the world are written every few seconds,
+// the checksums detect desyncs and the snapshots are the points playback can seek to
+//
+// File layout, little endian:
+//   header:   magic u32, version u16, tick rate u16, seed u32, keyframe interval u32
+//   records:  tag u8 followed by the record's fields
+//     input     tick u32, held actions u32, tapped actions u32   (only written when the input changes)
+//     keyframe  tick u32, world checksum u64, entity count u32, snapshot size u32, snapshot bytes
+//     end       tick u32
+// The snapshots are opaque here, see worldSnapshot.h. The RNG state isn't in them, the simulation doesn't draw from it
+
+#include "global/global.h"
+
+#define REPLAY_MAGIC 0x50525343  // "CSRP"
+#define REPLAY_VERSION 2  // 2 added the world snapshots to the keyframes
+#define REPLAY_KEYFRAME_INTERVAL 600  // Ticks between keyframes, 10 seconds at the default tick rate
+
+typedef enum {
+    REPLAY_RECORDING,  // Writing the live input to a file
+    REPLAY_PLAYBACK,  // Feeding the input read from a file
+    REPLAY_MODE_COUNT  // Automatically counts
+} ReplayMode;
+
+typedef enum {
+    REPLAY_RECORD_INPUT = 1,
+    REPLAY_RECORD_KEYFRAME,
+    REPLAY_RECORD_END
+} ReplayRecordTag;
+
+typedef struct {
+    Uint32 tick;  // First tick the input applies to
+    Uint32 held;  // One bit per action held
+    Uint32 tapped;  // One bit per action pressed right before the tick
+} ReplayInput;
+
+typedef struct {
+    Uint32 tick;  // Tick after which the checksum was taken
+    Uint64 checksum;  // Checksum of the world's simulated state
+    Uint32 entityCount;  // Number of live entities, reported on a mismatch
+    Uint8 *snapshot;  // The world after the tick, NULL if the recording had none to give
+    Uint32 snapshotSize;  // Size of the snapshot in bytes
+} ReplayKeyframe;
+
+typedef struct inputReplay {
+    ReplayMode mode;  // Recording or playback
+    FILE *file;  // Output file while recording
+    Uint32 seed;  // Seed the RNG was given when the match started
+    Uint32 tickRate;  // Tick rate of the recorded match, playback must run at the same one
+    Uint32 keyframeInterval;  // Ticks between keyframes
+    Uint32 tick;  // Ticks simulated since the match started
+    Uint32 endTick;  // Length of the recording, in ticks
+
+    ReplayInput *inputs;  // Input changes read from the file
+    Uint32 inputCount;  // Number of input changes
+    Uint32 inputCapacity;  // Capacity of the inputs array
+    Uint32 nextInput;  // Index of the next input change to apply
+    ReplayInput last;  // Input of the previous tick
+
+    ReplayKeyframe *keyframes;  // Keyframes read from the file
+    Uint32 keyframeCount;  // Number of keyframes
+    Uint32 keyframeCapacity;  // Capacity of the keyframes array
+    Uint32 nextKeyframe;  // Index of the next keyframe to check
+    Uint32 desyncs;  // Keyframes whose checksum didn't match during playback
+} *InputReplay;
+
+/**
+ * Starts recording to a file and seeds the RNG
+ * @param filePath path to the replay file, overwritten if it exists
+ * @param seed seed for the RNG
+ * @param tickRate simulation ticks per second
+ * @return InputReplay = struct inputReplay*, NULL if the file can't be created
+ */
+InputReplay startRecording(const char *filePath, Uint32 seed, Uint32 tickRate);
+
+/**
+ * Reads a replay file for playback and seeds the RNG with the recorded seed
+ * @param filePath path to the replay file
+ * @return InputReplay = struct inputReplay*, NULL if the file is missing or malformed
+ */
+InputReplay loadReplay(const char *filePath);
+
+/**
+ * Records or overrides the action states of the current tick
+ * @param replay the InputReplay
+ * @param held one bit per action held, replaced by the recorded ones during playback
+ * @param tapped one bit per action pressed before the tick, replaced by the recorded ones during playback
+ */
+void replayInput(InputReplay replay, Uint32 *held, Uint32 *tapped);
+
+/**
+ * Tells whether the tick being simulated ends on a keyframe that gets recorded
+ * @param replay the InputReplay
+ * @return 1 if replayEndTick wants a snapshot of the world after this tick, 0 otherwise
+ */
+Uint8 isKeyframeDue(InputReplay replay);
+
+/**
+ * Ends the current tick, writing or checking a keyframe when one is due
+ * @param replay the InputReplay
+ * @param checksum checksum of the world after the tick
+ * @param entityCount number of live entities after the tick
+ * @param snapshot snapshot of the world after the tick, written with a recorded keyframe, may be NULL
+ * @param snapshotSize size of the snapshot in bytes
+ */
+void replayEndTick(
+    InputReplay replay, Uint64 checksum, Uint32 entityCount, const Uint8 *snapshot, Uint32 snapshotSize
+);
+
+/**
+ * Rewinds playback to the start of the match, to be followed by simulating up to the wanted tick
+ * @param replay the InputReplay
+ * @note the RNG is seeded again, so the ticks simulated after it match the recording
+ */
+void rewindReplay(InputReplay replay);
+
+/**
+ * Finds the last keyframe with a snapshot at or before a tick
+ * @param replay the InputReplay
+ * @param tick the tick
+ * @return const ReplayKeyframe * = the keyframe, NULL if none comes that early
+ */
+const ReplayKeyframe* findReplayKeyframe(InputReplay replay, Uint32 tick);
+
+/**
+ * Moves playback to a keyframe, once the world was restored from its snapshot
+ * @param replay the InputReplay
+ * @param keyframe one of the replay's keyframes
+ * @note the input and keyframes after it play on from there, the ones before it are skipped
+ */
+void jumpToKeyframe(InputReplay replay, const ReplayKeyframe *keyframe);
+
+/**
+ * @param replay the InputReplay
+ * @return 1 once playback went past the end of the recording, 0 otherwise
+ */
+Uint8 isReplayFinished(InputReplay replay);
+
+/**
+ * Finishes the recording if one is running and frees the replay
+ * @param replay pointer to the InputReplay
+ */
+void freeReplay(InputReplay *replay);
+
+#endif // INPUT_REPLAY_H
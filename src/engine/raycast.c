@@ -0,0 +1,191 @@
+#include "raycast.h"
+
+/**
+ * Shared state of the batch's parallel loop
+ */
+typedef struct {
+    RayBatch *batch;  // The rays
+    const Uint64 *stops;  // One row of bits per row of the arena, a set bit is a tile that stops the rays
+} RayJob;
+
+/**
+ * Gets the rows of the tiles a mask stops rays on
+ * @param arena the arena
+ * @param mask which tile layers stop the ray, see RAY_MASK
+ * @param merged room for the rows, used when the mask has more than one layer
+ * @return const Uint64 * = ARENA_HEIGHT rows of bits
+ */
+static const Uint64 *getStopRows(Arena arena, Uint8 mask, Uint64 merged[ARENA_HEIGHT]) {
+    // A single layer is read in place
+    for (Uint32 layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+        if (mask == RAY_MASK(layer)) return arena->layers[layer];
+    }
+
+    for (Uint32 row = 0; row < ARENA_HEIGHT; row++) {
+        merged[row] = 0;
+        for (Uint32 layer = 0; layer < TILE_LAYER_COUNT; layer++) {
+            if (mask & RAY_MASK(layer)) merged[row] |= arena->layers[layer][row];
+        }
+    }
+    return merged;
+}
+
+/**
+ * Walks a ray through the tiles it crosses, in order, until one of them stops it
+ * @param stops one row of bits per row of the arena, a set bit is a tile that stops the ray
+ * @param from where the ray starts
+ * @param to where the ray ends
+ * @param hit where the tile that stopped the ray is described, may be NULL
+ * @return Uint8 = 1 if a tile stopped the ray before it reached its target, 0 otherwise
+ */
+static Uint8 castRay(const Uint64 *stops, Vec2 from, Vec2 to, RayHit *hit) {
+    double_t tile = (double_t)TILE_SIZE;
+    double_t dx = to.x - from.x, dy = to.y - from.y;
+
+    // Clip the ray to the arena (Liang-Barsky), nothing outside of it can stop the ray
+    double_t tEnter = 0.0, tExit = 1.0;
+    Vec2 normal = {0.0, 0.0};
+    const double_t deltas[2] = {dx, dy}, starts[2] = {from.x, from.y};
+    const double_t sizes[2] = {ARENA_WIDTH * tile, ARENA_HEIGHT * tile};
+    for (Uint8 axis = 0; axis < 2; axis++) {
+        if (deltas[axis] == 0.0) {
+            if (starts[axis] < 0.0 || starts[axis] >= sizes[axis]) return 0;
+            continue;
+        }
+        double_t t0 = -starts[axis] / deltas[axis], t1 = (sizes[axis] - starts[axis]) / deltas[axis];
+        if (t0 > t1) {
+            double_t tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+        }
+        if (t0 > tEnter) {
+            // Comes in from outside through this side of the arena
+            tEnter = t0;
+            normal = axis == 0 ? (Vec2){deltas[0] > 0 ? -1.0 : 1.0, 0.0} : (Vec2){0.0, deltas[1] > 0 ? -1.0 : 1.0};
+        }
+        if (t1 < tExit) tExit = t1;
+    }
+    if (tEnter >= tExit) return 0;  // Misses the arena
+
+    // The first tile, a ray coming in right on the far edge belongs to the last row or column
+    Int32 col = (Int32)floor((from.x + dx * tEnter) / tile);
+    Int32 row = (Int32)floor((from.y + dy * tEnter) / tile);
+    if (col >= ARENA_WIDTH) col = ARENA_WIDTH - 1;
+    if (row >= ARENA_HEIGHT) row = ARENA_HEIGHT - 1;
+    if (col < 0) col = 0;
+    if (row < 0) row = 0;
+
+    // When the ray crosses its next column and row boundaries, and how long it takes to cross a whole tile
+    Int32 stepX = dx > 0 ? 1 : -1, stepY = dy > 0 ? 1 : -1;
+    double_t nextX = dx != 0.0 ? ((dx > 0 ? col + 1 : col) * tile - from.x) / dx : INFINITY;
+    double_t nextY = dy != 0.0 ? ((dy > 0 ? row + 1 : row) * tile - from.y) / dy : INFINITY;
+    double_t stepTX = dx != 0.0 ? tile / fabs(dx) : INFINITY;
+    double_t stepTY = dy != 0.0 ? tile / fabs(dy) : INFINITY;
+
+    double_t t = tEnter;
+    for (;;) {
+        Uint32 tileIdx = row * ARENA_WIDTH + col;
+        if ((stops[row] >> col) & 1) {
+            if (hit) {
+                *hit = (RayHit){
+                    .tileIdx = tileIdx, .t = t, .point = {from.x + dx * t, from.y + dy * t}, .normal = normal
+                };
+            }
+            return 1;
+        }
+
+        if (nextX < nextY) {
+            t = nextX;
+            col += stepX;
+            nextX += stepTX;
+            normal = (Vec2){-stepX, 0.0};
+        } else {
+            t = nextY;
+            row += stepY;
+            nextY += stepTY;
+            normal = (Vec2){0.0, -stepY};
+        }
+        // Reached the target, or left the arena
+        if (t >= tExit || col < 0 || col >= ARENA_WIDTH || row < 0 || row >= ARENA_HEIGHT) return 0;
+    }
+}
+
+/**
+ * Casts a slice of a batch
+ * @param data the RayJob
+ * @param start index of the first ray
+ * @param end index past the last ray
+ */
+static void castRayRange(void *data, Uint64 start, Uint64 end) {
+    RayJob *job = data;
+    RayBatch *batch = job->batch;
+
+    for (Uint64 i = start; i < end; i++) {
+        RayHit hit;
+        Vec2 from = {batch->fromX[i], batch->fromY[i]}, to = {batch->toX[i], batch->toY[i]};
+        if (castRay(job->stops, from, to, &hit)) {
+            batch->t[i] = hit.t;
+            batch->tileIdx[i] = hit.tileIdx;
+        } else {
+            batch->t[i] = 1.0;
+            batch->tileIdx[i] = RAY_NO_HIT;
+        }
+    }
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 raycastTiles(Arena arena, Vec2 from, Vec2 to, Uint8 mask, RayHit *hit) {
+    if (!arena || !arena->tiles) THROW_ERROR_AND_RETURN("Arena NULL in raycastTiles", 0);
+    Uint64 merged[ARENA_HEIGHT];
+    return castRay(getStopRows(arena, mask, merged), from, to, hit);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+Uint8 hasLineOfSight(Arena arena, Vec2 from, Vec2 to, Uint8 mask) {
+    if (!arena || !arena->tiles) THROW_ERROR_AND_RETURN("Arena NULL in hasLineOfSight", 0);
+    Uint64 merged[ARENA_HEIGHT];
+    return !castRay(getStopRows(arena, mask, merged), from, to, NULL);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void allocRayBatch(RayBatch *batch, Uint32 count, FrameArena *frameArena) {
+    if (!batch) THROW_ERROR_AND_RETURN_VOID("Ray batch is NULL in allocRayBatch");
+
+    double_t **fields[] = {&batch->fromX, &batch->fromY, &batch->toX, &batch->toY, &batch->t};
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        *fields[i] = frameAlloc(frameArena, count * sizeof(double_t));
+    }
+    batch->tileIdx = frameAlloc(frameArena, count * sizeof(Uint32));
+    batch->count = count;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void raycastTilesBatch(Arena arena, RayBatch *batch, Uint8 mask, JobSystem jobs) {
+    if (!arena || !arena->tiles || !batch) THROW_ERROR_AND_RETURN_VOID("Arena or batch NULL in raycastTilesBatch");
+    PROFILE_BEGIN(zone, "raycastTilesBatch");
+
+    // 288 bytes instead of the Tile structs, the rays of the whole batch read them from the cache
+    Uint64 merged[ARENA_HEIGHT];
+    const Uint64 *stops = getStopRows(arena, mask, merged);
+
+    // One chunk per worker, unless that leaves them too little to do
+    Uint32 workers = getJobWorkerCount(jobs);
+    Uint64 chunkSize = (batch->count + workers - 1) / workers;
+    if (chunkSize < RAY_BATCH_MIN_CHUNK) chunkSize = RAY_BATCH_MIN_CHUNK;
+
+    RayJob job = {.batch = batch, .stops = stops};
+    parallelFor(jobs, batch->count, chunkSize, castRayRange, &job);
+    PROFILE_END(zone);
+}
@@ -0,0 +1,77 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+// Tile raycasts
+// A ray visits the tiles it crosses in order, one tile boundary per step (Amanatides-Woo DDA), and stops on the
+// first tile the mask says blocks it. Line of sight, hitscan weapons and the AI's visibility checks all build on it
+
+#include "engine/arena.h"
+#include "engine/core/jobSystem.h"
+
+#define RAY_NO_HIT UINT32_MAX  // Tile index of a ray nothing stopped
+#define RAY_BATCH_MIN_CHUNK 256  // Fewest rays a worker takes on in a batch
+
+// The tile layers that stop a ray, combine them with |
+#define RAY_MASK(layer) (1u << (layer))
+
+typedef struct {
+    Uint32 tileIdx;  // Index of the tile that stopped the ray
+    double_t t;  // Fraction of the way to the target at which the ray entered that tile
+    Vec2 point;  // Where the ray entered that tile
+    Vec2 normal;  // Normal of the side of the tile the ray entered through, zero if the ray started inside it
+} RayHit;
+
+/**
+ * SoA batch of rays, every array holds count elements and lives in the frame arena
+ */
+typedef struct {
+    double_t *fromX;  // Origins on the X axis
+    double_t *fromY;  // Origins on the Y axis
+    double_t *toX;  // Targets on the X axis
+    double_t *toY;  // Targets on the Y axis
+    double_t *t;  // Filled in by the cast, fraction of the way at which each ray was stopped, 1 if it wasn't
+    Uint32 *tileIdx;  // Filled in by the cast, tile that stopped each ray, RAY_NO_HIT if none did
+    Uint32 count;  // Number of rays in the batch
+} RayBatch;
+
+/**
+ * Casts a ray through the arena's tiles
+ * @param arena the arena
+ * @param from where the ray starts, in world coordinates
+ * @param to where the ray ends, in world coordinates
+ * @param mask which tiles stop the ray, see RAY_MASK
+ * @param hit where the tile that stopped the ray is described, may be NULL
+ * @return Uint8 = 1 if a tile stopped the ray before it reached its target, 0 otherwise
+ * @note the parts of the ray outside the arena cross nothing
+ */
+Uint8 raycastTiles(Arena arena, Vec2 from, Vec2 to, Uint8 mask, RayHit *hit);
+
+/**
+ * Checks whether the segment between two points crosses no blocking tile
+ * @param arena the arena
+ * @param from one end, in world coordinates
+ * @param to the other end, in world coordinates
+ * @param mask which tiles block the view, see RAY_MASK
+ * @return Uint8 = 1 if nothing is in the way, 0 otherwise
+ */
+Uint8 hasLineOfSight(Arena arena, Vec2 from, Vec2 to, Uint8 mask);
+
+/**
+ * Carves the arrays of a ray batch out of the frame arena
+ * @param batch pointer to the RayBatch
+ * @param count number of rays the batch holds
+ * @param frameArena pointer to the FrameArena, the arrays are gone once it is reset
+ */
+void allocRayBatch(RayBatch *batch, Uint32 count, FrameArena *frameArena);
+
+/**
+ * Casts every ray of a batch, split across the workers
+ * @param arena the arena
+ * @param batch the rays, their t and tileIdx arrays are filled in
+ * @param mask which tiles stop the rays, see RAY_MASK
+ * @param jobs the job system
+ * @note the mask's layers are merged once up front, so the rays only read a bit per tile they cross
+ */
+void raycastTilesBatch(Arena arena, RayBatch *batch, Uint8 mask, JobSystem jobs);
+
+#endif // RAYCAST_H
@@ -7,6 +7,7 @@ SDL_Texture* getTexture(HashMap resMng, const char *key) {
     if (entry && entry->type == ENTRY_TEXTURE) {
         return (SDL_Texture *)entry->data.ptr;
     }
+    if (entry && entry->type == ENTRY_RESOURCE_STUB) return NULL;
     THROW_ERROR_AND_DO("Texture with key ", fprintf(stderr, "'%s' not found\n", key); return NULL;);
 }
 
@@ -21,6 +22,7 @@ TTF_Font* getFont(HashMap resMng, const char *key) {
     if (entry && entry->type == ENTRY_FONT) {
         return (TTF_Font *)entry->data.ptr;
     }
+    if (entry && entry->type == ENTRY_RESOURCE_STUB) return NULL;
     THROW_ERROR_AND_DO("Font with key ", fprintf(stderr, "'%s' not found\n", key); return NULL;);
 }
 
@@ -35,9 +37,25 @@ Mix_Chunk *getSound(HashMap resMng, const char *key) {
     if (entry && entry->type == ENTRY_SOUND) {
         return (Mix_Chunk *)entry->data.ptr;
     }
+    if (entry && entry->type == ENTRY_RESOURCE_STUB) return NULL;
     THROW_ERROR_AND_DO("Sound with key ", fprintf(stderr, "'%s' not found\n", key); return NULL;);
 }
 
+/**
+ * =====================================================================================================================
+ */
+
+const char* getResourceKey(HashMap resMng, const void *resource) {
+    if (!resMng || !resource) return NULL;
+    if (resMng->type != MAP_RESOURCES) THROW_ERROR_AND_RETURN("Resource manager is of wrong type", NULL);
+    for (size_t i = 0; i < resMng->size; i++) {
+        for (MapEntry *entry = resMng->entries[i]; entry; entry = entry->next) {
+            if (entry->data.ptr == resource) return entry->key;
+        }
+    }
+    return NULL;
+}
+
 /**
  * =====================================================================================================================
  */
@@ -116,34 +134,84 @@ MapEntryVal getOrLoadResource(HashMap resMng, SDL_Renderer *renderer, const char
  * =====================================================================================================================
  */
 
-void preloadResources(HashMap resMng, SDL_Renderer *renderer) {
-    // The main font with some sizes
-    getOrLoadResource(resMng, renderer, "assets/fonts/ByteBounce.ttf#28", ENTRY_FONT);
-    getOrLoadResource(resMng, renderer, "assets/fonts/ByteBounce.ttf#32", ENTRY_FONT);
-    getOrLoadResource(resMng, renderer, "assets/fonts/ByteBounce.ttf#48", ENTRY_FONT);
-
-    // Textures
-    getOrLoadResource(resMng, renderer, "assets/textures/tank.png", ENTRY_TEXTURE);
-    getOrLoadResource(resMng, renderer, "assets/textures/tank2.png", ENTRY_TEXTURE);
-    getOrLoadResource(resMng, renderer, "assets/textures/bullet.png", ENTRY_TEXTURE);
-    getOrLoadResource(resMng, renderer, "assets/textures/brick.jpg", ENTRY_TEXTURE);
-    getOrLoadResource(resMng, renderer, "assets/textures/rocks.jpg", ENTRY_TEXTURE);
-    getOrLoadResource(resMng, renderer, "assets/textures/testgun.png", ENTRY_TEXTURE);
-    getOrLoadResource(resMng, renderer, "assets/textures/testgun2.png", ENTRY_TEXTURE);
-
-    // Sounds
-    getOrLoadResource(resMng, renderer, "assets/sounds/button-press.mp3", ENTRY_SOUND);
-    getOrLoadResource(resMng, renderer, "assets/sounds/mg.mp3", ENTRY_SOUND);
-    getOrLoadResource(resMng, renderer, "assets/sounds/rifle.mp3", ENTRY_SOUND);
-    getOrLoadResource(resMng, renderer, "assets/sounds/shell1.mp3", ENTRY_SOUND);
-    getOrLoadResource(resMng, renderer, "assets/sounds/shell2.mp3", ENTRY_SOUND);
-    getOrLoadResource(resMng, renderer, "assets/sounds/coaxmg1.mp3", ENTRY_SOUND);
-    getOrLoadResource(resMng, renderer, "assets/sounds/coaxmg2.mp3", ENTRY_SOUND);
-    getOrLoadResource(resMng, renderer, "assets/sounds/coaxmg3.mp3", ENTRY_SOUND);
-
-    // UI
-    getOrLoadResource(resMng, renderer, "assets/ui/arrow.png", ENTRY_TEXTURE);
-    getOrLoadResource(resMng, renderer, "assets/ui/metalwall.png", ENTRY_TEXTURE);
+ResourceStub* addResourceStub(HashMap resMng, const char *key, MapEntryType type) {
+    if (!resMng || !key) THROW_ERROR_AND_RETURN("Resource manager or key is NULL", NULL);
+    if (resMng->type != MAP_RESOURCES) THROW_ERROR_AND_RETURN("Resource manager is of wrong type", NULL);
+
+    MapEntry *entry = MapGetEntry(resMng, key);
+    if (entry) return entry->type == ENTRY_RESOURCE_STUB ? (ResourceStub *)entry->data.ptr : NULL;
+
+    ResourceStub *stub = malloc(sizeof(ResourceStub));
+    if (!stub) THROW_ERROR_AND_RETURN("Failed to allocate memory for a resource stub", NULL);
+    stub->type = type;
+    stub->fileSize = -1;
+
+    // Fonts carry their point size after a '#', which isn't part of the path
+    const char *sizeStr = strchr(key, '#');
+    size_t pathLen = sizeStr ? (size_t)(sizeStr - key) : strlen(key);
+    char pathBuff[pathLen + 1];
+    strncpy(pathBuff, key, pathLen);
+    pathBuff[pathLen] = '\0';
+
+    FILE *f = fopen(pathBuff, "rb");
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        stub->fileSize = ftell(f);
+        fclose(f);
+    } else THROW_ERROR_AND_DO("Missing asset ", fprintf(stderr, "'%s'\n", pathBuff););
+
+    MapAddEntry(resMng, key, (MapEntryVal){.ptr = stub}, ENTRY_RESOURCE_STUB);
+    return stub;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void preloadResources(HashMap resMng, SDL_Renderer *renderer, Uint8 headless) {
+    typedef struct {
+        const char *path;
+        MapEntryType type;
+    } Preload;
+
+    const Preload preloads[] = {
+        // The main font with some sizes
+        {"assets/fonts/ByteBounce.ttf#16", ENTRY_FONT},
+        {"assets/fonts/ByteBounce.ttf#28", ENTRY_FONT},
+        {"assets/fonts/ByteBounce.ttf#32", ENTRY_FONT},
+        {"assets/fonts/ByteBounce.ttf#48", ENTRY_FONT},
+
+        // Textures
+        {"assets/textures/tank.png", ENTRY_TEXTURE},
+        {"assets/textures/tank2.png", ENTRY_TEXTURE},
+        {"assets/textures/bullet.png", ENTRY_TEXTURE},
+        {"assets/textures/brick.jpg", ENTRY_TEXTURE},
+        {"assets/textures/rocks.jpg", ENTRY_TEXTURE},
+        {"assets/textures/testgun.png", ENTRY_TEXTURE},
+        {"assets/textures/testgun2.png", ENTRY_TEXTURE},
+
+        // Sounds
+        {"assets/sounds/button-press.mp3", ENTRY_SOUND},
+        {"assets/sounds/mg.mp3", ENTRY_SOUND},
+        {"assets/sounds/rifle.mp3", ENTRY_SOUND},
+        {"assets/sounds/shell1.mp3", ENTRY_SOUND},
+        {"assets/sounds/shell2.mp3", ENTRY_SOUND},
+        {"assets/sounds/coaxmg1.mp3", ENTRY_SOUND},
+        {"assets/sounds/coaxmg2.mp3", ENTRY_SOUND},
+        {"assets/sounds/coaxmg3.mp3", ENTRY_SOUND},
+
+        // UI
+        {"assets/ui/arrow.png", ENTRY_TEXTURE},
+        {"assets/ui/metalwall.png", ENTRY_TEXTURE}
+    };
+
+    PROFILE_BEGIN(zone, "preloadResources");
+    for (size_t i = 0; i < sizeof(preloads) / sizeof(preloads[0]); i++) {
+        // Without a renderer, a mixer or fonts nothing can be decoded, only what the assets are is recorded
+        if (headless) addResourceStub(resMng, preloads[i].path, preloads[i].type);
+        else getOrLoadResource(resMng, renderer, preloads[i].path, preloads[i].type);
+    }
+    PROFILE_END(zone);
 }
 
 /**
@@ -173,6 +241,11 @@ void freeResourceManager(HashMap *resMng) {
                     Mix_FreeChunk((Mix_Chunk *)entry->data.ptr);
                     break;
                 }
+                case ENTRY_RESOURCE_STUB: {
+                    free(entry->data.ptr);
+                    break;
+                }
+                default: break;
             }
             free(entry);
             entry = next;
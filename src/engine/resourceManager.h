@@ -3,11 +3,20 @@
 
 #include "../global/global.h"
 
+/**
+ * Metadata kept in place of a texture, sound or font in headless mode, where nothing gets decoded
+ */
+typedef struct {
+    MapEntryType type;  // The kind of resource the stub stands for
+    Sint64 fileSize;  // Size of the asset on disk in bytes, -1 if the file is missing
+} ResourceStub;
+
 /**
  * Retrieves a texture resource from the Resource Manager
  * @param resMng the Resource Manager HashMap = struct map*
  * @param key the resource's path
  * @return the texture resource if found, NULL otherwise
+ * @note headless stubs resolve to NULL without complaining
 */
 SDL_Texture* getTexture(HashMap resMng, const char *key);
 
@@ -16,6 +25,7 @@ SDL_Texture* getTexture(HashMap resMng, const char *key);
  * @param resMng the Resource Manager HashMap = struct map*
  * @param key the resource's path
  * @return the font resource if found, NULL otherwise
+ * @note headless stubs resolve to NULL without complaining
 */ 
 TTF_Font* getFont(HashMap resMng, const char *key);
 
@@ -24,9 +34,19 @@ TTF_Font* getFont(HashMap resMng, const char *key);
  * @param resMng the Resource Manager HashMap = struct map*
  * @param key the resource's path
  * @return the sound resource if found, NULL otherwise
+ * @note headless stubs resolve to NULL without complaining
  */
 Mix_Chunk* getSound(HashMap resMng, const char *key);
 
+/**
+ * Finds the key a loaded resource is stored under
+ * @param resMng the Resource Manager HashMap = struct map*
+ * @param resource the texture, sound or font
+ * @return the resource's path, NULL if it isn't in the Resource Manager
+ * @note goes through every entry, keep it out of the per-frame code
+ */
+const char* getResourceKey(HashMap resMng, const void *resource);
+
 /**
  * Retrieves a resource from the Resource Manager if it's there, otherwise loads it
  * @param resMng the Resource Manager HashMap = struct map*
@@ -37,13 +57,24 @@ Mix_Chunk* getSound(HashMap resMng, const char *key);
  */
 MapEntryVal getOrLoadResource(HashMap resMng, SDL_Renderer *renderer, const char *key, MapEntryType type);
 
+/**
+ * Records a metadata-only stub for a resource instead of loading it
+ * @param resMng the Resource Manager HashMap = struct map*
+ * @param key the resource's path
+ * @param type the type of resource the stub stands for
+ * @return pointer to the ResourceStub, NULL on failure
+ * @note a missing file is reported, so headless runs still catch broken asset paths
+ */
+ResourceStub* addResourceStub(HashMap resMng, const char *key, MapEntryType type);
+
 /**
  * Preloads the frequently used resources into the Resource Manager
  * @param resMng the Resource Manager HashMap = struct map*
  * @param renderer the SDL_Renderer, needed for loading textures
+ * @param headless 1 to record metadata-only stubs instead of loading anything
  * @note be careful about which resources to preload, as they have a lifetime of the entire game's duration
  */
-void preloadResources(HashMap resMng, SDL_Renderer *renderer);
+void preloadResources(HashMap resMng, SDL_Renderer *renderer, Uint8 headless);
 
 /**
  * Frees all resources used by the Resource Manager
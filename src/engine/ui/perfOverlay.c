@@ -0,0 +1,262 @@
+#include "perfOverlay.h"
+#include "states/stateManager.h"
+#include <stdarg.h>
+
+static const char *componentNames[COMPONENT_TYPE_COUNT] = {
+    [HEALTH_COMPONENT] = "HEALTH",
+    [POSITION_COMPONENT] = "POSITION",
+    [VELOCITY_COMPONENT] = "VELOCITY",
+    [DIRECTION_COMPONENT] = "DIRECTION",
+    [WEAPON_COMPONENT] = "WEAPON",
+    [LOADOUT_COMPONENT] = "LOADOUT",
+    [PROJECTILE_COMPONENT] = "PROJECTILE",
+    [LIFETIME_COMPONENT] = "LIFETIME",
+    [COLLISION_COMPONENT] = "COLLISION",
+    [STATE_TAG_COMPONENT] = "STATE_TAG",
+    [RENDER_COMPONENT] = "RENDER"
+};
+
+/**
+ * Draws a line of text on the current render target
+ * @param rdr the SDL_Renderer
+ * @param font font of the text
+ * @param x left edge of the text
+ * @param y top edge of the text
+ * @param color color of the text
+ * @param format printf-like format of the text
+ */
+static void drawOverlayText(SDL_Renderer *rdr, TTF_Font *font, int x, int y, SDL_Color color, const char *format, ...) {
+    char text[128];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    SDL_Surface *surface = TTF_RenderText_Blended(font, text, color);
+    if (!surface) return;
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(rdr, surface);
+    if (texture) {
+        SDL_Rect dest = {.x = x, .y = y, .w = surface->w, .h = surface->h};
+        SDL_RenderCopy(rdr, texture, NULL, &dest);
+        SDL_DestroyTexture(texture);
+    }
+    SDL_FreeSurface(surface);
+}
+
+/**
+ * Draws the frame time graph, oldest frame on the left
+ * @param rdr the SDL_Renderer
+ * @param overlay the PerfOverlay
+ * @param area where the graph goes
+ */
+static void drawFrameGraph(SDL_Renderer *rdr, const PerfOverlay *overlay, SDL_Rect area) {
+    SDL_SetRenderDrawColor(rdr, 30, 30, 40, 255);
+    SDL_RenderFillRect(rdr, &area);
+
+    int barWidth = area.w / PERF_OVERLAY_SAMPLES;
+    Uint32 oldest = (overlay->nextSample + PERF_OVERLAY_SAMPLES - overlay->sampleCount) % PERF_OVERLAY_SAMPLES;
+    for (Uint32 i = 0; i < overlay->sampleCount; i++) {
+        double_t ms = overlay->frameTimes[(oldest + i) % PERF_OVERLAY_SAMPLES];
+        double_t ratio = ms < PERF_OVERLAY_GRAPH_MAX_MS ? ms / PERF_OVERLAY_GRAPH_MAX_MS : 1.0;
+
+        // Green within a 60 Hz frame, yellow within a 30 Hz one, red past it
+        if (ms <= 1000.0 / 60.0) SDL_SetRenderDrawColor(rdr, 80, 200, 80, 255);
+        else if (ms <= 1000.0 / 30.0) SDL_SetRenderDrawColor(rdr, 220, 200, 60, 255);
+        else SDL_SetRenderDrawColor(rdr, 220, 60, 60, 255);
+
+        int height = (int)(ratio * area.h);
+        SDL_Rect bar = {.x = area.x + i * barWidth, .y = area.y + area.h - height, .w = barWidth, .h = height};
+        SDL_RenderFillRect(rdr, &bar);
+    }
+
+    // The 60 Hz budget
+    int budgetY = area.y + area.h - (int)(area.h * (1000.0 / 60.0) / PERF_OVERLAY_GRAPH_MAX_MS);
+    SDL_SetRenderDrawColor(rdr, 200, 200, 200, 255);
+    SDL_RenderDrawLine(rdr, area.x, budgetY, area.x + area.w, budgetY);
+}
+
+/**
+ * Redraws the overlay texture with the current numbers
+ * @param zEngine pointer to the engine
+ * @param node the overlay's node
+ */
+static void redrawPerfOverlay(ZENg zEngine, UINode *node) {
+    UIImage *image = (UIImage *)node->widget;
+    PerfOverlay *overlay = (PerfOverlay *)image->data;
+    SDL_Renderer *rdr = zEngine->display->renderer;
+    TTF_Font *font = overlay->font;
+    const SDL_Color white = {230, 230, 230, 255};
+    const SDL_Color grey = {150, 150, 160, 255};
+    const int x = PERF_OVERLAY_MARGIN;
+    int y = PERF_OVERLAY_MARGIN;
+
+    SDL_SetRenderTarget(rdr, image->texture);
+    SDL_SetRenderDrawBlendMode(rdr, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(rdr, 10, 10, 15, 190);
+    SDL_RenderClear(rdr);
+    SDL_SetRenderDrawBlendMode(rdr, SDL_BLENDMODE_BLEND);
+
+    // Frame times
+    double_t totalMs = 0.0, worstMs = 0.0;
+    for (Uint32 i = 0; i < overlay->sampleCount; i++) {
+        totalMs += overlay->frameTimes[i];
+        if (overlay->frameTimes[i] > worstMs) worstMs = overlay->frameTimes[i];
+    }
+    double_t avgMs = overlay->sampleCount ? totalMs / overlay->sampleCount : 0.0;
+    drawOverlayText(
+        rdr, font, x, y, white, "%.0f FPS   frame %.2f ms avg, %.2f ms worst",
+        avgMs > 0.0 ? 1000.0 / avgMs : 0.0, avgMs, worstMs
+    );
+    y += PERF_OVERLAY_LINE + PERF_OVERLAY_MARGIN / 2;
+
+    SDL_Rect graphArea = {
+        .x = x, .y = y, .w = PERF_OVERLAY_WIDTH - 2 * PERF_OVERLAY_MARGIN, .h = PERF_OVERLAY_GRAPH_HEIGHT
+    };
+    drawFrameGraph(rdr, overlay, graphArea);
+    y += PERF_OVERLAY_GRAPH_HEIGHT + PERF_OVERLAY_MARGIN;
+
+    // World
+    Uint32 textureCount = 0;
+    HashMap resources = zEngine->resources;
+    for (size_t i = 0; i < resources->size; i++) {
+        for (MapEntry *entry = resources->entries[i]; entry; entry = entry->next) {
+            if (entry->type == ENTRY_TEXTURE) textureCount++;
+        }
+    }
+    drawOverlayText(
+        rdr, font, x, y, white, "entities %lu   textures %u   draw calls %u",
+        zEngine->ecs->entityCount, textureCount, zEngine->display->drawCalls
+    );
+    y += PERF_OVERLAY_LINE;
+
+    CollisionManager cm = zEngine->collisionMng;
+    if (cm && cm->broadphase == BROADPHASE_SWEEP) {
+        drawOverlayText(
+            rdr, font, x, y, white, "sweep %u entries, %u contacts last tick", cm->sweepList.count, cm->pairCount
+        );
+        y += PERF_OVERLAY_LINE;
+    } else if (cm) {
+        Uint32 occupied = 0;
+        size_t references = 0, fullest = 0;
+        for (Uint32 i = 0; i < ARENA_WIDTH * ARENA_HEIGHT; i++) {
+            Entity *cellEntities = NULL;
+            size_t count = getSGCellEntities(cm, i, &cellEntities);
+            if (count) occupied++;
+            references += count;
+            if (count > fullest) fullest = count;
+        }
+        drawOverlayText(
+            rdr, font, x, y, white, "%s grid %u/%u cells occupied, %lu entries, %lu in the fullest",
+            cm->broadphase == BROADPHASE_REBUILD ? "flat" : "incremental",
+            occupied, ARENA_WIDTH * ARENA_HEIGHT, references, fullest
+        );
+        y += PERF_OVERLAY_LINE;
+    }
+    y += PERF_OVERLAY_MARGIN;
+
+    // Systems, the simulation ones show their last tick
+    drawOverlayText(rdr, font, x, y, grey, "system");
+    drawOverlayText(rdr, font, x + 300, y, grey, "ms");
+    y += PERF_OVERLAY_LINE;
+    DependencyGraph *graph = zEngine->ecs->depGraph;
+    for (SystemType type = 0; type < SYS_COUNT; type++) {
+        SystemNode *system = graph->nodes[type];
+        if (!system || !system->isActive) continue;
+        drawOverlayText(rdr, font, x, y, white, "%s", systemNames[type]);
+        drawOverlayText(rdr, font, x + 300, y, white, "%.3f", system->lastRunMs);
+        y += PERF_OVERLAY_LINE;
+    }
+    y += PERF_OVERLAY_MARGIN;
+
+    // Components, in two columns
+    drawOverlayText(rdr, font, x, y, grey, "component dense sizes");
+    y += PERF_OVERLAY_LINE;
+    for (ComponentType type = 0; type < COMPONENT_TYPE_COUNT; type++) {
+        int column = (type % 2) * (PERF_OVERLAY_WIDTH / 2);
+        int row = y + (type / 2) * PERF_OVERLAY_LINE;
+        drawOverlayText(rdr, font, x + column, row, white, "%s", componentNames[type]);
+        drawOverlayText(
+            rdr, font, x + column + 160, row, white, "%lu", zEngine->ecs->components[type].denseSize
+        );
+    }
+
+    SDL_SetRenderDrawBlendMode(rdr, SDL_BLENDMODE_NONE);
+    SDL_SetRenderTarget(rdr, NULL);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+UINode* createPerfOverlay(SDL_Renderer *rdr, TTF_Font *font) {
+    if (!rdr || !font) THROW_ERROR_AND_RETURN("The performance overlay needs a renderer and a font", NULL);
+
+    SDL_Texture *texture = SDL_CreateTexture(
+        rdr, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, PERF_OVERLAY_WIDTH, PERF_OVERLAY_HEIGHT
+    );
+    if (!texture) THROW_ERROR_AND_DO(
+        "Failed to create the performance overlay texture: ", fprintf(stderr, "%s\n", SDL_GetError()); return NULL;
+    );
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    PerfOverlay *overlay = calloc(1, sizeof(PerfOverlay));
+    if (!overlay) THROW_ERROR_AND_EXIT("Failed to allocate memory for the performance overlay");
+    overlay->font = font;
+    overlay->sinceRefresh = PERF_OVERLAY_REFRESH;  // Drawn as soon as it's shown
+
+    SDL_Rect rect = {
+        .x = PERF_OVERLAY_MARGIN, .y = PERF_OVERLAY_MARGIN, .w = PERF_OVERLAY_WIDTH, .h = PERF_OVERLAY_HEIGHT
+    };
+    UINode *node = UIcreateImage(rect, texture, overlay);
+    node->isVisible = 0;
+    return node;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void togglePerfOverlay(UINode *overlay) {
+    if (!overlay) return;
+
+    overlay->isVisible = !overlay->isVisible;
+    // Redraw right away instead of showing numbers from the last time it was up
+    if (overlay->isVisible) ((PerfOverlay *)((UIImage *)overlay->widget)->data)->sinceRefresh = PERF_OVERLAY_REFRESH;
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void updatePerfOverlay(ZENg zEngine, double_t frameTime) {
+    UINode *node = zEngine->uiManager->overlay;
+    if (!node) return;
+
+    PerfOverlay *overlay = (PerfOverlay *)((UIImage *)node->widget)->data;
+    overlay->frameTimes[overlay->nextSample] = frameTime * 1000.0;
+    overlay->nextSample = (overlay->nextSample + 1) % PERF_OVERLAY_SAMPLES;
+    if (overlay->sampleCount < PERF_OVERLAY_SAMPLES) overlay->sampleCount++;
+
+    if (!node->isVisible) return;
+    overlay->sinceRefresh += frameTime;
+    if (overlay->sinceRefresh < PERF_OVERLAY_REFRESH) return;
+
+    overlay->sinceRefresh = 0.0;
+    redrawPerfOverlay(zEngine, node);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+void freePerfOverlay(UIManager uiManager) {
+    if (!uiManager || !uiManager->overlay) return;
+
+    // The image node doesn't own its texture and data
+    UIImage *image = (UIImage *)uiManager->overlay->widget;
+    SDL_DestroyTexture(image->texture);
+    free(image->data);
+
+    UIdeleteNode(uiManager, uiManager->overlay);
+    uiManager->overlay = NULL;
+}
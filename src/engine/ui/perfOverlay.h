@@ -0,0 +1,55 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+// Performance overlay
+// An image node the UI manager draws over the current state's tree. Its texture is only redrawn a few times
+// per second, so between refreshes showing it costs a single copy and it barely perturbs what it measures
+
+#include "engine/ui/uiManager.h"
+
+#define PERF_OVERLAY_SAMPLES 120  // Frames covered by the frame time graph
+#define PERF_OVERLAY_REFRESH 0.25  // Seconds between two redraws of the texture
+#define PERF_OVERLAY_WIDTH 600  // Size of the overlay texture, in logical pixels
+#define PERF_OVERLAY_HEIGHT 720
+#define PERF_OVERLAY_MARGIN 10  // Distance from the top left corner of the screen and padding inside the overlay
+#define PERF_OVERLAY_LINE 20  // Height of a line of text
+#define PERF_OVERLAY_GRAPH_HEIGHT 100  // Height of the frame time graph
+#define PERF_OVERLAY_GRAPH_MAX_MS 33.3  // Frame time reaching the top of the graph
+
+typedef struct {
+    TTF_Font *font;  // Font of the overlay's text
+    double_t frameTimes[PERF_OVERLAY_SAMPLES];  // Rolling window of frame times, in milliseconds
+    Uint32 nextSample;  // Slot the next frame time goes to
+    Uint32 sampleCount;  // Number of frame times in the window
+    double_t sinceRefresh;  // Seconds since the texture was last redrawn
+} PerfOverlay;
+
+/**
+ * Creates the performance overlay, hidden
+ * @param rdr the SDL_Renderer, the overlay texture is one of its render targets
+ * @param font font of the overlay's text
+ * @return UINode* = pointer to the overlay's image node, its data is the PerfOverlay
+ */
+UINode* createPerfOverlay(SDL_Renderer *rdr, TTF_Font *font);
+
+/**
+ * Shows the overlay if it's hidden and hides it otherwise
+ * @param overlay the overlay's node
+ */
+void togglePerfOverlay(UINode *overlay);
+
+/**
+ * Records the last frame's time and redraws the overlay texture when it is due
+ * @param zEngine pointer to the engine
+ * @param frameTime duration of the last frame, in seconds
+ * @note the frame times are recorded while the overlay is hidden too, so the graph is full when it appears
+ */
+void updatePerfOverlay(ZENg zEngine, double_t frameTime);
+
+/**
+ * Frees the overlay's node, texture and data
+ * @param uiManager the UI manager holding the overlay
+ */
+void freePerfOverlay(UIManager uiManager);
+
+#endif // PERF_OVERLAY_H
@@ -1,4 +1,5 @@
 #include "uiManager.h"
+#include "perfOverlay.h"
 #include "states/stateManager.h"
 
 UIManager initUIManager() {
@@ -20,6 +21,7 @@ UINode* UIparseFromFile(ZENg zEngine, const char *filename) {
         printf("Failed to open UI file: %s\n", filename);
         return NULL;
     }
+    PROFILE_BEGIN(zone, "UIparseFromFile");
 
     // Magic commences
     fseek(f, 0, SEEK_END);
@@ -34,7 +36,10 @@ UINode* UIparseFromFile(ZENg zEngine, const char *filename) {
     cJSON *root = cJSON_Parse(data);
     free(data);
 
-    if (!root) return NULL;
+    if (!root) {
+        PROFILE_END(zone);
+        return NULL;
+    }
 
     // Prepare the hashmap
     HashMap parserMap = MapInit(64, MAP_PARSER);
@@ -45,6 +50,7 @@ UINode* UIparseFromFile(ZENg zEngine, const char *filename) {
     cJSON_Delete(root);
     MapFree(parserMap);
 
+    PROFILE_END(zone);
     return uiRoot;
 }
 
@@ -259,23 +265,16 @@ UINode* UIparseNode(ZENg zEngine, HashMap parserMap, cJSON *json) {
                     colors[j] = applyColorAlpha(parserMap, colorStateJson);
                 }
             }
-            ButtonNodeContext *btnCtx = malloc(sizeof(ButtonNodeContext));
-            if (!btnCtx) THROW_ERROR_AND_EXIT("Failed to allocate memory for button list context\n");
-            btnCtx->renderer = zEngine->display->renderer;
-            btnCtx->font = font;
-            memcpy(btnCtx->colors, colors, sizeof(SDL_Color) * UI_STATE_COUNT);
-            btnCtx->options = options;
-            handleProviderResult(result, &insertToList, (void *)btnCtx);
-            options = btnCtx->options;  // Update options with the list returned from the handler
-            free(btnCtx);
+            ButtonNodeContext btnCtx = {
+                .nodeType = UI_BUTTON, .renderer = zEngine->display->renderer, .font = font, .options = options
+            };
+            memcpy(btnCtx.colors, colors, sizeof(SDL_Color) * UI_STATE_COUNT);
+            handleProviderResult(result, &insertToList, (void *)&btnCtx);
+            options = btnCtx.options;  // Update options with the list returned from the handler
         } else if (strcmp(listTypeStr, "imageList") == 0) {
-            ImageNodeContext *imgCtx = malloc(sizeof(ImageNodeContext));
-            if (!imgCtx) THROW_ERROR_AND_EXIT("Failed to allocate memory for image list context\n");
-            imgCtx->ecs = zEngine->ecs;
-            imgCtx->options = options;
-            handleProviderResult(result, &insertToList, (void *)imgCtx);
-            options = imgCtx->options;  // Update options with the list returned from the handler
-            free(imgCtx);
+            ImageNodeContext imgCtx = {.nodeType = UI_IMAGE, .ecs = zEngine->ecs, .options = options};
+            handleProviderResult(result, &insertToList, (void *)&imgCtx);
+            options = imgCtx.options;  // Update options with the list returned from the handler
         }
 
         // Nav arrows
@@ -328,9 +327,7 @@ void UIinsertNode(UIManager uiManager, UINode *parent, UINode *newNode) {
     } else {
         UIaddChild(parent, newNode);
     }
-    #ifdef DEBUGUI
-        printf("Added new UI node of type %d to parent node %d\n", newNode->type, parent ? parent->type : -1);
-    #endif
+    LOG_DEBUG(LOG_UI, "Added new UI node of type %d to parent node %d", newNode->type, parent ? parent->type : -1);
 }
 
 /**
@@ -438,6 +435,11 @@ void UIdeleteNode(UIManager uiManager, UINode *node) {
             CDLLNode *head = currOption->next;
             currOption->prev->next = currOption->next;  // Remove currOption from the list
             free(currOption);  // The current option has the data already deleted (was a child)
+            if (head == currOption) {
+                // It was the only option
+                optCycle->currOption = NULL;
+                break;
+            }
 
             CDLLNode *curr = head->next;
             while (curr != head) {
@@ -491,6 +493,7 @@ void UIclose(UIManager uiManager) {
 
     // Free the tree root and all its children
     UIdeleteNode(uiManager, uiManager->root);
+    freePerfOverlay(uiManager);
 
     // Free the dirty nodes array
     free(uiManager->dirtyNodes);
@@ -653,13 +656,11 @@ void UIunmarkNodeDirty(UIManager uiManager) {
 void UIrenderNode(SDL_Renderer *rdr, UINode *node) {
     if (!node) return;
 
-    #ifdef DEBUGUI
-        // Guard against the empty UI tree
-        if (node->rect) printf(
-            "Rendering UI node of type %d (x=%d, y=%d, w=%d, h=%d)\n",
-            node->type, node->rect->x, node->rect->y, node->rect->w, node->rect->h
-        );
-    #endif
+    // Guard against the empty UI tree
+    if (node->rect) LOG_TRACE(
+        LOG_UI, "Rendering UI node of type %d (x=%d, y=%d, w=%d, h=%d)",
+        node->type, node->rect->x, node->rect->y, node->rect->w, node->rect->h
+    );
 
     // Render this node based on its type
     if (node->isVisible == 0 || (!node->rect)) return;
@@ -769,6 +770,7 @@ void UIrender(UIManager uiManager, SDL_Renderer *rdr) {
         // Start rendering from the root node
         UIrenderNode(rdr, uiManager->root);
     }
+    if (uiManager->overlay) UIrenderNode(rdr, uiManager->overlay);  // Over everything else
 }
 
 /**
@@ -1133,6 +1135,7 @@ void handleProviderResult(ProviderResult *result, NodeConsumer consumer, void *c
         case RESULT_DISPLAYMODE_ARRAY: {
             SDL_DisplayMode *modes = (SDL_DisplayMode *)result->data;
             ButtonNodeContext *btnContext = (ButtonNodeContext *)context;
+            if (btnContext->nodeType != UI_BUTTON) THROW_ERROR_AND_RETURN_VOID("Display modes need a button context");
             for (size_t i = 0; i < result->size; i++) {
                 char *btnText = calloc(16, sizeof(char));
                 snprintf(btnText, 16, "%dx%d", modes[i].w, modes[i].h);
@@ -1148,6 +1151,7 @@ void handleProviderResult(ProviderResult *result, NodeConsumer consumer, void *c
         case RESULT_WINDOWMODE_ARRAY: {
             Uint8 *values = (Uint8 *)result->data;
             ButtonNodeContext *btnContext = (ButtonNodeContext *)context;
+            if (btnContext->nodeType != UI_BUTTON) THROW_ERROR_AND_RETURN_VOID("Window modes need a button context");
             for (size_t i = 0; i < result->size; i++) {
                 char *btnText = calloc(20, sizeof(char));
                 snprintf(btnText, 20, "%s", values[i] == 0 ? "Windowed" : "Fullscreen");
@@ -1163,15 +1167,16 @@ void handleProviderResult(ProviderResult *result, NodeConsumer consumer, void *c
         case RESULT_WEAPONS_ARRAY: {
             Entity *weapons = (Entity *)result->data;
             ImageNodeContext *imgContext = (ImageNodeContext *)context;
+            if (imgContext->nodeType != UI_IMAGE) THROW_ERROR_AND_RETURN_VOID("Weapons need an image context");
             for (size_t i = 0; i < result->size; i++) {
                 // Need to get the guns' rects(or assume a fixed size),
                 // textures and data which will be passed to the button connected to the optionCycle
 
-                Uint64 page = weapons[i] / PAGE_SIZE;
-                Uint64 offset = weapons[i] % PAGE_SIZE;
+                Uint64 page = ENTITY_INDEX(weapons[i]) / PAGE_SIZE;
+                Uint64 offset = ENTITY_INDEX(weapons[i]) % PAGE_SIZE;
                 Uint64 rdrDenseIdx = imgContext->ecs->components[RENDER_COMPONENT].sparse[page][offset];
                 RenderComponent *rdrComp =
-                (RenderComponent *)imgContext->ecs->components[RENDER_COMPONENT].dense[rdrDenseIdx];
+                (RenderComponent *)DENSE_AT(&imgContext->ecs->components[RENDER_COMPONENT], rdrDenseIdx);
 
                 UINode *img = UIcreateImage(*rdrComp->destRect, rdrComp->texture, (void *)(&weapons[i]));
                 consumer(img, context);
@@ -120,6 +120,8 @@ typedef struct uiMng {
     UINode **dirtyNodes;  // Array of pointers to dirty nodes
     Uint64 dirtyCount;  // Number of dirty nodes
     Uint64 dirtyCapacity;  // Capacity of the dirty nodes array
+
+    UINode *overlay;  // Performance overlay, drawn over the tree and kept across state changes
 } *UIManager;
 
 /**
@@ -330,7 +332,10 @@ typedef void (*ActionFunc)(ZENg, void *);  // Same here, ActionFunc is not a voi
 // I feel like I went down a rabbit hole
 typedef void (*NodeConsumer)(UINode* node, void *context);
 
+// Both contexts start with the type of the nodes they build, handleProviderResult checks it before reading the rest
+
 typedef struct {
+    UIType nodeType;  // UI_BUTTON
     SDL_Renderer *renderer;
     TTF_Font *font;
     SDL_Color colors[UI_STATE_COUNT];
@@ -338,6 +343,7 @@ typedef struct {
 } ButtonNodeContext;
 
 typedef struct {
+    UIType nodeType;  // UI_IMAGE
     ECS ecs;
     CDLLNode *options;
 } ImageNodeContext;
@@ -1,11 +1,9 @@
 #ifndef GLOBAL_H
 #define GLOBAL_H
 
-#define DEBUG
+// DEBUG, DEBUGCOLLISIONS (hitbox overlay) and DEBUGUI (UI node outlines) come from debug builds, see CMakeLists.txt
 // #define DEBUGPP
-#define DEBUGSYSTEMS
-#define DEBUGCOLLISIONS
-#define DEBUGUI
+// #define PROFILER  // Timing zones, written to profile.json with a summary at exit
 
 #include <stdint.h>
 #include <stdio.h>
@@ -21,6 +19,10 @@
 #include "global/utils/vec2.h"
 #include "global/utils/DLinkList.h"
 #include "global/utils/hashMap.h"
+#include "global/utils/slabPool.h"
+#include "global/utils/frameArena.h"
+#include "global/utils/profiler.h"
+#include "global/utils/logger.h"
 
 typedef struct engine *ZENg;  // Forward declaration of the engine struct
 
@@ -0,0 +1,111 @@
+#include "global/global.h"  // For the macros
+
+#define ALIGN_UP(value, alignment) (((value) + (alignment) - 1) & ~((uintptr_t)(alignment) - 1))
+
+/**
+ * Allocates the arena's block, over-allocating so it can start on an aligned address
+ * @param arena pointer to the FrameArena
+ * @param capacity usable bytes in the block
+ */
+static void allocFrameBlock(FrameArena *arena, size_t capacity) {
+    arena->raw = malloc(capacity + FRAME_ARENA_ALIGNMENT - 1);
+    if (!arena->raw) THROW_ERROR_AND_EXIT("Failed to allocate memory for the frame arena");
+    arena->base = (Uint8 *)ALIGN_UP((uintptr_t)arena->raw, FRAME_ARENA_ALIGNMENT);
+    arena->capacity = capacity;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void initFrameArena(FrameArena *arena, size_t capacity) {
+    if (!arena) THROW_ERROR_AND_RETURN_VOID("Cannot initialize a NULL frame arena");
+
+    *arena = (FrameArena) {0};
+    if (capacity == 0) capacity = FRAME_ARENA_SIZE;
+    allocFrameBlock(arena, ALIGN_UP(capacity, FRAME_ARENA_ALIGNMENT));
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void* frameAlloc(FrameArena *arena, size_t size) {
+    if (!arena || !arena->base) THROW_ERROR_AND_RETURN("Frame arena not initialized", NULL);
+
+    size = ALIGN_UP(size, FRAME_ARENA_ALIGNMENT);
+    if (arena->offset + size <= arena->capacity) {
+        void *mem = arena->base + arena->offset;
+        arena->offset += size;
+        return mem;
+    }
+
+    // Full for this frame, the link to the previous heap block lives in the first bytes of the new one
+    void *raw = malloc(sizeof(void *) + size + FRAME_ARENA_ALIGNMENT - 1);
+    if (!raw) THROW_ERROR_AND_EXIT("Failed to allocate memory for a frame arena overflow block");
+    *(void **)raw = arena->overflow;
+    arena->overflow = raw;
+    arena->overflowBytes += size;
+
+    return (void *)ALIGN_UP((uintptr_t)raw + sizeof(void *), FRAME_ARENA_ALIGNMENT);
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void resetFrameArena(FrameArena *arena) {
+    if (!arena || !arena->base) THROW_ERROR_AND_RETURN_VOID("Frame arena not initialized");
+
+    size_t used = arena->offset + arena->overflowBytes;
+    if (used > arena->peak) arena->peak = used;
+    arena->totalBytes += used;
+    arena->frameCount++;
+
+    if (arena->overflow) {
+        while (arena->overflow) {
+            void *next = *(void **)arena->overflow;
+            free(arena->overflow);
+            arena->overflow = next;
+        }
+        arena->overflowFrames++;
+
+        // Nothing handed out is alive anymore, so the block can move. Grow it to fit the busiest frame so far
+        size_t newCapacity = arena->capacity;
+        while (newCapacity < arena->peak) newCapacity *= 2;
+        free(arena->raw);
+        allocFrameBlock(arena, newCapacity);
+
+        LOG_DEBUG(
+            LOG_CORE, "Frame arena overflowed by %lu bytes, grown to %lu bytes", arena->overflowBytes, newCapacity
+        );
+    }
+
+    arena->offset = 0;
+    arena->overflowBytes = 0;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+double_t getFrameArenaAverage(const FrameArena *arena) {
+    if (!arena || arena->frameCount == 0) return 0.0;
+    return (double_t)arena->totalBytes / arena->frameCount;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void freeFrameArena(FrameArena *arena) {
+    if (!arena) return;
+
+    while (arena->overflow) {
+        void *next = *(void **)arena->overflow;
+        free(arena->overflow);
+        arena->overflow = next;
+    }
+    free(arena->raw);
+    *arena = (FrameArena) {0};
+}
@@ -0,0 +1,61 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+// Linear (bump) allocator for data that only lives for one frame
+// Allocating is a pointer bump and everything is released at once when the arena is reset at the top of the frame
+
+#include <stdlib.h>
+
+#define FRAME_ARENA_SIZE 1048576  // Default capacity of the arena in bytes
+#define FRAME_ARENA_ALIGNMENT 64  // Every allocation starts on a cache line, which also satisfies the SIMD loads
+
+typedef struct {
+    void *raw;  // The raw allocation behind the block, kept to free it
+    Uint8 *base;  // Aligned start of the block
+    size_t capacity;  // Usable bytes in the block
+    size_t offset;  // Bytes handed out from the block this frame
+    void *overflow;  // Heap blocks that served the requests which did not fit, chained through their first bytes
+    size_t overflowBytes;  // Bytes handed out from the heap blocks this frame
+
+    size_t peak;  // Most bytes used in a single frame
+    Uint64 totalBytes;  // Bytes used over all the finished frames, for the average
+    Uint64 frameCount;  // Number of finished frames
+    Uint64 overflowFrames;  // Number of frames that had to fall back on the heap
+} FrameArena;
+
+/**
+ * Initializes a frame arena
+ * @param arena pointer to the FrameArena
+ * @param capacity initial capacity in bytes, 0 for FRAME_ARENA_SIZE
+ */
+void initFrameArena(FrameArena *arena, size_t capacity);
+
+/**
+ * Hands out scratch memory that stays valid until the next reset
+ * @param arena pointer to the FrameArena
+ * @param size number of bytes needed
+ * @return pointer to uninitialized memory aligned to FRAME_ARENA_ALIGNMENT
+ * @note when the arena is full the request is served from the heap and the arena grows on the next reset,
+ * so the pointers handed out earlier in the frame stay valid
+ */
+void* frameAlloc(FrameArena *arena, size_t size);
+
+/**
+ * Releases everything allocated since the last reset and records the frame's usage
+ * @param arena pointer to the FrameArena
+ */
+void resetFrameArena(FrameArena *arena);
+
+/**
+ * @param arena pointer to the FrameArena
+ * @return the average number of bytes used per frame
+ */
+double_t getFrameArenaAverage(const FrameArena *arena);
+
+/**
+ * Frees the arena's memory, invalidating everything allocated from it
+ * @param arena pointer to the FrameArena
+ */
+void freeFrameArena(FrameArena *arena);
+
+#endif // FRAME_ARENA_H
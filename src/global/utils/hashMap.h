@@ -16,6 +16,7 @@ typedef enum {
     ENTRY_TEXTURE,
     ENTRY_SOUND,
     ENTRY_FONT,
+    ENTRY_RESOURCE_STUB,  // Headless stand-in for a texture, sound or font
     ENTRY_TANK_PREFAB,
     ENTRY_WEAPON_PREFAB,
     ENTRY_TILE_PREFAB,
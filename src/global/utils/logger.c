@@ -0,0 +1,246 @@
+#include "global/global.h"  // For the macros
+#include <stdarg.h>
+
+typedef struct {
+    SDL_atomic_t sequence;  // Slot position when free, position + 1 once the message in it is ready to be written
+    Uint64 time;  // Performance counter value when the message was logged
+    Uint8 level;  // LogLevel of the message
+    Uint8 channel;  // LogChannel of the message
+    char text[LOG_MESSAGE_SIZE];  // The formatted message
+} LogSlot;
+
+Uint8 logLevels[LOG_CHANNEL_COUNT] = {
+    [LOG_CORE] = LOG_DEFAULT_LEVEL,
+    [LOG_ECS] = LOG_DEFAULT_LEVEL,
+    [LOG_SYSTEMS] = LOG_DEFAULT_LEVEL,
+    [LOG_COLLISIONS] = LOG_DEFAULT_LEVEL,
+    [LOG_UI] = LOG_DEFAULT_LEVEL
+};
+
+const char *const logLevelNames[LOG_LEVEL_COUNT] = {
+    [LOG_LEVEL_TRACE] = "TRACE",
+    [LOG_LEVEL_DEBUG] = "DEBUG",
+    [LOG_LEVEL_INFO] = "INFO",
+    [LOG_LEVEL_WARN] = "WARN",
+    [LOG_LEVEL_ERROR] = "ERROR",
+    [LOG_LEVEL_OFF] = "OFF"
+};
+
+const char *const logChannelNames[LOG_CHANNEL_COUNT] = {
+    [LOG_CORE] = "CORE",
+    [LOG_ECS] = "ECS",
+    [LOG_SYSTEMS] = "SYSTEMS",
+    [LOG_COLLISIONS] = "COLLISIONS",
+    [LOG_UI] = "UI"
+};
+
+static LogSlot *ring;  // NULL while the writer isn't running
+static SDL_atomic_t head;  // Position the next message claims, its slot is ring[head % LOG_RING_SIZE]
+static Uint32 tail;  // Position of the next message to write, only the writer touches it
+static SDL_atomic_t running;  // Cleared to make the writer stop once the ring is empty
+static SDL_atomic_t dropped;  // Messages lost to a full ring
+static SDL_Thread *writer;
+static Uint64 origin;  // Performance counter value when the logger started, the timestamps' zero
+static double_t secondsPerCount;
+
+/**
+ * Writes one message out
+ * @param time performance counter value when it was logged
+ * @param level LogLevel of the message
+ * @param channel LogChannel of the message
+ * @param text the message
+ * @note warnings and errors go to stderr, the rest to stdout
+ */
+static void writeLogLine(Uint64 time, Uint8 level, Uint8 channel, const char *text) {
+    FILE *out = level >= LOG_LEVEL_WARN ? stderr : stdout;
+    fprintf(
+        out, "[%10.4f] [%-5s] [%s] %s\n",
+        (double_t)(time - origin) * secondsPerCount, logLevelNames[level], logChannelNames[channel], text
+    );
+}
+
+/**
+ * Writes every message that's ready, in the order they claimed their slots
+ * @return Uint32 = number of messages written
+ */
+static Uint32 drainLogRing(void) {
+    Uint32 written = 0;
+    for (;;) {
+        LogSlot *slot = &ring[tail & (LOG_RING_SIZE - 1)];
+        // Claimed but still being formatted, or nothing there yet
+        if ((Uint32)SDL_AtomicGet(&slot->sequence) != tail + 1) break;
+
+        writeLogLine(slot->time, slot->level, slot->channel, slot->text);
+        // Hand the slot back to the producers for its next lap around the ring
+        SDL_AtomicSet(&slot->sequence, (int)(tail + LOG_RING_SIZE));
+        tail++;
+        written++;
+    }
+    return written;
+}
+
+/**
+ * Body of the writer thread, drains the ring until asked to stop and nothing is left
+ * @param data unused
+ * @return int = 0
+ */
+static int logWriter(void *data) {
+    (void)data;
+    for (;;) {
+        Uint32 written = drainLogRing();
+        if (written) {
+            // One flush per batch instead of one per message
+            fflush(stdout);
+            fflush(stderr);
+            continue;
+        }
+        if (!SDL_AtomicGet(&running)) break;
+        SDL_Delay(LOG_WRITER_DELAY);
+    }
+    // Messages finished right before the stop was noticed
+    drainLogRing();
+    fflush(stdout);
+    fflush(stderr);
+    return 0;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void initLogger(void) {
+    if (ring) return;
+
+    origin = SDL_GetPerformanceCounter();
+    secondsPerCount = 1.0 / (double_t)SDL_GetPerformanceFrequency();
+
+    LogSlot *slots = malloc(LOG_RING_SIZE * sizeof(LogSlot));
+    if (!slots) THROW_ERROR_AND_EXIT("Failed to allocate memory for the log ring buffer");
+    for (Uint32 i = 0; i < LOG_RING_SIZE; i++) SDL_AtomicSet(&slots[i].sequence, (int)i);
+    SDL_AtomicSet(&head, 0);
+    SDL_AtomicSet(&dropped, 0);
+    SDL_AtomicSet(&running, 1);
+    tail = 0;
+    ring = slots;
+
+    writer = SDL_CreateThread(logWriter, "logger", NULL);
+    if (!writer) THROW_ERROR_AND_DO(
+        "Failed to start the log writer, logging synchronously: ", fprintf(stderr, "%s\n", SDL_GetError());
+        ring = NULL; free(slots);
+    );
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void logMessage(LogChannel channel, LogLevel level, const char *format, ...) {
+    if (channel >= LOG_CHANNEL_COUNT || level >= LOG_LEVEL_OFF) return;
+
+    va_list args;
+    if (!ring) {
+        // No writer, e.g. before initLogger
+        char text[LOG_MESSAGE_SIZE];
+        va_start(args, format);
+        vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        writeLogLine(SDL_GetPerformanceCounter(), level, channel, text);
+        return;
+    }
+
+    // Claim a slot, the ring is bounded so a full one means the writer is a whole lap behind
+    Uint32 pos = (Uint32)SDL_AtomicGet(&head);
+    LogSlot *slot;
+    for (;;) {
+        slot = &ring[pos & (LOG_RING_SIZE - 1)];
+        Sint32 diff = (Sint32)((Uint32)SDL_AtomicGet(&slot->sequence) - pos);
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&head, (int)pos, (int)(pos + 1))) break;
+            pos = (Uint32)SDL_AtomicGet(&head);  // Another thread took it
+        } else if (diff < 0) {
+            SDL_AtomicIncRef(&dropped);
+            return;
+        } else pos = (Uint32)SDL_AtomicGet(&head);  // Fell behind the other producers
+    }
+
+    slot->time = SDL_GetPerformanceCounter();
+    slot->level = (Uint8)level;
+    slot->channel = (Uint8)channel;
+    va_start(args, format);
+    vsnprintf(slot->text, LOG_MESSAGE_SIZE, format, args);
+    va_end(args);
+
+    // Publish it to the writer
+    SDL_AtomicSet(&slot->sequence, (int)(pos + 1));
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void setLogLevel(LogChannel channel, LogLevel level) {
+    if (channel >= LOG_CHANNEL_COUNT || level >= LOG_LEVEL_COUNT) return;
+    logLevels[channel] = (Uint8)level;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+LogLevel getLogLevelFromName(const char *name) {
+    for (LogLevel level = 0; level < LOG_LEVEL_COUNT; level++) {
+        if (strcmp(name, logLevelNames[level]) == 0) return level;
+    }
+    return LOG_LEVEL_COUNT;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+LogChannel getLogChannelFromName(const char *name) {
+    for (LogChannel channel = 0; channel < LOG_CHANNEL_COUNT; channel++) {
+        if (strcmp(name, logChannelNames[channel]) == 0) return channel;
+    }
+    return LOG_CHANNEL_COUNT;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void saveLogSettings(const char *filePath) {
+    if (!filePath) return;
+
+    FILE *fout = fopen(filePath, "a");
+    if (!fout) {
+        printf("Failed to open config file for writing: %s\n", filePath);
+        return;
+    }
+
+    fprintf(fout, "[LOGGING]\n");
+    for (LogChannel channel = 0; channel < LOG_CHANNEL_COUNT; channel++) {
+        fprintf(fout, "%s=%s\n", logChannelNames[channel], logLevelNames[logLevels[channel]]);
+    }
+
+    fclose(fout);
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void freeLogger(void) {
+    if (!ring) return;
+
+    SDL_AtomicSet(&running, 0);
+    SDL_WaitThread(writer, NULL);
+    writer = NULL;
+
+    LogSlot *slots = ring;
+    ring = NULL;  // Anything logged from now on is written synchronously
+    free(slots);
+
+    int lost = SDL_AtomicGet(&dropped);
+    if (lost) fprintf(stderr, "Logger: %d messages were dropped because the ring buffer was full\n", lost);
+}
@@ -0,0 +1,111 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// Leveled logging
+// Every message has a channel and a level. A message below LOG_MIN_LEVEL is compiled out, one below its channel's
+// runtime level costs a single comparison. The others are formatted by the calling thread straight into a slot of
+// a lock-free ring buffer, and a background thread writes them out, so the hot path never waits on a syscall.
+// When the ring is full the message is dropped and counted instead of stalling the caller
+
+#include <stdlib.h>
+
+#define LOG_RING_SIZE 4096  // Messages waiting for the writer, must be a power of two
+#define LOG_MESSAGE_SIZE 200  // Longest message kept, longer ones are truncated
+#define LOG_WRITER_DELAY 2  // Milliseconds the writer sleeps when the ring is empty
+
+typedef enum {
+    LOG_LEVEL_TRACE,  // Per entity, per tick
+    LOG_LEVEL_DEBUG,  // Per system run
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_OFF,  // As a channel level, silences the channel
+    LOG_LEVEL_COUNT  // Automatically counts
+} LogLevel;
+
+typedef enum {
+    LOG_CORE,
+    LOG_ECS,
+    LOG_SYSTEMS,
+    LOG_COLLISIONS,
+    LOG_UI,
+    LOG_CHANNEL_COUNT  // Automatically counts
+} LogChannel;
+
+// Lowest level compiled in, define it before including global.h to change it
+#ifndef LOG_MIN_LEVEL
+    #ifdef DEBUG
+        #define LOG_MIN_LEVEL LOG_LEVEL_TRACE
+    #else
+        #define LOG_MIN_LEVEL LOG_LEVEL_INFO
+    #endif
+#endif
+
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_INFO  // Runtime level of the channels settings.ini doesn't mention
+
+// The level is a constant, so the first comparison folds away and calls below LOG_MIN_LEVEL leave no code behind
+#define LOG(channel, level, ...) \
+    do { \
+        if ((level) >= LOG_MIN_LEVEL && (level) >= logLevels[channel]) logMessage(channel, level, __VA_ARGS__); \
+    } while (0)
+
+#define LOG_TRACE(channel, ...) LOG(channel, LOG_LEVEL_TRACE, __VA_ARGS__)
+#define LOG_DEBUG(channel, ...) LOG(channel, LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(channel, ...) LOG(channel, LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(channel, ...) LOG(channel, LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(channel, ...) LOG(channel, LOG_LEVEL_ERROR, __VA_ARGS__)
+
+extern Uint8 logLevels[LOG_CHANNEL_COUNT];  // Runtime level of each channel, written through setLogLevel
+
+extern const char *const logLevelNames[LOG_LEVEL_COUNT];
+extern const char *const logChannelNames[LOG_CHANNEL_COUNT];
+
+/**
+ * Allocates the ring buffer and starts the writer thread
+ * @note messages logged before this or after freeLogger are written synchronously
+ */
+void initLogger(void);
+
+/**
+ * Formats a message into the ring buffer, use the LOG macros so the level checks happen first
+ * @param channel channel of the message
+ * @param level level of the message
+ * @param format printf-like format of the message, without the trailing newline
+ * @note safe to call from any thread
+ */
+void logMessage(LogChannel channel, LogLevel level, const char *format, ...);
+
+/**
+ * Changes the runtime level of a channel
+ * @param channel the channel
+ * @param level messages below it are skipped, LOG_LEVEL_OFF silences the channel
+ */
+void setLogLevel(LogChannel channel, LogLevel level);
+
+/**
+ * Looks up a level by name, as written in settings.ini
+ * @param name e.g. "DEBUG"
+ * @return LogLevel = the level, LOG_LEVEL_COUNT if the name is unknown
+ */
+LogLevel getLogLevelFromName(const char *name);
+
+/**
+ * Looks up a channel by name, as written in settings.ini
+ * @param name e.g. "COLLISIONS"
+ * @return LogChannel = the channel, LOG_CHANNEL_COUNT if the name is unknown
+ */
+LogChannel getLogChannelFromName(const char *name);
+
+/**
+ * Appends the channel levels to the settings file
+ * @param filePath path to the settings file
+ */
+void saveLogSettings(const char *filePath);
+
+/**
+ * Stops the writer thread once the ring buffer is drained and frees it
+ * @note reports how many messages were dropped because the ring was full
+ */
+void freeLogger(void);
+
+#endif // LOGGER_H
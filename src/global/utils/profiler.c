@@ -0,0 +1,202 @@
+#include "global/global.h"  // For the macros
+
+#ifdef PROFILER
+
+typedef struct {
+    Uint32 buckets[PROFILER_BUCKETS];  // Log-linear histogram of the durations, in nanoseconds
+    Uint64 count;  // Number of durations recorded
+    Uint64 totalNs;  // Sum of the durations, for the average
+    Uint64 maxNs;  // Longest duration
+} ProfileStat;
+
+typedef struct {
+    void *owner;  // Thread ID of the thread recording here, NULL while the slot is free
+    ProfileEvent *ring;  // The last PROFILER_RING_SIZE zones the thread closed
+    Uint64 written;  // Zones closed so far, the next one goes to ring[written % PROFILER_RING_SIZE]
+    ProfileStat stats[PROFILER_MAX_STATS];  // Durations of the tracked zones closed on this thread
+} ProfileThread;
+
+static ProfileThread threads[PROFILER_MAX_THREADS];
+static const char *statNames[PROFILER_MAX_STATS];
+static Uint32 statCount;
+static Uint64 origin;  // Performance counter value when profiling started, the trace's zero
+static double_t nsPerCount;  // Nanoseconds per performance counter increment
+
+/**
+ * Finds the calling thread's slot, claiming a free one the first time
+ * @return pointer to the ProfileThread, NULL once all the slots are taken
+ * @note only the owner writes to a slot, so recording needs no lock
+ */
+static ProfileThread* getProfileThread(void) {
+    void *self = (void *)(uintptr_t)SDL_ThreadID();
+    for (Uint32 i = 0; i < PROFILER_MAX_THREADS; i++) {
+        void *owner = SDL_AtomicGetPtr(&threads[i].owner);
+        if (owner == self) return &threads[i];
+        if (owner) continue;
+
+        // Free slot, unless another thread claimed it in the meantime
+        if (!SDL_AtomicCASPtr(&threads[i].owner, NULL, self)) continue;
+        threads[i].ring = malloc(PROFILER_RING_SIZE * sizeof(ProfileEvent));
+        if (!threads[i].ring) THROW_ERROR_AND_EXIT("Failed to allocate memory for a profiler ring buffer");
+        return &threads[i];
+    }
+    return NULL;
+}
+
+/**
+ * Maps a duration to its histogram bucket
+ * @param ns duration in nanoseconds
+ * @return index of the bucket, the first PROFILER_SUB_BUCKETS are exact, the others span 1/8 of a power of two
+ */
+static Uint32 bucketOf(Uint64 ns) {
+    if (ns < PROFILER_SUB_BUCKETS) return (Uint32)ns;
+
+    Uint32 msb = 0;
+    for (Uint64 v = ns; v > 1; v >>= 1) msb++;
+    Uint32 sub = (Uint32)(ns >> (msb - 3)) & (PROFILER_SUB_BUCKETS - 1);
+    return (msb - 2) * PROFILER_SUB_BUCKETS + sub;
+}
+
+/**
+ * @param bucket index of a histogram bucket
+ * @return the middle of the durations the bucket covers, in nanoseconds
+ */
+static double_t bucketMiddle(Uint32 bucket) {
+    if (bucket < PROFILER_SUB_BUCKETS) return bucket;
+
+    Uint32 msb = bucket / PROFILER_SUB_BUCKETS + 2;
+    Uint64 width = (Uint64)1 << (msb - 3);
+    Uint64 low = (PROFILER_SUB_BUCKETS + bucket % PROFILER_SUB_BUCKETS) * width;
+    return low + width / 2.0;
+}
+
+/**
+ * Reads a percentile off a histogram
+ * @param stat the merged ProfileStat
+ * @param percentile the percentile, in (0, 100]
+ * @return the duration in microseconds
+ */
+static double_t statPercentile(const ProfileStat *stat, double_t percentile) {
+    Uint64 rank = (Uint64)(stat->count * percentile / 100.0 + 0.5);
+    if (rank < 1) rank = 1;
+
+    Uint64 seen = 0;
+    for (Uint32 b = 0; b < PROFILER_BUCKETS; b++) {
+        seen += stat->buckets[b];
+        if (seen >= rank) return bucketMiddle(b) / 1000.0;
+    }
+    return stat->maxNs / 1000.0;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void initProfiler(const char *const *names, Uint32 count) {
+    statCount = count < PROFILER_MAX_STATS ? count : PROFILER_MAX_STATS;
+    for (Uint32 i = 0; i < statCount; i++) statNames[i] = names[i];
+
+    origin = SDL_GetPerformanceCounter();
+    nsPerCount = 1e9 / SDL_GetPerformanceFrequency();
+    getProfileThread();  // The first slot belongs to the main thread
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+ProfileScope beginProfileZone(const char *name, Sint32 stat) {
+    return (ProfileScope) {.name = name, .start = SDL_GetPerformanceCounter(), .stat = stat};
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void endProfileZone(const ProfileScope *scope) {
+    Uint64 end = SDL_GetPerformanceCounter();
+    ProfileThread *thread = getProfileThread();
+    if (!thread) return;  // Too many threads, this one goes unrecorded
+
+    thread->ring[thread->written++ % PROFILER_RING_SIZE] =
+        (ProfileEvent) {.name = scope->name, .start = scope->start, .end = end};
+
+    if (scope->stat < 0 || (Uint32)scope->stat >= statCount) return;
+    ProfileStat *stat = &thread->stats[scope->stat];
+    Uint64 ns = (Uint64)((end - scope->start) * nsPerCount);
+    stat->buckets[bucketOf(ns)]++;
+    stat->count++;
+    stat->totalNs += ns;
+    if (ns > stat->maxNs) stat->maxNs = ns;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void dumpProfile(const char *tracePath) {
+    FILE *fout = tracePath ? fopen(tracePath, "w") : NULL;
+    if (!fout) {
+        printf("Failed to open profiler trace file for writing: %s\n", tracePath ? tracePath : "(null)");
+    } else {
+        // Complete ("X") events nest by time on their thread, which gives the zone hierarchy
+        fprintf(fout, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        Uint8 first = 1;
+        for (Uint32 t = 0; t < PROFILER_MAX_THREADS && threads[t].owner; t++) {
+            ProfileThread *thread = &threads[t];
+            fprintf(
+                fout, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                first ? "" : ",\n", t, t == 0 ? "main" : "thread", t
+            );
+            first = 0;
+
+            Uint64 kept = thread->written < PROFILER_RING_SIZE ? thread->written : PROFILER_RING_SIZE;
+            for (Uint64 i = thread->written - kept; i < thread->written; i++) {
+                ProfileEvent *event = &thread->ring[i % PROFILER_RING_SIZE];
+                fprintf(
+                    fout, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    event->name, t, (event->start - origin) * nsPerCount / 1000.0,
+                    (event->end - event->start) * nsPerCount / 1000.0
+                );
+            }
+        }
+        fprintf(fout, "\n]}\n");
+        fclose(fout);
+        printf("Profiler trace written to %s\n", tracePath);
+    }
+
+    // The histograms of all the threads are merged, a system may run on a different worker every tick
+    printf("%-24s %10s %10s %10s %10s %10s %10s\n", "zone", "count", "avg us", "p50 us", "p95 us", "p99 us", "max us");
+    for (Uint32 s = 0; s < statCount; s++) {
+        ProfileStat merged = {0};
+        for (Uint32 t = 0; t < PROFILER_MAX_THREADS && threads[t].owner; t++) {
+            ProfileStat *stat = &threads[t].stats[s];
+            for (Uint32 b = 0; b < PROFILER_BUCKETS; b++) merged.buckets[b] += stat->buckets[b];
+            merged.count += stat->count;
+            merged.totalNs += stat->totalNs;
+            if (stat->maxNs > merged.maxNs) merged.maxNs = stat->maxNs;
+        }
+        if (merged.count == 0) continue;
+
+        printf(
+            "%-24s %10lu %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+            statNames[s], merged.count, merged.totalNs / 1000.0 / merged.count,
+            statPercentile(&merged, 50.0), statPercentile(&merged, 95.0), statPercentile(&merged, 99.0),
+            merged.maxNs / 1000.0
+        );
+    }
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void freeProfiler(void) {
+    for (Uint32 t = 0; t < PROFILER_MAX_THREADS; t++) {
+        free(threads[t].ring);
+        threads[t] = (ProfileThread) {0};
+    }
+    statCount = 0;
+}
+
+#endif // PROFILER
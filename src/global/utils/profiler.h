@@ -0,0 +1,77 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped timing zones
+// Every thread records the zones it closes into its own ring buffer, so recording takes no lock.
+// At exit the buffers are written as a Chrome trace (chrome://tracing or ui.perfetto.dev)
+// and the zones tracked for the summary get their p50/p95/p99 durations printed.
+// Without PROFILER defined the macros expand to nothing and none of this is compiled
+
+#include <stdlib.h>
+
+#define PROFILER_RING_SIZE 65536  // Zones kept per thread, the oldest are overwritten
+#define PROFILER_MAX_THREADS 64  // Threads that can record zones
+#define PROFILER_MAX_STATS 16  // Zones whose durations are kept for the summary
+#define PROFILER_SUB_BUCKETS 8  // Histogram buckets per power of two of nanoseconds, bounds the percentile error
+#define PROFILER_BUCKETS (64 * PROFILER_SUB_BUCKETS)
+
+#ifdef PROFILER
+    #define PROFILE_BEGIN(scope, name) ProfileScope scope = beginProfileZone(name, -1)
+    #define PROFILE_BEGIN_STAT(scope, name, stat) ProfileScope scope = beginProfileZone(name, stat)
+    #define PROFILE_END(scope) endProfileZone(&scope)
+#else
+    #define PROFILE_BEGIN(scope, name)
+    #define PROFILE_BEGIN_STAT(scope, name, stat)
+    #define PROFILE_END(scope)
+#endif
+
+#ifdef PROFILER
+
+typedef struct {
+    const char *name;  // Name of the zone, must outlive the profiler
+    Uint64 start;  // Performance counter value when the zone opened
+    Uint64 end;  // Performance counter value when the zone closed
+} ProfileEvent;
+
+typedef struct {
+    const char *name;  // Name of the zone
+    Uint64 start;  // Performance counter value when the zone opened
+    Sint32 stat;  // Summary slot of the zone, -1 if it isn't tracked
+} ProfileScope;
+
+/**
+ * Starts profiling, the thread calling it shows up as the main thread in the trace
+ * @param statNames names of the zones tracked for the summary, the slot of a zone is its index
+ * @param statCount number of names, at most PROFILER_MAX_STATS are kept
+ */
+void initProfiler(const char *const *statNames, Uint32 statCount);
+
+/**
+ * Opens a zone, use the PROFILE_BEGIN macros so it compiles out when profiling is off
+ * @param name name of the zone, must be a string literal or outlive the profiler
+ * @param stat summary slot the duration is added to, -1 for none
+ * @return ProfileScope to close the zone with
+ */
+ProfileScope beginProfileZone(const char *name, Sint32 stat);
+
+/**
+ * Closes a zone and records it in the calling thread's ring buffer
+ * @param scope pointer to the ProfileScope returned when the zone was opened
+ */
+void endProfileZone(const ProfileScope *scope);
+
+/**
+ * Writes the recorded zones as a Chrome trace and prints the summary
+ * @param tracePath path to the trace_event JSON file
+ * @note the threads recording zones must be stopped first
+ */
+void dumpProfile(const char *tracePath);
+
+/**
+ * Frees the ring buffers
+ */
+void freeProfiler(void);
+
+#endif // PROFILER
+
+#endif // PROFILER_H
@@ -0,0 +1,105 @@
+#include "global/global.h"  // For the macros
+
+void initSlabPool(SlabPool *pool, size_t objectSize) {
+    if (!pool) THROW_ERROR_AND_RETURN_VOID("Cannot initialize a NULL slab pool");
+
+    // Free slots link to each other through their first bytes, and every slot stays pointer aligned
+    size_t slotSize = objectSize < sizeof(void *) ? sizeof(void *) : objectSize;
+    slotSize = (slotSize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    if (slotSize > SLAB_SIZE) THROW_ERROR_AND_RETURN_VOID("Object too big for a slab pool");
+
+    *pool = (SlabPool) {
+        .slotSize = slotSize,
+        .slotsPerSlab = SLAB_SIZE / slotSize
+    };
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+/**
+ * Allocates a new page-aligned slab and threads its slots onto the free list
+ * @param pool pointer to the SlabPool
+ */
+static void growSlabPool(SlabPool *pool) {
+    if (pool->slabCount >= pool->slabCapacity) {
+        size_t newCapacity = pool->slabCapacity ? pool->slabCapacity * 2 : 4;
+        void **tmp = realloc(pool->slabs, newCapacity * sizeof(void *));
+        if (!tmp) THROW_ERROR_AND_EXIT("Failed to reallocate memory for the slabs of a pool");
+        pool->slabs = tmp;
+        pool->slabCapacity = newCapacity;
+    }
+
+    // Over-allocate so the slab can start on a page boundary
+    void *raw = malloc(SLAB_SIZE + SLAB_ALIGNMENT - 1);
+    if (!raw) THROW_ERROR_AND_EXIT("Failed to allocate memory for a pool slab");
+    pool->slabs[pool->slabCount++] = raw;
+    Uint8 *slab = (Uint8 *)(((uintptr_t)raw + SLAB_ALIGNMENT - 1) & ~(uintptr_t)(SLAB_ALIGNMENT - 1));
+
+    // Thread back to front, so the slots are handed out in address order
+    for (size_t i = pool->slotsPerSlab; i > 0; i--) {
+        void *slot = slab + (i - 1) * pool->slotSize;
+        *(void **)slot = pool->freeList;
+        pool->freeList = slot;
+    }
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void* slabAlloc(SlabPool *pool) {
+    if (!pool || pool->slotSize == 0) THROW_ERROR_AND_RETURN("Slab pool not initialized", NULL);
+
+    if (!pool->freeList) growSlabPool(pool);
+    void *slot = pool->freeList;
+    pool->freeList = *(void **)slot;
+    pool->usedCount++;
+
+    memset(slot, 0, pool->slotSize);
+    return slot;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void slabFree(SlabPool *pool, void *object) {
+    if (!pool) THROW_ERROR_AND_RETURN_VOID("Cannot give an object back to a NULL slab pool");
+    if (!object) return;
+
+    *(void **)object = pool->freeList;
+    pool->freeList = object;
+    pool->usedCount--;
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void trimSlabPool(SlabPool *pool) {
+    if (!pool) return;
+
+    // A slot can't tell which slab it came from, so only a fully idle pool gives its slabs back
+    if (pool->usedCount == 0) freeSlabPool(pool);
+}
+
+/**
+ * =====================================================================================================================
+*/
+
+void freeSlabPool(SlabPool *pool) {
+    if (!pool) return;
+
+    for (size_t i = 0; i < pool->slabCount; i++) {
+        free(pool->slabs[i]);
+    }
+    free(pool->slabs);
+
+    size_t slotSize = pool->slotSize;
+    *pool = (SlabPool) {
+        .slotSize = slotSize,
+        .slotsPerSlab = slotSize ? SLAB_SIZE / slotSize : 0
+    };
+}
@@ -0,0 +1,56 @@
+#ifndef SLAB_POOL_H
+#define SLAB_POOL_H
+
+// Fixed-size object pool. Objects are carved out of page-aligned slabs and recycled through a free list,
+// so once the pool is warm allocating and freeing never reach the heap
+
+#include <stdlib.h>
+
+#define SLAB_SIZE 65536  // Bytes in a slab
+#define SLAB_ALIGNMENT 4096  // Slabs start on a page boundary
+
+typedef struct {
+    size_t slotSize;  // Size of a slot, big enough to hold the free list link
+    size_t slotsPerSlab;  // Number of slots carved out of every slab
+    void *freeList;  // First free slot, every free slot stores the address of the next one
+    void **slabs;  // The raw allocations behind the slabs, kept to free them
+    size_t slabCount;  // Number of slabs allocated
+    size_t slabCapacity;  // Capacity of the slabs array
+    size_t usedCount;  // Number of slots currently handed out
+} SlabPool;
+
+/**
+ * Initializes a pool of fixed-size objects
+ * @param pool pointer to the SlabPool
+ * @param objectSize size of the pooled objects
+ * @note no memory is allocated until the first object is requested
+ */
+void initSlabPool(SlabPool *pool, size_t objectSize);
+
+/**
+ * Hands out an object from the pool, allocating a new slab only when all the others are full
+ * @param pool pointer to the SlabPool
+ * @return pointer to a zeroed object
+ */
+void* slabAlloc(SlabPool *pool);
+
+/**
+ * Gives an object back to its pool
+ * @param pool pointer to the SlabPool the object was taken from
+ * @param object pointer to the object, may be NULL
+ */
+void slabFree(SlabPool *pool, void *object);
+
+/**
+ * Frees the slabs of a pool that has no objects handed out, so it returns to its initial footprint
+ * @param pool pointer to the SlabPool
+ */
+void trimSlabPool(SlabPool *pool);
+
+/**
+ * Frees every slab of the pool, invalidating all the objects handed out
+ * @param pool pointer to the SlabPool
+ */
+void freeSlabPool(SlabPool *pool);
+
+#endif // SLAB_POOL_H
@@ -2,62 +2,86 @@
 
 Entity PLAYER_ID = 0;  // will be set when the player is created
 
+#define DEFAULT_HEADLESS_TICKS 3600  // A minute of play at the default tick rate
+
 int main(int argc, char* argv[]) {
-    ZENg zEngine = initGame();
+    // --headless [--ticks N] runs the simulation alone, for servers, soak tests and benchmarks
+    // --record FILE saves the next match's input, --replay FILE [--seek TICK] plays it back
+    Uint8 headless = 0;
+    Uint64 headlessTicks = 0;
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    Uint32 seekTick = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) headless = 1;
+        else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) headlessTicks = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayPath = argv[++i];
+        else if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc) seekTick = (Uint32)strtoul(argv[++i], NULL, 10);
+        else fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+    }
 
-    // time for some delta time (no pun intended)
-    Uint64 lastFrameTime = SDL_GetTicks64();
-    double_t deltaTime = 0.0;
-    const double_t targetFrameTime = 1000.0 / 60.0; // capping at 60 fps
+    ZENg zEngine = initGame(headless);
+    if (replayPath) {
+        // A headless replay runs at full speed until the recording ends
+        if (playReplay(zEngine, replayPath, seekTick) && !headlessTicks) headlessTicks = UINT64_MAX;
+    } else if (recordPath) {
+        zEngine->inputMng->replay = startRecording(recordPath, (Uint32)SDL_GetPerformanceCounter(), zEngine->timestep.tickRate);
+    }
+    if (!headlessTicks) headlessTicks = DEFAULT_HEADLESS_TICKS;
+
+    if (headless) {
+        runHeadless(zEngine, headlessTicks);
+        destroyEngine(&zEngine);
+        return 0;
+    }
+
+    // The simulation advances in fixed ticks, the frames are rendered as fast as the display allows
+    Timestep *clock = &zEngine->timestep;
 
     // Main loop
     Uint8 running = 1;  // could have used bool, but it takes 8 bits anyway
     SDL_Event event;  // this will be used to poll events
 
     while (running) {
-        Uint64 frameStart = SDL_GetTicks64();
-        deltaTime = (frameStart - lastFrameTime) / 1000.0;  // ms to s
-        lastFrameTime = frameStart;
+        // Measure the last frame and bank its time for the simulation
+        beginTimestepFrame(clock);
 
-        // Cap delta time to prevent spikes after lags
-        if (deltaTime > 0.1) deltaTime = 0.1;  // Min 10 FPS
+        // Everything allocated from the frame arena last frame is released at once
+        resetFrameArena(&zEngine->frameArena);
 
-        #ifdef DEBUG
-            printf("=======================FRAME START=====================\n");
-        #endif
+        LOG_TRACE(LOG_CORE, "Frame start");
 
         GameState *currState = getCurrState(zEngine->stateMng);
-        
+
         while (SDL_PollEvent(&event)) {
             running = currState->handleEvents(&event, zEngine);
             currState = getCurrState(zEngine->stateMng);  // get the current state after handling events
-            #ifdef DEBUG
-                if (!running) printf("Event handler returned 0 for the main loop\n");
-            #endif
-            
+            if (!running) LOG_DEBUG(LOG_CORE, "Event handler returned 0 for the main loop");
+
             if (event.type == SDL_QUIT || (currState && currState->type == STATE_EXIT)) {
-                #ifdef DEBUG
-                    printf("Quit event received or current state is EXIT\n");
-                #endif
+                LOG_DEBUG(LOG_CORE, "Quit event received or current state is EXIT");
                 running = 0;
             }
         }
         if (!running) break;
-        
+
+        // As many ticks as the banked time allows, each one sees the input held at that moment
+        while (nextTick(clock)) {
+            simulateTick(zEngine);
+        }
+
         // Clear the screen
         SDL_SetRenderDrawColor(zEngine->display->renderer, 15, 15, 20, 255);  // Near black
         SDL_RenderClear(zEngine->display->renderer);
-        
-        // currState can be NULL if the stack was popped, so check it
-        if (currState && currState->handleInput) currState->handleInput(zEngine);
-        runSystems(zEngine, deltaTime);
+
+        runSystems(zEngine, PHASE_PRESENTATION, clock->frameTime);
+        PROFILE_BEGIN(presentZone, "SDL_RenderPresent");
         SDL_RenderPresent(zEngine->display->renderer);
-        
-        Uint64 frameTime = SDL_GetTicks64() - frameStart;
-        if (frameTime < targetFrameTime) {
-            // if the frame was loaded faster than the target FPS - wait a little
-            SDL_Delay(targetFrameTime - frameTime);
-        }
+        PROFILE_END(presentZone);
+
+        // Only sleeps when a frame rate cap is set
+        endTimestepFrame(clock);
     }
 
     // Cleanup
@@ -9,12 +9,12 @@ void onEnterGarage(ZENg zEngine) {
 
     ECS ecs = zEngine->ecs;
 
-    Uint64 plPage = playa / PAGE_SIZE;
-    Uint64 plOffset = playa % PAGE_SIZE;
+    Uint64 plPage = ENTITY_INDEX(playa) / PAGE_SIZE;
+    Uint64 plOffset = ENTITY_INDEX(playa) % PAGE_SIZE;
     
     // Make the player bigger in the garage
     Uint64 plRendDenseIdx = ecs->components[RENDER_COMPONENT].sparse[plPage][plOffset];
-    RenderComponent *plRendComp = (RenderComponent *)ecs->components[RENDER_COMPONENT].dense[plRendDenseIdx];
+    RenderComponent *plRendComp = (RenderComponent *)DENSE_AT(&ecs->components[RENDER_COMPONENT], plRendDenseIdx);
     plRendComp->destRect->w = TILE_SIZE * 5;
     plRendComp->destRect->h = TILE_SIZE * 5;
     plRendComp->destRect->x = (LOGICAL_WIDTH - plRendComp->destRect->w) / 2;
@@ -22,38 +22,38 @@ void onEnterGarage(ZENg zEngine) {
 
     Entity mainGunID = createEntity(ecs, STATE_GARAGE);
     WeaponPrefab *mainGunPrefab = getWeaponPrefab(zEngine->prefabs, "Bigfella");
-    WeaponComponent *mainG = instantiateWeapon(zEngine, mainGunPrefab, PLAYER_ID);
-    addComponent(ecs, mainGunID, WEAPON_COMPONENT, (void *)mainG);
-    RenderComponent *mainGRender = createRenderComponent(
-        getTexture(zEngine->resources, mainGunPrefab->iconPath), 10, 10, 128, 64, 0
+    WeaponComponent mainG = instantiateWeapon(zEngine, mainGunPrefab, PLAYER_ID);
+    addComponent(ecs, mainGunID, WEAPON_COMPONENT, &mainG);
+    RenderComponent mainGRender = createRenderComponent(
+        ecs, getTexture(zEngine->resources, mainGunPrefab->iconPath), 10, 10, 128, 64, 0
     );
-    addComponent(ecs, mainGunID, RENDER_COMPONENT, (void *)mainGRender);
+    addComponent(ecs, mainGunID, RENDER_COMPONENT, &mainGRender);
 
     Entity secGun1ID = createEntity(ecs, STATE_GARAGE);
     WeaponPrefab *secGun1Prefab = getWeaponPrefab(zEngine->prefabs, "PKT");
-    WeaponComponent *secGun1 = instantiateWeapon(zEngine, secGun1Prefab, PLAYER_ID);
-    addComponent(ecs, secGun1ID, WEAPON_COMPONENT, (void *)secGun1);
-    RenderComponent *secGun1Render = createRenderComponent(
-        getTexture(zEngine->resources, secGun1Prefab->iconPath), 10, 10, 128, 64, 0
+    WeaponComponent secGun1 = instantiateWeapon(zEngine, secGun1Prefab, PLAYER_ID);
+    addComponent(ecs, secGun1ID, WEAPON_COMPONENT, &secGun1);
+    RenderComponent secGun1Render = createRenderComponent(
+        ecs, getTexture(zEngine->resources, secGun1Prefab->iconPath), 10, 10, 128, 64, 0
     );
-    addComponent(ecs, secGun1ID, RENDER_COMPONENT, (void *)secGun1Render);
+    addComponent(ecs, secGun1ID, RENDER_COMPONENT, &secGun1Render);
     // The list contains pointers to the weapon entities
     CDLLNode *weapList = initList((GenericData){.u64 = secGun1ID}, DATA_U64);
 
     Entity secGun2ID = createEntity(ecs, STATE_GARAGE);
     WeaponPrefab *secGun2Prefab = getWeaponPrefab(zEngine->prefabs, "M240C");
-    WeaponComponent *secGun2 = instantiateWeapon(zEngine, secGun2Prefab, PLAYER_ID);
-    addComponent(ecs, secGun2ID, WEAPON_COMPONENT, (void *)secGun2);
-    RenderComponent *secGun2Render = createRenderComponent(
-        getTexture(zEngine->resources, secGun2Prefab->iconPath), 10, 10, 128, 64, 0
+    WeaponComponent secGun2 = instantiateWeapon(zEngine, secGun2Prefab, PLAYER_ID);
+    addComponent(ecs, secGun2ID, WEAPON_COMPONENT, &secGun2);
+    RenderComponent secGun2Render = createRenderComponent(
+        ecs, getTexture(zEngine->resources, secGun2Prefab->iconPath), 10, 10, 128, 64, 0
     );
-    addComponent(ecs, secGun2ID, RENDER_COMPONENT, (void *)secGun2Render);
+    addComponent(ecs, secGun2ID, RENDER_COMPONENT, &secGun2Render);
     CDLLInsertLast(weapList, (GenericData){.u64 = secGun2ID}, DATA_U64);
 
     Entity hullID = createEntity(ecs, STATE_GARAGE);
     Entity moduleID = createEntity(ecs, STATE_GARAGE);
-    LoadoutComponent *loadout = createLoadoutComponent(mainGunID, weapList, hullID, moduleID);
-    addComponent(ecs, PLAYER_ID, LOADOUT_COMPONENT, (void *)loadout);
+    LoadoutComponent loadout = createLoadoutComponent(mainGunID, weapList, hullID, moduleID);
+    addComponent(ecs, PLAYER_ID, LOADOUT_COMPONENT, &loadout);
 
     getCurrState(zEngine->stateMng)->stateData = MapInit(31, MAP_STATE_DATA);
     zEngine->uiManager->root = UIparseFromFile(zEngine, "data/states/UIgarageState.json");
@@ -67,6 +67,7 @@ void onEnterGarage(ZENg zEngine) {
 void onExitGarage(ZENg zEngine) {
     UIclear(zEngine->uiManager);
     sweepState(zEngine->ecs, STATE_GARAGE);
+    compactECS(zEngine->ecs);
 }
 
 /**
@@ -81,10 +82,11 @@ ProviderResult* getMainGuns(ZENg zEngine) {
     Entity *guns = calloc(3, sizeof(Entity));
     if (!guns) THROW_ERROR_AND_EXIT("Failed to allocate memory for main guns array in getMainGuns");
 
-    Uint64 page = PLAYER_ID / PAGE_SIZE;
-    Uint64 offset = PLAYER_ID % PAGE_SIZE;
+    Uint64 page = ENTITY_INDEX(PLAYER_ID) / PAGE_SIZE;
+    Uint64 offset = ENTITY_INDEX(PLAYER_ID) % PAGE_SIZE;
     Uint64 loadoutDenseIdx = zEngine->ecs->components[LOADOUT_COMPONENT].sparse[page][offset];
-    LoadoutComponent *loadout = (LoadoutComponent *)zEngine->ecs->components[LOADOUT_COMPONENT].dense[loadoutDenseIdx];
+    LoadoutComponent *loadout =
+    (LoadoutComponent *)DENSE_AT(&zEngine->ecs->components[LOADOUT_COMPONENT], loadoutDenseIdx);
 
     Entity secGun1ID = (loadout->currSecondaryGun->data.u64);
     Entity secGun2ID = (loadout->currSecondaryGun->next->data.u64);
@@ -44,6 +44,13 @@ void onExitPauseState(ZENg zEngine) {
  */
 
 Uint8 handlePauseStateEvents(SDL_Event *e, ZENg zEngine) {
+    if (
+        e->type == SDL_KEYDOWN
+        && scancodeToAction(zEngine->inputMng, e->key.keysym.scancode) == INPUT_PERF_OVERLAY
+    ) {
+        togglePerfOverlay(zEngine->uiManager->overlay);
+        return 1;
+    }
     return handleMenuNavigation(e, zEngine);
 }
 
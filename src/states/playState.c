@@ -7,25 +7,25 @@ void onEnterPlayState(ZENg zEngine) {
     ECS ecs = zEngine->ecs;
     Entity mainGunID = createEntity(ecs, STATE_PLAYING);
     WeaponPrefab *mainGunPrefab = getWeaponPrefab(zEngine->prefabs, "Bigfella");
-    WeaponComponent *mainG = instantiateWeapon(zEngine, mainGunPrefab, PLAYER_ID);
-    addComponent(ecs, mainGunID, WEAPON_COMPONENT, (void *)mainG);
+    WeaponComponent mainG = instantiateWeapon(zEngine, mainGunPrefab, PLAYER_ID);
+    addComponent(ecs, mainGunID, WEAPON_COMPONENT, &mainG);
 
     Entity secGun1ID = createEntity(ecs, STATE_PLAYING);
     WeaponPrefab *secGun1Prefab = getWeaponPrefab(zEngine->prefabs, "PKT");
-    WeaponComponent *secGun1 = instantiateWeapon(zEngine, secGun1Prefab, PLAYER_ID);
-    addComponent(ecs, secGun1ID, WEAPON_COMPONENT, (void *)secGun1);
+    WeaponComponent secGun1 = instantiateWeapon(zEngine, secGun1Prefab, PLAYER_ID);
+    addComponent(ecs, secGun1ID, WEAPON_COMPONENT, &secGun1);
     CDLLNode *weapList = initList((GenericData){.u64 = secGun1ID}, DATA_U64);
 
     Entity secGun2ID = createEntity(ecs, STATE_PLAYING);
     WeaponPrefab *secGun2Prefab = getWeaponPrefab(zEngine->prefabs, "M240C");
-    WeaponComponent *secGun2 = instantiateWeapon(zEngine, secGun2Prefab, PLAYER_ID);
-    addComponent(ecs, secGun2ID, WEAPON_COMPONENT, (void *)secGun2);
+    WeaponComponent secGun2 = instantiateWeapon(zEngine, secGun2Prefab, PLAYER_ID);
+    addComponent(ecs, secGun2ID, WEAPON_COMPONENT, &secGun2);
     CDLLInsertLast(weapList, (GenericData){.u64 = secGun2ID}, DATA_U64);
 
     Entity hullID = createEntity(ecs, STATE_PLAYING);
     Entity moduleID = createEntity(ecs, STATE_PLAYING);
-    LoadoutComponent *loadout = createLoadoutComponent(mainGunID, weapList, hullID, moduleID);
-    addComponent(ecs, PLAYER_ID, LOADOUT_COMPONENT, (void *)loadout);
+    LoadoutComponent loadout = createLoadoutComponent(mainGunID, weapList, hullID, moduleID);
+    addComponent(ecs, PLAYER_ID, LOADOUT_COMPONENT, &loadout);
 
     // Enable the systems required by the play state
     SystemNode **systems = ecs->depGraph->nodes;
@@ -47,8 +47,12 @@ void onEnterPlayState(ZENg zEngine) {
  */
 
 void onExitPlayState(ZENg zEngine) {
+    // A replay covers a single match
+    freeReplay(&zEngine->inputMng->replay);
+
     // Delete game entities
     sweepState(zEngine->ecs, STATE_PLAYING);
+    compactECS(zEngine->ecs);
     UIclear(zEngine->uiManager);
 
     // Destroy the arena
@@ -70,23 +74,19 @@ void onExitPlayState(ZENg zEngine) {
  * =====================================================================================================================
  */
 
-WeaponComponent* instantiateWeapon(ZENg zEngine, WeaponPrefab *prefab, Entity owner) {
-    WeaponComponent *weap = calloc(1, sizeof(WeaponComponent));
-    if (!weap) {
-        printf("Failed to allocate memory for weapon\n");
-        exit(EXIT_FAILURE);
-    }
-    weap->name = strdup(prefab->name);
-    weap->fireRate = prefab->fireRate;
-    weap->timeSinceUse = 0.0;
-    weap->spawnProj = &spawnBulletProjectile;
-    weap->projW = prefab->projW;
-    weap->projH = prefab->projH;
-    weap->projSpeed = prefab->projSpeed;
-    weap->projLifeTime = prefab->projLifeTime;
-    weap->projTexture = getTexture(zEngine->resources, prefab->projTexturePath);
-    weap->projSound = getSound(zEngine->resources, prefab->projHitSoundPath);
-    weap->projComp = createProjectileComponent(
+WeaponComponent instantiateWeapon(ZENg zEngine, WeaponPrefab *prefab, Entity owner) {
+    WeaponComponent weap = {0};
+    weap.name = strdup(prefab->name);
+    weap.fireRate = prefab->fireRate;
+    weap.timeSinceUse = 0.0;
+    weap.spawnProj = &spawnBulletProjectile;
+    weap.projW = prefab->projW;
+    weap.projH = prefab->projH;
+    weap.projSpeed = prefab->projSpeed;
+    weap.projLifeTime = prefab->projLifeTime;
+    weap.projTexture = getTexture(zEngine->resources, prefab->projTexturePath);
+    weap.projSound = getSound(zEngine->resources, prefab->projHitSoundPath);
+    weap.projComp = createProjectileComponent(
         prefab->dmg, prefab->isPiercing, prefab->isExplosive, owner == PLAYER_ID ? 1 : 0
     );
     return weap;
@@ -102,36 +102,36 @@ Entity instantiateTank(ZENg zEngine, TankPrefab *prefab, Vec2 position) {
         PLAYER_ID = id;  // set the global player ID
     }
 
-    HealthComponent *healthComp = createHealthComponent(prefab->maxHealth, prefab->maxHealth, 1);
-    addComponent(zEngine->ecs, id, HEALTH_COMPONENT, (void *)healthComp);
+    HealthComponent healthComp = createHealthComponent(prefab->maxHealth, prefab->maxHealth, 1);
+    addComponent(zEngine->ecs, id, HEALTH_COMPONENT, &healthComp);
 
     Uint32 playerStartTileX = ARENA_WIDTH / 2;
     Uint32 playerStartTileY = ARENA_HEIGHT - 4;  // bottom
     Int32 playerStartTile = playerStartTileY * ARENA_WIDTH + playerStartTileX;
 
-    PositionComponent *posComp = createPositionComponent(position);
-    addComponent(zEngine->ecs, id, POSITION_COMPONENT, (void *)posComp);
+    PositionComponent posComp = createPositionComponent(position);
+    addComponent(zEngine->ecs, id, POSITION_COMPONENT, &posComp);
 
-    DirectionComponent *dirComp = createDirectionComponent(DIR_UP);  // Default direction
-    addComponent(zEngine->ecs, id, DIRECTION_COMPONENT, (void *)dirComp);
+    DirectionComponent dirComp = createDirectionComponent(DIR_UP);  // Default direction
+    addComponent(zEngine->ecs, id, DIRECTION_COMPONENT, &dirComp);
 
-    VelocityComponent *speedComp = createVelocityComponent(
+    VelocityComponent speedComp = createVelocityComponent(
         (Vec2){0.0, 0.0},
-        prefab->maxSpeed, *posComp, AXIS_NONE, 1
+        prefab->maxSpeed, posComp, AXIS_NONE, 1
     );
-    addComponent(zEngine->ecs, id, VELOCITY_COMPONENT, (void *)speedComp);
+    addComponent(zEngine->ecs, id, VELOCITY_COMPONENT, &speedComp);
 
-    CollisionComponent *colComp = createCollisionComponent(
-        posComp->x, posComp->y, prefab->w * TILE_SIZE, prefab->h * TILE_SIZE,
+    CollisionComponent colComp = createCollisionComponent(
+        zEngine->ecs, posComp.x, posComp.y, prefab->w * TILE_SIZE, prefab->h * TILE_SIZE,
         1, COL_ACTOR
     );
-    addComponent(zEngine->ecs, id, COLLISION_COMPONENT, (void *)colComp);
+    addComponent(zEngine->ecs, id, COLLISION_COMPONENT, &colComp);
 
-    RenderComponent *renderComp = createRenderComponent(
-        getTexture(zEngine->resources, prefab->texturePath),
-        posComp->x, posComp->y, colComp->hitbox->w, colComp->hitbox->h, 1
+    RenderComponent renderComp = createRenderComponent(
+        zEngine->ecs, getTexture(zEngine->resources, prefab->texturePath),
+        posComp.x, posComp.y, colComp.hitbox->w, colComp.hitbox->h, 1
     );
-    addComponent(zEngine->ecs, id, RENDER_COMPONENT, (void *)renderComp);
+    addComponent(zEngine->ecs, id, RENDER_COMPONENT, &renderComp);
 
     return id;
 }
@@ -142,76 +142,111 @@ Entity instantiateTank(ZENg zEngine, TankPrefab *prefab, Vec2 position) {
 
 void spawnBulletProjectile( ZENg zEngine, Entity shooter, int bulletW, int bulletH,
     double_t speed, ProjectileComponent *projComp, double_t lifeTime, SDL_Texture *texture, Mix_Chunk *sound ) {
+    // The projectile component usually lives in a weapon's dense slot, which creating an entity may move
+    ProjectileComponent projCompCopy = *projComp;
     Entity bulletID = createEntity(zEngine->ecs, STATE_PLAYING);
 
     // get the shooter components
-    Uint64 shooterPage = shooter / PAGE_SIZE;
-    Uint64 shooterPageIdx = shooter % PAGE_SIZE;
-    
-    Uint64 shooterDirDenseIdx = zEngine->ecs->components[DIRECTION_COMPONENT].sparse[shooterPage][shooterPageIdx];
-    // Bullet inherits the shooter's direction
-    DirectionComponent *bulletDir = createDirectionComponent(
-        *(DirectionComponent *)(zEngine->ecs->components[DIRECTION_COMPONENT].dense[shooterDirDenseIdx])
-    );
-    addComponent(zEngine->ecs, bulletID, DIRECTION_COMPONENT, (void *)bulletDir);
+    DirectionComponent *shooterDir = NULL;
+    GET_COMPONENT(zEngine->ecs, shooter, DIRECTION_COMPONENT, shooterDir, DirectionComponent);
+    RenderComponent *shooterRender = NULL;
+    GET_COMPONENT(zEngine->ecs, shooter, RENDER_COMPONENT, shooterRender, RenderComponent);
+    PositionComponent *shooterPos = NULL;
+    GET_COMPONENT(zEngine->ecs, shooter, POSITION_COMPONENT, shooterPos, PositionComponent);
+    SDL_Rect *shooterRect = shooterRender->destRect;
 
-    Uint64 shooterRdrDenseIdx = zEngine->ecs->components[RENDER_COMPONENT].sparse[shooterPage][shooterPageIdx];
-    SDL_Rect *shooterRect = (*(RenderComponent *)(zEngine->ecs->components[RENDER_COMPONENT].dense[shooterRdrDenseIdx])).destRect;
-
-    Uint64 shooterPosDenseIdx = zEngine->ecs->components[POSITION_COMPONENT].sparse[shooterPage][shooterPageIdx];
-    PositionComponent *shooterPos = (PositionComponent *)(zEngine->ecs->components[POSITION_COMPONENT].dense[shooterPosDenseIdx]);
+    // Bullet inherits the shooter's direction
+    DirectionComponent bulletDir = createDirectionComponent(*shooterDir);
 
     double_t playerCenterX = shooterPos->x + shooterRect->w / 2.0;
     double_t playerCenterY = shooterPos->y + shooterRect->h / 2.0;
 
-    double_t bulletOffsetX = bulletDir->x * (shooterRect->w / 2.0 + bulletW / 2.0);
-    double_t bulletOffsetY = bulletDir->y * (shooterRect->h / 2.0 + bulletH / 2.0);
+    double_t bulletOffsetX = bulletDir.x * (shooterRect->w / 2.0 + bulletW / 2.0);
+    double_t bulletOffsetY = bulletDir.y * (shooterRect->h / 2.0 + bulletH / 2.0);
 
-    PositionComponent *bulletPos = createPositionComponent(
+    PositionComponent bulletPos = createPositionComponent(
         (Vec2) {
             playerCenterX + bulletOffsetX - bulletW / 2.0,
             playerCenterY + bulletOffsetY - bulletH / 2.0
         }
     );
-    addComponent(zEngine->ecs, bulletID, POSITION_COMPONENT, (void *)bulletPos);
+    // The shooter's components are not touched past this point, adding the bullet's may move them
+    addComponent(zEngine->ecs, bulletID, DIRECTION_COMPONENT, &bulletDir);
+    addComponent(zEngine->ecs, bulletID, POSITION_COMPONENT, &bulletPos);
 
-    VelocityComponent *bulletSpeed = createVelocityComponent(
-        (Vec2) {bulletDir->x * speed, bulletDir->y * speed},
-        speed, *bulletPos, AXIS_NONE, 1
+    VelocityComponent bulletSpeed = createVelocityComponent(
+        (Vec2) {bulletDir.x * speed, bulletDir.y * speed},
+        speed, bulletPos, AXIS_NONE, 1
     );
-    addComponent(zEngine->ecs, bulletID, VELOCITY_COMPONENT, (void *)bulletSpeed);
+    addComponent(zEngine->ecs, bulletID, VELOCITY_COMPONENT, &bulletSpeed);
 
-    ProjectileComponent *projCompCopy = createProjectileComponent(
-        projComp->dmg, projComp->piercing, projComp->exploding, projComp->friendly
-    );  // Copy the gun's projectile component to prevent deleting the original at bullet collision
-    addComponent(zEngine->ecs, bulletID, PROJECTILE_COMPONENT, (void *)projCompCopy);
+    // Copy the gun's projectile component to prevent deleting the original at bullet collision
+    addComponent(zEngine->ecs, bulletID, PROJECTILE_COMPONENT, &projCompCopy);
 
-    LifetimeComponent *lifeComp = calloc(1, sizeof(LifetimeComponent));
-    if (!lifeComp) {
-        printf("Failed to allocate memory for bullet lifetime component\n");
-        exit(EXIT_FAILURE);
-    }
-    *lifeComp = (LifetimeComponent) {
+    LifetimeComponent lifeComp = {
         .lifeTime = lifeTime,
         .timeAlive = 0
     };
-    addComponent(zEngine->ecs, bulletID, LIFETIME_COMPONENT, (void *)lifeComp);
+    addComponent(zEngine->ecs, bulletID, LIFETIME_COMPONENT, &lifeComp);
 
-    CollisionComponent *bulletColl = createCollisionComponent(
-        (int)bulletPos->x, (int)bulletPos->y, bulletW, bulletH,
+    CollisionComponent bulletColl = createCollisionComponent(
+        zEngine->ecs, (int)bulletPos.x, (int)bulletPos.y, bulletW, bulletH,
         0, COL_BULLET
     );
-    addComponent(zEngine->ecs, bulletID, COLLISION_COMPONENT, (void *)bulletColl);
-    registerEntityToSG(zEngine->collisionMng, bulletID, bulletColl);
+    bulletColl.isFast = 1;  // A lag tick can carry it past a wall or a tank otherwise
+    CollisionComponent *storedColl = addComponent(zEngine->ecs, bulletID, COLLISION_COMPONENT, &bulletColl);
+    registerEntityToSG(zEngine->collisionMng, bulletID, storedColl);
 
-    RenderComponent *bulletRender = createRenderComponent(
-        texture, (int)bulletPos->x, (int)bulletPos->y,
+    RenderComponent bulletRender = createRenderComponent(
+        zEngine->ecs, texture, (int)bulletPos.x, (int)bulletPos.y,
         bulletW, bulletH, 1
     );
-    addComponent(zEngine->ecs, bulletID, RENDER_COMPONENT, (void *)bulletRender);
+    addComponent(zEngine->ecs, bulletID, RENDER_COMPONENT, &bulletRender);
+
+    // Play firing sound, a headless engine has no audio device
+    if (!zEngine->headless) Mix_PlayChannel(-1, sound, 0);
+}
+
+/**
+ * =====================================================================================================================
+ */
+
+/**
+ * Cycles the player's secondary weapon
+ * @param zEngine pointer to the engine
+ * @param right 1 to switch to the next weapon, 0 to the previous one
+ */
+static void switchSecondaryGun(ZENg zEngine, Uint8 right) {
+    Uint64 page = ENTITY_INDEX(PLAYER_ID) / PAGE_SIZE;
+    Uint64 pageIdx = ENTITY_INDEX(PLAYER_ID) % PAGE_SIZE;
+    Uint64 loadDenseIdx = zEngine->ecs->components[LOADOUT_COMPONENT].sparse[page][pageIdx];
+    LoadoutComponent *playerLoadout =
+    (LoadoutComponent *)DENSE_AT(&zEngine->ecs->components[LOADOUT_COMPONENT], loadDenseIdx);
+
+    CDLLNode *currSecGun = playerLoadout->currSecondaryGun;
+    Entity secGunID = currSecGun->data.u64;
+    Uint64 secGunPage = ENTITY_INDEX(secGunID) / PAGE_SIZE;
+    Uint64 secGunPageIdx = ENTITY_INDEX(secGunID) % PAGE_SIZE;
+    Uint64 secGunDenseIdx = zEngine->ecs->components[WEAPON_COMPONENT].sparse[secGunPage][secGunPageIdx];
+    WeaponComponent *secGun =
+    (WeaponComponent *)DENSE_AT(&zEngine->ecs->components[WEAPON_COMPONENT], secGunDenseIdx);
+    if (!secGun) {
+        #ifdef DEBUGPP
+            printf("No secondary weapons to switch to!\n");
+        #endif
+        return;
+    }
 
-    // Play firing sound
-    Mix_PlayChannel(-1, sound, 0);
+    playerLoadout->currSecondaryGun = right ? currSecGun->next : currSecGun->prev;
+    #ifdef DEBUGPP
+        Entity nWeap = (playerLoadout->currSecondaryGun->data.u64);
+        Uint64 nWeapPage = ENTITY_INDEX(nWeap) / PAGE_SIZE;
+        Uint64 nWeapPageIdx = ENTITY_INDEX(nWeap) % PAGE_SIZE;
+        Uint64 dIdx = zEngine->ecs->components[WEAPON_COMPONENT].sparse[nWeapPage][nWeapPageIdx];
+        WeaponComponent *newWeapon =
+        (WeaponComponent *)DENSE_AT(&zEngine->ecs->components[WEAPON_COMPONENT], dIdx);
+        printf("Switched weapon %s: %s -> %s\n", right ? "right" : "left", secGun->name, newWeapon->name);
+    #endif
 }
 
 /**
@@ -225,8 +260,6 @@ Uint8 handlePlayStateEvents(SDL_Event *e, ZENg zEngine) {
             printf("Unknown input action for scancode %d\n", e->key.keysym.scancode);
             return 1;
         }
-        Uint64 page = PLAYER_ID / PAGE_SIZE;
-        Uint64 pageIdx = PLAYER_ID % PAGE_SIZE;
 
         switch (action) {
             case INPUT_BACK: {
@@ -243,66 +276,14 @@ Uint8 handlePlayStateEvents(SDL_Event *e, ZENg zEngine) {
                 pushState(zEngine, pauseState);
                 return 1;
             }
-            case INPUT_SWITCH_LEFT: {
-                Uint64 loadDenseIdx = zEngine->ecs->components[LOADOUT_COMPONENT].sparse[page][pageIdx];
-                LoadoutComponent *playerLoadout =
-                (LoadoutComponent *)zEngine->ecs->components[LOADOUT_COMPONENT].dense[loadDenseIdx];
-
-                CDLLNode *currSecGun = playerLoadout->currSecondaryGun;
-                Entity secGunID = currSecGun->data.u64;
-                Uint64 secGunPage = secGunID / PAGE_SIZE;
-                Uint64 secGunPageIdx = secGunID % PAGE_SIZE;
-                Uint64 secGunDenseIdx = zEngine->ecs->components[WEAPON_COMPONENT].sparse[secGunPage][secGunPageIdx];
-                WeaponComponent *secGun =
-                (WeaponComponent *)zEngine->ecs->components[WEAPON_COMPONENT].dense[secGunDenseIdx];
-                if (!secGun) {
-                    #ifdef DEBUGPP
-                        printf("No secondary weapons to switch to!\n");
-                    #endif
-                    return 1;
-                }
-
-                playerLoadout->currSecondaryGun = currSecGun->prev;
-                #ifdef DEBUGPP
-                    Entity nWeap = (playerLoadout->currSecondaryGun->data.u64);
-                    Uint64 nWeapPage = nWeap / PAGE_SIZE;
-                    Uint64 nWeapPageIdx = nWeap % PAGE_SIZE;
-                    Uint64 dIdx = zEngine->ecs->components[WEAPON_COMPONENT].sparse[nWeapPage][nWeapPageIdx];
-                    WeaponComponent *newWeapon =
-                    (WeaponComponent *)(zEngine->ecs->components[WEAPON_COMPONENT].dense[dIdx]);
-                    printf("Switched weapon left: %s -> %s\n", secGun->name, newWeapon->name);
-                #endif
+            // Weapon switches change the simulation, so they happen on the next tick where they can be recorded
+            case INPUT_SWITCH_LEFT:
+            case INPUT_SWITCH_RIGHT: {
+                queueActionTap(zEngine->inputMng, action);
                 return 1;
             }
-
-            case INPUT_SWITCH_RIGHT: {
-                Uint64 loadDenseIdx = zEngine->ecs->components[LOADOUT_COMPONENT].sparse[page][pageIdx];
-                LoadoutComponent *playerLoadout = (LoadoutComponent *)zEngine->ecs->components[LOADOUT_COMPONENT].dense[loadDenseIdx];
-
-                CDLLNode *currSecGun = playerLoadout->currSecondaryGun;
-                Entity secGunID = currSecGun->data.u64;
-                Uint64 secGunPage = secGunID / PAGE_SIZE;
-                Uint64 secGunPageIdx = secGunID % PAGE_SIZE;
-                Uint64 secGunDenseIdx = zEngine->ecs->components[WEAPON_COMPONENT].sparse[secGunPage][secGunPageIdx];
-                WeaponComponent *secGun =
-                (WeaponComponent *)zEngine->ecs->components[WEAPON_COMPONENT].dense[secGunDenseIdx];
-                if (!secGun) {
-                    #ifdef DEBUGPP
-                        printf("No secondary weapons to switch to!\n");
-                    #endif
-                    return 1;
-                }
-
-                playerLoadout->currSecondaryGun = currSecGun->next;
-                #ifdef DEBUGPP
-                    Entity nWeap = (playerLoadout->currSecondaryGun->data.u64);
-                    Uint64 nWeapPage = nWeap / PAGE_SIZE;
-                    Uint64 nWeapPageIdx = nWeap % PAGE_SIZE;
-                    Uint64 dIdx = zEngine->ecs->components[WEAPON_COMPONENT].sparse[nWeapPage][nWeapPageIdx];
-                    WeaponComponent *newWeapon =
-                    (WeaponComponent *)(zEngine->ecs->components[WEAPON_COMPONENT].dense[dIdx]);
-                    printf("Switched weapon right: %s -> %s\n", secGun->name, newWeapon->name);
-                #endif
+            case INPUT_PERF_OVERLAY: {
+                togglePerfOverlay(zEngine->uiManager->overlay);
                 return 1;
             }
         }
@@ -315,21 +296,24 @@ Uint8 handlePlayStateEvents(SDL_Event *e, ZENg zEngine) {
  */
 
 void handlePlayStateInput(ZENg zEngine) {
-    // Keyboard state
-    zEngine->inputMng->keyboardState = SDL_GetKeyboardState(NULL);
+    // Action states of this tick, recorded or played back when a replay is running
+    sampleInput(zEngine->inputMng);
+    if (!isAlive(zEngine->ecs, PLAYER_ID)) return;  // Nothing to control
 
+    if (isActionTapped(zEngine->inputMng, INPUT_SWITCH_LEFT)) switchSecondaryGun(zEngine, 0);
+    if (isActionTapped(zEngine->inputMng, INPUT_SWITCH_RIGHT)) switchSecondaryGun(zEngine, 1);
 
-    Uint64 page = PLAYER_ID / PAGE_SIZE;
-    Uint64 pageIdx = PLAYER_ID % PAGE_SIZE;
+    Uint64 page = ENTITY_INDEX(PLAYER_ID) / PAGE_SIZE;
+    Uint64 pageIdx = ENTITY_INDEX(PLAYER_ID) % PAGE_SIZE;
 
     Uint64 velDenseIdx = zEngine->ecs->components[VELOCITY_COMPONENT].sparse[page][pageIdx];
-    VelocityComponent *playerSpeed = (VelocityComponent *)(zEngine->ecs->components[VELOCITY_COMPONENT].dense[velDenseIdx]);
+    VelocityComponent *playerSpeed = (VelocityComponent *)DENSE_AT(&zEngine->ecs->components[VELOCITY_COMPONENT], velDenseIdx);
 
     Uint64 posDenseIdx = zEngine->ecs->components[POSITION_COMPONENT].sparse[page][pageIdx];
-    PositionComponent *playerPos = (PositionComponent *)(zEngine->ecs->components[POSITION_COMPONENT].dense[posDenseIdx]);
+    PositionComponent *playerPos = (PositionComponent *)DENSE_AT(&zEngine->ecs->components[POSITION_COMPONENT], posDenseIdx);
 
     Uint64 dirDenseIdx = zEngine->ecs->components[DIRECTION_COMPONENT].sparse[page][pageIdx];
-    DirectionComponent *playerDir = (DirectionComponent *)(zEngine->ecs->components[DIRECTION_COMPONENT].dense[dirDenseIdx]);
+    DirectionComponent *playerDir = (DirectionComponent *)DENSE_AT(&zEngine->ecs->components[DIRECTION_COMPONENT], dirDenseIdx);
 
     Uint8 moving = 0;  // flag to check if the player is moving
     if (isActionPressed(zEngine->inputMng, INPUT_MOVE_UP)) {
@@ -365,13 +349,14 @@ void handlePlayStateInput(ZENg zEngine) {
 
     if (isActionPressed(zEngine->inputMng, INPUT_SHOOT)) {
         Uint64 loadoutDenseIdx = zEngine->ecs->components[LOADOUT_COMPONENT].sparse[page][pageIdx];
-        LoadoutComponent *playerLoadout = (LoadoutComponent *)zEngine->ecs->components[LOADOUT_COMPONENT].dense[loadoutDenseIdx];
+        LoadoutComponent *playerLoadout = (LoadoutComponent *)DENSE_AT(&zEngine->ecs->components[LOADOUT_COMPONENT], loadoutDenseIdx);
         Entity mainGunID = playerLoadout->primaryGun;
-        Uint64 mainGunPage = mainGunID / PAGE_SIZE;
-        Uint64 mainGunPageIdx = mainGunID % PAGE_SIZE;
+        if (!isAlive(zEngine->ecs, mainGunID)) THROW_ERROR_AND_RETURN_VOID("The player's main gun entity is gone");
+        Uint64 mainGunPage = ENTITY_INDEX(mainGunID) / PAGE_SIZE;
+        Uint64 mainGunPageIdx = ENTITY_INDEX(mainGunID) % PAGE_SIZE;
 
         Uint64 mainGunDenseIdx = zEngine->ecs->components[WEAPON_COMPONENT].sparse[mainGunPage][mainGunPageIdx];
-        WeaponComponent *mainGun = (WeaponComponent *)zEngine->ecs->components[WEAPON_COMPONENT].dense[mainGunDenseIdx];
+        WeaponComponent *mainGun = (WeaponComponent *)DENSE_AT(&zEngine->ecs->components[WEAPON_COMPONENT], mainGunDenseIdx);
 
         #ifdef DEBUGPP
             printf(
@@ -381,14 +366,15 @@ void handlePlayStateInput(ZENg zEngine) {
         #endif
 
         if (mainGun->timeSinceUse > (1.0 / mainGun->fireRate)) {
+            // Spawning creates an entity, which may move the weapon's dense slot, so reset the cooldown first
+            mainGun->timeSinceUse = 0;
             mainGun->spawnProj(
                 zEngine, PLAYER_ID,
                 mainGun->projW, mainGun->projH,
-                mainGun->projSpeed, mainGun->projComp,
+                mainGun->projSpeed, &mainGun->projComp,
                 mainGun->projLifeTime, mainGun->projTexture,
                 mainGun->projSound
             );
-            mainGun->timeSinceUse = 0;
         }
         #ifdef DEBUGPP
             else {
@@ -399,14 +385,15 @@ void handlePlayStateInput(ZENg zEngine) {
 
     if (isActionPressed(zEngine->inputMng, INPUT_SECONDARY)) {
         Uint64 loadoutDenseIdx = zEngine->ecs->components[LOADOUT_COMPONENT].sparse[page][pageIdx];
-        LoadoutComponent *playerLoadout = (LoadoutComponent *)zEngine->ecs->components[LOADOUT_COMPONENT].dense[loadoutDenseIdx];
+        LoadoutComponent *playerLoadout = (LoadoutComponent *)DENSE_AT(&zEngine->ecs->components[LOADOUT_COMPONENT], loadoutDenseIdx);
         CDLLNode *secGunNode = playerLoadout->currSecondaryGun;
         Entity secGunID = secGunNode->data.u64;
-        Uint64 secGunPage = secGunID / PAGE_SIZE;
-        Uint64 secGunPageIdx = secGunID % PAGE_SIZE;
+        if (!isAlive(zEngine->ecs, secGunID)) THROW_ERROR_AND_RETURN_VOID("The player's secondary gun entity is gone");
+        Uint64 secGunPage = ENTITY_INDEX(secGunID) / PAGE_SIZE;
+        Uint64 secGunPageIdx = ENTITY_INDEX(secGunID) % PAGE_SIZE;
         Uint64 secGunDenseIdx = zEngine->ecs->components[WEAPON_COMPONENT].sparse[secGunPage][secGunPageIdx];
         WeaponComponent *currSecGun =
-        (WeaponComponent *)zEngine->ecs->components[WEAPON_COMPONENT].dense[secGunDenseIdx];
+        (WeaponComponent *)DENSE_AT(&zEngine->ecs->components[WEAPON_COMPONENT], secGunDenseIdx);
 
         #ifdef DEBUGPP
             printf(
@@ -416,14 +403,15 @@ void handlePlayStateInput(ZENg zEngine) {
         #endif
 
         if (currSecGun->timeSinceUse > (1.0 / currSecGun->fireRate)) {
+            // Spawning creates an entity, which may move the weapon's dense slot, so reset the cooldown first
+            currSecGun->timeSinceUse = 0;
             currSecGun->spawnProj(
                 zEngine, PLAYER_ID,
                 currSecGun->projW, currSecGun->projH,
-                currSecGun->projSpeed, currSecGun->projComp,
+                currSecGun->projSpeed, &currSecGun->projComp,
                 currSecGun->projLifeTime, currSecGun->projTexture,
                 currSecGun->projSound
             );
-            currSecGun->timeSinceUse = 0;
         }
         #ifdef DEBUGPP
             else {
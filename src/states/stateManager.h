@@ -331,9 +331,9 @@ void onExitPlayState(ZENg zEngine);
  * @param zEngine pointer to the engine
  * @param prefab pointer to a weapon prefab
  * @param owner entity ID of the weapon's owner
- * @return freshly allocated weapon
+ * @return the weapon component, ready to be added to an entity
  */
-WeaponComponent* instantiateWeapon(ZENg zEngine, WeaponPrefab *prefab, Entity owner);
+WeaponComponent instantiateWeapon(ZENg zEngine, WeaponPrefab *prefab, Entity owner);
 
 /**
  * Instantiates a tank from a prefab